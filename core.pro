@@ -33,11 +33,20 @@ SOURCES += \
     src/acl_roles_handler.cpp \
     src/aoclient.cpp \
     src/automod.cpp \
+    src/automod_state.cpp \
     src/commands/hub.cpp \
+    src/http_service.cpp \
     src/hub_data.cpp \
+    src/ip_range_matcher.cpp \
+    src/login_limiter.cpp \
     src/network/aopacket.cpp \
+    src/network/connection_limiter.cpp \
+    src/network/frame_tokenizer.cpp \
     src/network/network_socket.cpp \
+    src/network/network_thread_pool.cpp \
     src/area_data.cpp \
+    src/ban_index.cpp \
+    src/catalog.cpp \
     src/command_extension.cpp \
     src/commands/area.cpp \
     src/commands/authentication.cpp \
@@ -56,10 +65,12 @@ SOURCES += \
     src/server.cpp \
     src/serverpublisher.cpp \
     src/testimony_recorder.cpp \
+    src/logger/log_ring_buffer.cpp \
     src/logger/u_logger.cpp \
     src/logger/writer_modcall.cpp \
     src/logger/writer_full.cpp \
     src/music_manager.cpp \
+    src/packet/ic_message.cpp \
     src/packet/packet_factory.cpp \
     src/packet/packet_generic.cpp \
     src/packet/packet_hi.cpp \
@@ -89,10 +100,20 @@ SOURCES += \
 HEADERS += src/aoclient.h \
     src/acl_roles_handler.h \
     src/akashiutils.h \
+    src/http_service.h \
     src/hub_data.h \
+    src/ip_range_matcher.h \
+    src/login_limiter.h \
     src/network/aopacket.h \
+    src/network/connection_limiter.h \
+    src/network/frame_tokenizer.h \
+    src/network/mpsc_queue.h \
     src/network/network_socket.h \
+    src/network/network_thread_pool.h \
     src/area_data.h \
+    src/automod_state.h \
+    src/ban_index.h \
+    src/catalog.h \
     src/command_extension.h \
     src/config_manager.h \
     src/data_types.h \
@@ -102,10 +123,12 @@ HEADERS += src/aoclient.h \
     src/playerstateobserver.h \
     src/server.h \
     src/serverpublisher.h \
+    src/logger/log_ring_buffer.h \
     src/logger/u_logger.h \
     src/logger/writer_modcall.h \
     src/logger/writer_full.h \
     src/music_manager.h \
+    src/packet/ic_message.h \
     src/packet/packet_factory.h \
     src/packet/packet_info.h \
     src/packet/packet_generic.h \
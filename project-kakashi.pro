@@ -2,8 +2,10 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
   core \
-  akashi
+  akashi \
+  tests
 
 core.file = core.pro
 akashi.file = akashi.pro
 akashi.depends = core
+tests.depends = core
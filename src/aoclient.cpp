@@ -18,6 +18,7 @@
 #include "aoclient.h"
 
 #include "area_data.h"
+#include "automod_state.h"
 #include "command_extension.h"
 #include "config_manager.h"
 #include "db_manager.h"
@@ -25,6 +26,8 @@
 #include "packet/packet_factory.h"
 #include "server.h"
 
+#include <QSet>
+
 const QMap<QString, AOClient::CommandInfo> AOClient::COMMANDS{
     {"login", {{ACLRole::NONE}, 1, &AOClient::cmdLogin}},
     {"getareas", {{ACLRole::NONE}, 0, &AOClient::cmdGetAreas}},
@@ -237,20 +240,25 @@ void AOClient::clientDisconnected(int f_hub)
 
 void AOClient::clientConnected()
 {
-    server->getDatabaseManager()->ipidip(m_ipid, m_remote_ip.toString().replace("::ffff:", ""), QDateTime::currentDateTime().toString("dd-MM-yyyy"), m_hwid);
-
-    long l_haznumdate = server->getDatabaseManager()->getHazNumDate(m_ipid);
+    const QString l_ip = m_remote_ip.toString().replace("::ffff:", "");
+    const QString l_created = QDateTime::currentDateTime().toString("dd-MM-yyyy");
+    server->getDatabaseManager()->execute([l_ipid = m_ipid, l_ip, l_created, l_hwid = m_hwid](DBManager *f_db) {
+        f_db->ipidip(l_ipid, l_ip, l_created, l_hwid);
+    });
+
+    AutomodState *l_state = server->getAutomodState();
+    const DBManager::automod l_hazard = l_state->hazard(m_ipid);
+    long l_haznumdate = l_hazard.date;
     if (l_haznumdate == 0)
         return;
 
     long l_currentdate = QDateTime::currentDateTime().toSecsSinceEpoch();
     if ((l_currentdate - l_haznumdate) > parseTime(ConfigManager::autoModHaznumTerm())) {
-        int l_haznumnew = server->getDatabaseManager()->getHazNum(m_ipid) - 1;
+        int l_haznumnew = l_hazard.haznum - 1;
         if (l_haznumnew < 0)
             return;
 
-        server->getDatabaseManager()->updateHazNum(m_ipid, l_currentdate);
-        server->getDatabaseManager()->updateHazNum(m_ipid, l_haznumnew);
+        l_state->setHazard(m_ipid, l_haznumnew, l_hazard.action, l_currentdate);
     }
 }
 
@@ -259,9 +267,6 @@ void AOClient::handlePacket(std::shared_ptr<AOPacket> packet)
 #ifdef NET_DEBUG
     qDebug() << "Received packet:" << packet->getPacketInfo().header << ":" << packet->getContent() << "args length:" << packet->getContent().length();
 #endif
-    if (packet->getContent().join("").size() > 16384)
-        return;
-
     if (!checkPermission(packet->getPacketInfo().acl_permission))
         return;
 
@@ -270,9 +275,9 @@ void AOClient::handlePacket(std::shared_ptr<AOPacket> packet)
         sendServerMessageArea("[" + QString::number(clientId()) + "] " + getSenderName(clientId()) + " is no longer AFK.");
     }
 
-    if (packet->getContent().length() < packet->getPacketInfo().min_args) {
+    if (packet->fieldCount() < packet->getPacketInfo().min_args) {
 #ifdef NET_DEBUG
-        qDebug() << "Invalid packet args length. Minimum is" << packet->getPacketInfo().min_args << "but only" << packet->getContent().length() << "were given.";
+        qDebug() << "Invalid packet args length. Minimum is" << packet->getPacketInfo().min_args << "but only" << packet->fieldCount() << "were given.";
 #endif
         return;
     }
@@ -309,14 +314,14 @@ void AOClient::changeArea(int new_area, bool ignore_cooldown)
         sendServerMessageArea("[" + QString::number(clientId()) + "] " + getSenderName(clientId()) + " has moved to the area " + "[" + QString::number(m_area_list.indexOf(new_area)) + "] " + server->getAreaName(new_area));
 
     if (character() != "") {
-        server->getAreaById(areaId())->changeCharacter(server->getCharID(character()), -1);
+        server->getAreaById(areaId())->changeCharacter(server->getCharID(character()), -1, false, clientId());
         server->updateCharsTaken(server->getAreaById(areaId()));
     }
 
     server->getAreaById(areaId())->removeClient(m_char_id, clientId());
 
     bool l_character_taken = false;
-    if (server->getAreaById(new_area)->charactersTaken().contains(server->getCharID(character()))) {
+    if (server->getAreaById(new_area)->isCharacterTaken(server->getCharID(character()))) {
         setCharacter("");
         m_char_id = -1;
         l_character_taken = true;
@@ -380,7 +385,7 @@ bool AOClient::changeCharacter(int char_id)
         return false;
 
     AreaData *l_area = server->getAreaById(areaId());
-    bool l_successfulChange = l_area->changeCharacter(server->getCharID(character()), char_id, m_take_taked_char);
+    bool l_successfulChange = l_area->changeCharacter(server->getCharID(character()), char_id, m_take_taked_char, clientId());
 
     if (char_id < 0) {
         setCharacter("");
@@ -534,7 +539,12 @@ void AOClient::sendPacket(std::shared_ptr<AOPacket> packet)
     qDebug() << "Sent packet:" << packet->getPacketInfo().header << ":" << packet->getContent();
 #endif
 
-    m_socket->write(packet);
+    // IC messages, music changes and WT/CE are timing sensitive, so they skip the coalescing buffer.
+    static const QSet<QString> l_immediate_headers{"MS", "MC", "RT"};
+    if (l_immediate_headers.contains(packet->getPacketInfo().header))
+        m_socket->write(packet, NetworkSocket::WriteMode::IMMEDIATE);
+    else
+        m_socket->write(packet);
 }
 
 void AOClient::sendPacket(QString header, QStringList contents)
@@ -673,5 +683,5 @@ AOClient::AOClient(
 AOClient::~AOClient()
 {
     clientDisconnected(hubId());
-    m_socket->deleteLater();
+    m_socket->release();
 }
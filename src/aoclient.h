@@ -19,6 +19,7 @@
 #define AOCLIENT_H
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 
 #include <QDateTime>
@@ -671,6 +672,11 @@ class AOClient : public QObject
      */
     bool m_authenticated = false;
 
+    /**
+     * @brief If true, a /login attempt is waiting for its password check to finish.
+     */
+    bool m_login_pending = false;
+
     /**
      * @brief The ACL role identifier, used to determine what ACL role the client is linked to.
      */
@@ -2323,6 +2329,25 @@ class AOClient : public QObject
      */
     long long parseTime(QString input);
 
+    /**
+     * @brief Replies to an advanced /login attempt once its password check has finished.
+     *
+     * @param f_username The username the client tried to log in as.
+     * @param f_acl The ACL role identifier of that user. Ignored if the login failed.
+     * @param f_success True if the password matched.
+     */
+    void finishLogin(const QString &f_username, const QString &f_acl, bool f_success);
+
+    /**
+     * @brief Asks the server's LoginLimiter whether the client may trigger a password derivation.
+     *
+     * @details Tells the client why if it may not. If it may, LoginLimiter::release() must be called once the
+     * derivation has finished.
+     *
+     * @return True if the attempt was admitted.
+     */
+    bool admitPasswordAttempt();
+
     /**
      * @brief Clears QVector of the current area.
      *
@@ -2370,7 +2395,13 @@ class AOClient : public QObject
      */
     void playMusic(QStringList f_args, bool f_hubbroadcast = false, bool f_once = false, bool f_gdrive = false, bool f_ambience = false);
 
-    QString uploadToLetterBox(QString f_path);
+    /**
+     * @brief Uploads a temporary audio file to litterbox and removes it afterwards.
+     *
+     * @param f_path The path of the file to upload.
+     * @param f_callback Receives the link to the upload, or an empty string on failure. Not called if the client left.
+     */
+    void uploadToLetterBox(QString f_path, std::function<void(QString)> f_callback);
 
     void startMusicPlaying(QString f_song, bool f_hubbroadcast, bool f_once, bool f_ambience);
 
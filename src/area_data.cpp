@@ -88,7 +88,7 @@ void AreaData::removeClient(int f_charId, int f_userId)
     --m_playerCount;
 
     if (f_charId != -1) {
-        m_charactersTaken.removeAll(f_charId);
+        freeCharacter(f_charId, f_userId);
     }
     m_joined_ids.removeAll(f_userId);
 }
@@ -98,7 +98,7 @@ void AreaData::addClient(int f_charId, int f_userId)
     ++m_playerCount;
 
     if (f_charId != -1)
-        m_charactersTaken.append(f_charId);
+        takeCharacter(f_charId, f_userId);
 
     m_joined_ids.append(f_userId);
     emit userJoinedArea(m_index, f_userId);
@@ -172,36 +172,222 @@ QString AreaData::name() const { return m_name; }
 
 int AreaData::index() const { return m_index; }
 
-QList<int> AreaData::charactersTaken() const { return m_charactersTaken; }
+bool AreaData::isCharacterTaken(int f_charId) const
+{
+    return f_charId >= 0 && f_charId < m_charactersTaken.size() && m_charactersTaken.testBit(f_charId);
+}
+
+QList<int> AreaData::clientsWithCharacter(int f_charId) const { return m_characterClients.values(f_charId); }
 
-bool AreaData::changeCharacter(int f_from, int f_to, bool taketaken)
+bool AreaData::changeCharacter(int f_from, int f_to, bool taketaken, int f_userId)
 {
-    if (m_charactersTaken.contains(f_to) && taketaken == false)
+    if (isCharacterTaken(f_to) && taketaken == false)
         return false;
 
     if (f_to != -1) {
         if (f_from != -1)
-            m_charactersTaken.removeAll(f_from);
+            freeCharacter(f_from, f_userId);
 
-        m_charactersTaken.append(f_to);
+        takeCharacter(f_to, f_userId);
         return true;
     }
 
     if (f_to == -1 && f_from != -1)
-        m_charactersTaken.removeAll(f_from);
+        freeCharacter(f_from, f_userId);
 
     return false;
 }
 
+std::shared_ptr<AOPacket> AreaData::charsCheckPacket(int f_char_count)
+{
+    charsCheck(f_char_count);
+    if (!m_charsCheckPacket)
+        m_charsCheckPacket = PacketFactory::createPacket("CharsCheck", m_charsCheck);
+    return m_charsCheckPacket;
+}
+
+const QStringList &AreaData::charsCheck(int f_char_count)
+{
+    if (m_charsCheck.size() != f_char_count) {
+        m_charsCheck.clear();
+        m_charsCheck.reserve(f_char_count);
+        for (int i = 0; i < f_char_count; i++)
+            m_charsCheck.append(isCharacterTaken(i) ? QStringLiteral("-1") : QStringLiteral("0"));
+        m_charsCheckPacket.reset();
+    }
+    return m_charsCheck;
+}
+
+void AreaData::takeCharacter(int f_charId, int f_userId)
+{
+    if (f_charId < 0)
+        return;
+
+    if (f_charId >= m_charactersTaken.size())
+        m_charactersTaken.resize(f_charId + 1);
+
+    if (f_userId != -1 && !m_characterClients.contains(f_charId, f_userId))
+        m_characterClients.insert(f_charId, f_userId);
+
+    if (!m_charactersTaken.testBit(f_charId)) {
+        m_charactersTaken.setBit(f_charId);
+        setCharsCheckField(f_charId, true);
+    }
+}
+
+void AreaData::freeCharacter(int f_charId, int f_userId)
+{
+    if (!isCharacterTaken(f_charId))
+        return;
+
+    if (f_userId == -1)
+        m_characterClients.remove(f_charId);
+    else
+        m_characterClients.remove(f_charId, f_userId);
+
+    // Several clients can share a character, it is only free once the last of them left it.
+    if (m_characterClients.contains(f_charId))
+        return;
+
+    m_charactersTaken.clearBit(f_charId);
+    setCharsCheckField(f_charId, false);
+}
+
+void AreaData::setCharsCheckField(int f_charId, bool f_taken)
+{
+    if (f_charId >= m_charsCheck.size())
+        return;
+
+    m_charsCheck[f_charId] = f_taken ? QStringLiteral("-1") : QStringLiteral("0");
+    m_charsCheckPacket.reset();
+}
+
 QList<AreaData::Evidence> AreaData::evidence() const { return m_evidence; }
 
-void AreaData::swapEvidence(int f_eviId1, int f_eviId2) { m_evidence.swapItemsAt(f_eviId1, f_eviId2); }
+void AreaData::swapEvidence(int f_eviId1, int f_eviId2)
+{
+    m_evidence.swapItemsAt(f_eviId1, f_eviId2);
+    m_evidenceOwners.swapItemsAt(f_eviId1, f_eviId2);
+    invalidateEvidenceViews();
+}
 
-void AreaData::appendEvidence(const AreaData::Evidence &f_evi_r) { m_evidence.append(f_evi_r); }
+void AreaData::appendEvidence(const AreaData::Evidence &f_evi_r)
+{
+    m_evidence.append(f_evi_r);
+    m_evidenceOwners.append(parseEvidenceOwners(f_evi_r.description));
+    invalidateEvidenceViews();
+}
 
-void AreaData::deleteEvidence(int f_eviId) { m_evidence.removeAt(f_eviId); }
+void AreaData::deleteEvidence(int f_eviId)
+{
+    m_evidence.removeAt(f_eviId);
+    m_evidenceOwners.removeAt(f_eviId);
+    invalidateEvidenceViews();
+}
+
+void AreaData::replaceEvidence(int f_eviId, const AreaData::Evidence &f_newEvi_r)
+{
+    m_evidence.replace(f_eviId, f_newEvi_r);
+    m_evidenceOwners.replace(f_eviId, parseEvidenceOwners(f_newEvi_r.description));
+    invalidateEvidenceViews();
+}
+
+AreaData::EvidenceView AreaData::evidenceView(const QString &f_pos, bool f_cm)
+{
+    bool l_all;
+    CachedEvidenceView &l_cached = cachedEvidenceView(f_pos, f_cm, l_all);
+    if (l_cached.view.packet)
+        return l_cached.view;
+
+    const QString l_pos = f_pos.toCaseFolded();
+    QStringList l_evidence_list;
+    QList<int> l_ids{0};
+    for (int i = 0; i < m_evidence.size(); i++) {
+        if (!l_all && !isEvidenceVisible(i, l_pos))
+            continue;
+
+        const Evidence &l_evidence = m_evidence.at(i);
+        l_evidence_list.append(QStringLiteral("%1&%2&%3").arg(l_evidence.name, l_evidence.description, l_evidence.image));
+        l_ids.append(i + 1);
+    }
+
+    l_cached.view.packet = PacketFactory::createPacket("LE", l_evidence_list);
+    l_cached.view.ids = l_ids;
+    return l_cached.view;
+}
+
+std::shared_ptr<AOPacket> AreaData::maskedEvidencePacket(const QString &f_pos, bool f_cm)
+{
+    bool l_all;
+    CachedEvidenceView &l_cached = cachedEvidenceView(f_pos, f_cm, l_all);
+    if (l_cached.masked_packet)
+        return l_cached.masked_packet;
+
+    // Nothing is hidden from viewers who see everything, their masked list is their regular one.
+    if (l_all) {
+        l_cached.masked_packet = evidenceView(f_pos, f_cm).packet;
+        return l_cached.masked_packet;
+    }
+
+    const QString l_pos = f_pos.toCaseFolded();
+    QStringList l_evidence_list;
+    for (int i = 0; i < m_evidence.size(); i++) {
+        if (!isEvidenceVisible(i, l_pos)) {
+            l_evidence_list.append(QStringLiteral("&&"));
+            continue;
+        }
+
+        const Evidence &l_evidence = m_evidence.at(i);
+        l_evidence_list.append(QStringLiteral("%1&%2&%3").arg(l_evidence.name, l_evidence.description, l_evidence.image));
+    }
 
-void AreaData::replaceEvidence(int f_eviId, const AreaData::Evidence &f_newEvi_r) { m_evidence.replace(f_eviId, f_newEvi_r); }
+    l_cached.masked_packet = PacketFactory::createPacket("LE", l_evidence_list);
+    return l_cached.masked_packet;
+}
+
+AreaData::EvidenceOwners AreaData::parseEvidenceOwners(const QString &f_description)
+{
+    static const QRegularExpression l_regex("<owner=(.*?)>");
+    EvidenceOwners l_owners;
+    const QRegularExpressionMatch l_match = l_regex.match(f_description);
+    if (!l_match.hasMatch())
+        return l_owners;
+
+    const QStringList l_sides = l_match.captured(1).split(",");
+    for (const QString &l_side : l_sides)
+        l_owners.sides.insert(l_side.toCaseFolded());
+    l_owners.everyone = l_owners.sides.contains(QStringLiteral("all"));
+    return l_owners;
+}
+
+AreaData::CachedEvidenceView &AreaData::cachedEvidenceView(const QString &f_pos, bool f_cm, bool &f_all)
+{
+    f_all = f_cm || m_eviMod != EvidenceMod::HIDDEN_CM;
+    if (f_all)
+        return m_allEvidenceView;
+
+    const QString l_pos = f_pos.toCaseFolded();
+    if (!m_evidenceSides.contains(l_pos))
+        return m_untaggedEvidenceView;
+    return m_evidenceViews[l_pos];
+}
+
+bool AreaData::isEvidenceVisible(int f_eviId, const QString &f_foldedPos) const
+{
+    const EvidenceOwners &l_owners = m_evidenceOwners.at(f_eviId);
+    return l_owners.everyone || l_owners.sides.contains(f_foldedPos);
+}
+
+void AreaData::invalidateEvidenceViews()
+{
+    m_evidenceViews.clear();
+    m_allEvidenceView = CachedEvidenceView();
+    m_untaggedEvidenceView = CachedEvidenceView();
+
+    m_evidenceSides.clear();
+    for (const EvidenceOwners &l_owners : std::as_const(m_evidenceOwners))
+        m_evidenceSides.unite(l_owners.sides);
+}
 
 QString AreaData::status() const { return m_status; }
 
@@ -234,7 +420,11 @@ void AreaData::startMessageFloodguard(int f_duration)
 
 void AreaData::toggleMusic() { m_toggleMusic = !m_toggleMusic; }
 
-void AreaData::setEviMod(const EvidenceMod &f_eviMod_r) { m_eviMod = f_eviMod_r; }
+void AreaData::setEviMod(const EvidenceMod &f_eviMod_r)
+{
+    m_eviMod = f_eviMod_r;
+    invalidateEvidenceViews();
+}
 
 void AreaData::setTestimonyRecording(const TestimonyRecording &f_testimonyRecording_r) { m_testimonyRecording = f_testimonyRecording_r; }
 
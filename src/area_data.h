@@ -18,10 +18,13 @@
 #ifndef AREA_DATA_H
 #define AREA_DATA_H
 
+#include <QBitArray>
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QMap>
+#include <QMultiHash>
 #include <QRegularExpression>
+#include <QSet>
 #include <QSettings>
 #include <QString>
 #include <QTimer>
@@ -60,6 +63,17 @@ class AreaData : public QObject
         QString image;       //!< A path originating from `base/evidence/` that points to an image file.
     };
 
+    /**
+     * @brief The evidence list as seen from one position.
+     *
+     * @see evidenceView()
+     */
+    struct EvidenceView
+    {
+        std::shared_ptr<AOPacket> packet; //!< The LE packet listing only the evidence visible from the position.
+        QList<int> ids;                   //!< Maps each listed piece to its 1-based ID in the area, after a leading `0`.
+    };
+
     /**
      * @brief The status of an area.
      *
@@ -368,13 +382,33 @@ class AreaData : public QObject
     int index() const;
 
     /**
-     * @brief Returns a copy of the list of characters taken.
-     *
-     * @return A list of character IDs.
+     * @brief Returns true if a client in the area plays the given character.
      *
      * @see #m_charactersTaken
      */
-    QList<int> charactersTaken() const;
+    bool isCharacterTaken(int f_charId) const;
+
+    /**
+     * @brief Returns the IDs of the clients in the area playing the given character.
+     */
+    QList<int> clientsWithCharacter(int f_charId) const;
+
+    /**
+     * @brief Returns the CharsCheck packet of the area.
+     *
+     * @details The field list is kept up to date as characters are taken and freed, and the packet is only
+     * encoded again after something changed.
+     *
+     * @param f_char_count The amount of characters on the server. The list is rebuilt if it changes.
+     */
+    std::shared_ptr<AOPacket> charsCheckPacket(int f_char_count);
+
+    /**
+     * @brief Returns the CharsCheck fields of the area, one per character: `-1` if taken, `0` if free.
+     *
+     * @param f_char_count The amount of characters on the server. The list is rebuilt if it changes.
+     */
+    const QStringList &charsCheck(int f_char_count);
 
     /**
      * @brief Adjusts the composition of the list of characters taken, by optionally removing and optionally adding one.
@@ -386,6 +420,7 @@ class AreaData : public QObject
      * Defaults to `-1`. If left at that, no character is removed.
      * @param f_to A character ID to add to the list of characters taken -- a character to switch "to".
      * Defaults to `-1`. If left at that, no character is added.
+     * @param f_userId The client changing character. If left at `-1`, every client playing `f_from` frees it.
      *
      * @return True if and only if a character was successfully added to the list of characters taken.
      * False if that character already existed in the list of characters taken, or if `f_to` was left at `-1`.
@@ -394,7 +429,7 @@ class AreaData : public QObject
      * @todo This is godawful, but I'm at my wits end. Needs a bigger refactor later down the line --
      * the separation should help somewhat already, maybe.
      */
-    bool changeCharacter(int f_from = -1, int f_to = -1, bool taketaken = false);
+    bool changeCharacter(int f_from = -1, int f_to = -1, bool taketaken = false, int f_userId = -1);
 
     /**
      * @brief Returns a copy of the list of evidence in the area.
@@ -434,6 +469,29 @@ class AreaData : public QObject
      */
     void replaceEvidence(int f_eviId, const Evidence &f_newEvi_r);
 
+    /**
+     * @brief Returns the evidence list as seen from a position.
+     *
+     * @details Views are cached until the evidence or the evidence mod changes, so sending the list to a whole
+     * area only builds one packet per distinct view. Outside of HIDDEN_CM, and for CMs, every position shares the
+     * same view. In HIDDEN_CM, positions named in an `<owner=…>` tag get their own view and all others share the
+     * view of untagged evidence.
+     *
+     * @param f_pos The position of the viewer.
+     * @param f_cm Whether the viewer is a CM, who sees all evidence.
+     */
+    EvidenceView evidenceView(const QString &f_pos, bool f_cm);
+
+    /**
+     * @brief Returns an LE packet listing all evidence, with the pieces not visible from a position left blank.
+     *
+     * @details Keeps evidence IDs stable for evidencePresent(). Cached like evidenceView().
+     *
+     * @param f_pos The position of the viewer.
+     * @param f_cm Whether the viewer is a CM, who sees all evidence.
+     */
+    std::shared_ptr<AOPacket> maskedEvidencePacket(const QString &f_pos, bool f_cm);
+
     /**
      * @brief Returns the status of the area.
      *
@@ -1051,9 +1109,39 @@ class AreaData : public QObject
     MusicManager *m_music_manager;
 
     /**
-     * @brief A list of the character IDs of all characters taken.
+     * @brief One bit per character ID, set while at least one client in the area plays that character.
      */
-    QList<int> m_charactersTaken;
+    QBitArray m_charactersTaken;
+
+    /**
+     * @brief The clients in the area playing each character, by character ID.
+     */
+    QMultiHash<int, int> m_characterClients;
+
+    /**
+     * @brief The CharsCheck fields of the area, patched whenever a bit of #m_charactersTaken flips.
+     */
+    QStringList m_charsCheck;
+
+    /**
+     * @brief The encoded CharsCheck packet, or null if #m_charsCheck changed since it was built.
+     */
+    std::shared_ptr<AOPacket> m_charsCheckPacket;
+
+    /**
+     * @brief Marks a character as played by a client.
+     */
+    void takeCharacter(int f_charId, int f_userId);
+
+    /**
+     * @brief Marks a character as no longer played by a client, or by anyone if f_userId is `-1`.
+     */
+    void freeCharacter(int f_charId, int f_userId);
+
+    /**
+     * @brief Sets the CharsCheck field of a character.
+     */
+    void setCharsCheckField(int f_charId, bool f_taken);
 
     /**
      * @brief A list of Evidence currently available in the area's court record.
@@ -1064,6 +1152,73 @@ class AreaData : public QObject
      */
     QList<Evidence> m_evidence;
 
+    /**
+     * @brief Who a piece of evidence is shown to in HIDDEN_CM, parsed from the `<owner=…>` tag of its description.
+     */
+    struct EvidenceOwners
+    {
+        bool everyone = true; //!< True if the tag is missing or lists `all`.
+        QSet<QString> sides;  //!< The case-folded positions listed in the tag.
+    };
+
+    /**
+     * @brief The owners of every piece of evidence, parallel to #m_evidence.
+     */
+    QList<EvidenceOwners> m_evidenceOwners;
+
+    /**
+     * @brief A cached view of the evidence. The packets are built on first use.
+     */
+    struct CachedEvidenceView
+    {
+        EvidenceView view;
+        std::shared_ptr<AOPacket> masked_packet;
+    };
+
+    /**
+     * @brief The cached views of positions in HIDDEN_CM, by case-folded position.
+     *
+     * @details Only holds positions listed in #m_evidenceSides, so its size is bounded by the evidence itself and
+     * not by the positions clients make up.
+     */
+    QHash<QString, CachedEvidenceView> m_evidenceViews;
+
+    /**
+     * @brief Every case-folded position listed in the `<owner=…>` tag of some piece of evidence.
+     */
+    QSet<QString> m_evidenceSides;
+
+    /**
+     * @brief The cached view of all positions not listed in any tag, which only see untagged evidence.
+     */
+    CachedEvidenceView m_untaggedEvidenceView;
+
+    /**
+     * @brief The cached view shared by everyone who sees all evidence.
+     */
+    CachedEvidenceView m_allEvidenceView;
+
+    /**
+     * @brief Parses the owners of a piece of evidence from its description.
+     */
+    static EvidenceOwners parseEvidenceOwners(const QString &f_description);
+
+    /**
+     * @brief Returns the cached view for a viewer, and whether that viewer sees all evidence.
+     */
+    CachedEvidenceView &cachedEvidenceView(const QString &f_pos, bool f_cm, bool &f_all);
+
+    /**
+     * @brief Returns true if a piece of evidence is shown to a case-folded position in HIDDEN_CM.
+     */
+    bool isEvidenceVisible(int f_eviId, const QString &f_foldedPos) const;
+
+    /**
+     * @brief Drops all cached evidence views and collects #m_evidenceSides again. Must be called whenever the
+     * evidence or the evidence mod changes.
+     */
+    void invalidateEvidenceViews();
+
     /**
      * @brief The amount of clients inside the area.
      */
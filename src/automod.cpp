@@ -1,16 +1,19 @@
 #include "aoclient.h"
+#include "automod_state.h"
 #include "config_manager.h"
 #include "db_manager.h"
 #include "server.h"
 
 void AOClient::autoMod(bool ic_chat, int chars)
 {
-    int l_warn = server->getDatabaseManager()->getWarnNum(m_ipid);
+    AutomodState *l_state = server->getAutomodState();
+    const DBManager::automodwarns l_warns = l_state->warns(m_ipid);
+    int l_warn = l_warns.warns;
+    long l_warndate = l_warns.date;
     long l_currentdate = QDateTime::currentDateTime().toMSecsSinceEpoch();
-    if (QDateTime::currentDateTime().toSecsSinceEpoch() - server->getDatabaseManager()->getWarnDate(m_ipid) > parseTime(ConfigManager::autoModWarnTerm()) && l_warn > 0) {
+    if (QDateTime::currentDateTime().toSecsSinceEpoch() - l_warndate > parseTime(ConfigManager::autoModWarnTerm()) && l_warn > 0) {
         long l_date = QDateTime::currentDateTime().toSecsSinceEpoch();
-        server->getDatabaseManager()->updateWarn(m_ipid, l_warn - 1);
-        server->getDatabaseManager()->updateWarn(m_ipid, l_date);
+        l_state->setWarns(m_ipid, l_warn - 1, l_date);
     }
 
     if ((ic_chat && m_lastmessagetime == 0) || (!ic_chat && m_lastoocmessagetime == 0)) {
@@ -21,24 +24,14 @@ void AOClient::autoMod(bool ic_chat, int chars)
     if ((l_currentdate - m_lastmessagetime < ConfigManager::autoModTrigger() + m_lastmessagechars * 0.046875 * 1000 && ic_chat) ||
         (l_currentdate - m_lastoocmessagetime < ConfigManager::autoModOocTrigger() && !ic_chat)) {
         if (l_warn < ConfigManager::autoModWarns()) {
-            if (server->getDatabaseManager()->warnExist(m_ipid)) {
-                long date = QDateTime::currentDateTime().toSecsSinceEpoch();
-                server->getDatabaseManager()->updateWarn(m_ipid, l_warn + 1);
-                server->getDatabaseManager()->updateWarn(m_ipid, date);
-            }
-            else {
-                DBManager::automodwarns warn;
-                warn.ipid = m_ipid;
-                warn.date = QDateTime::currentDateTime().toSecsSinceEpoch();
-                warn.warns = 1;
-                server->getDatabaseManager()->addWarn(warn);
-            }
+            long date = QDateTime::currentDateTime().toSecsSinceEpoch();
+            l_state->setWarns(m_ipid, l_warn + 1, date);
 
             sendServerMessage("You got a warn from the Automod! If you get " + QString::number(ConfigManager::autoModWarns() - l_warn) + " warns, you will be punished.");
             updateLastTime(ic_chat, chars);
         }
         else {
-            switch (server->getDatabaseManager()->getHazNum(m_ipid)) {
+            switch (l_state->hazard(m_ipid).haznum) {
             case 0:
                 autoMute(ic_chat);
                 break;
@@ -75,20 +68,8 @@ void AOClient::autoMute(bool ic_chat)
 
     emit logCMD("Automod", "", "", "MUTE", "Muted UID: " + QString::number(target->clientId()), server->getAreaById(areaId())->name(), "", "", "");
 
-    if (server->getDatabaseManager()->hazNumExist(m_ipid)) {
-        long date = QDateTime::currentDateTime().toSecsSinceEpoch();
-        server->getDatabaseManager()->updateHazNum(m_ipid, date);
-        server->getDatabaseManager()->updateHazNum(m_ipid, "MUTE");
-        server->getDatabaseManager()->updateHazNum(m_ipid, 1);
-    }
-    else {
-        DBManager::automod l_num;
-        l_num.ipid = m_ipid;
-        l_num.date = QDateTime::currentDateTime().toSecsSinceEpoch();
-        l_num.action = "MUTE";
-        l_num.haznum = 1;
-        server->getDatabaseManager()->addHazNum(l_num);
-    }
+    long l_date = QDateTime::currentDateTime().toSecsSinceEpoch();
+    server->getAutomodState()->setHazard(m_ipid, 1, "MUTE", l_date);
 }
 
 void AOClient::autoKick()
@@ -102,9 +83,7 @@ void AOClient::autoKick()
     emit logKick("Automod", m_ipid, "You were kicked by the Automod.", "", "");
 
     long l_date = QDateTime::currentDateTime().toSecsSinceEpoch();
-    server->getDatabaseManager()->updateHazNum(m_ipid, l_date);
-    server->getDatabaseManager()->updateHazNum(m_ipid, "KICK");
-    server->getDatabaseManager()->updateHazNum(m_ipid, 2);
+    server->getAutomodState()->setHazard(m_ipid, 2, "KICK", l_date);
 }
 
 void AOClient::autoBan()
@@ -127,34 +106,41 @@ void AOClient::autoBan()
     l_ban.reason = "You were banned by the Automod.";
     l_ban.moderator = "Automod";
     l_ban.time = QDateTime::currentDateTime().toSecsSinceEpoch();
-    bool ban_logged = false;
 
     const QList<AOClient *> l_targets = server->getClientsByIpid(l_ban.ipid);
-    for (AOClient *l_client : l_targets) {
-        if (!ban_logged) {
-            l_ban.ip = l_client->m_remote_ip;
-            l_ban.hdid = l_client->m_hwid;
-            server->getDatabaseManager()->addBan(l_ban);
-            ban_logged = true;
-        }
-
-        QString l_ban_duration;
-        if (!(l_ban.duration == -2))
-            l_ban_duration = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("dd/MM/yyyy, hh:mm");
-        else
-            l_ban_duration = "Permanently.";
-
-        int l_ban_id = server->getDatabaseManager()->getBanID(l_ban.ip);
-        l_client->sendPacket("KB", {l_ban.reason + "\nID: " + QString::number(l_ban_id) + "\nUntil: " + l_ban_duration});
-        l_client->m_socket->close();
+    if (l_targets.isEmpty())
+        return;
 
-        emit logBan(l_ban.moderator, l_ban.ipid, l_ban_duration, l_ban.reason, "", "");
+    l_ban.ip = l_targets.first()->m_remote_ip;
+    l_ban.hdid = l_targets.first()->m_hwid;
 
-        if (ConfigManager::discordBanWebhookEnabled())
-            emit server->banWebhookRequest(l_ban.ipid, l_ban.moderator, l_ban_duration, l_ban.reason, l_ban_id);
+    QString l_ban_duration;
+    if (!(l_ban.duration == -2))
+        l_ban_duration = QDateTime::fromSecsSinceEpoch(l_ban.time).addSecs(l_ban.duration).toString("dd/MM/yyyy, hh:mm");
+    else
+        l_ban_duration = "Permanently.";
+
+    // Every client on the IPID is kicked once the ban is stored, even if this one is gone by then.
+    Server *l_server = server;
+    l_server->getDatabaseManager()->query(
+        l_server, [l_ban](DBManager *f_db) {
+            f_db->addBan(l_ban);
+            return f_db->getBanID(l_ban.ip);
+        },
+        [l_server, l_ban, l_ban_duration](int f_ban_id) {
+            const QList<AOClient *> l_targets = l_server->getClientsByIpid(l_ban.ipid);
+            for (AOClient *l_client : l_targets) {
+                l_client->sendPacket("KB", {l_ban.reason + "\nID: " + QString::number(f_ban_id) + "\nUntil: " + l_ban_duration});
+                l_client->m_socket->close();
+
+                emit l_client->logBan(l_ban.moderator, l_ban.ipid, l_ban_duration, l_ban.reason, "", "");
+
+                if (ConfigManager::discordBanWebhookEnabled())
+                    emit l_server->banWebhookRequest(l_ban.ipid, l_ban.moderator, l_ban_duration, l_ban.reason, f_ban_id);
+            }
+        });
 
-        long l_date = QDateTime::currentDateTime().toSecsSinceEpoch();
-        server->getDatabaseManager()->updateHazNum(m_ipid, l_date);
-        server->getDatabaseManager()->updateHazNum(m_ipid, "BAN");
-    }
+    AutomodState *l_state = l_server->getAutomodState();
+    long l_date = QDateTime::currentDateTime().toSecsSinceEpoch();
+    l_state->setHazard(m_ipid, l_state->hazard(m_ipid).haznum, "BAN", l_date);
 }
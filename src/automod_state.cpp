@@ -0,0 +1,86 @@
+#include "automod_state.h"
+
+AutomodState::AutomodState(DBManager *f_db_manager, QObject *parent) :
+    QObject(parent),
+    m_db_manager(f_db_manager),
+    m_flush_timer(new QTimer(this))
+{
+    m_flush_timer->setSingleShot(true);
+    m_flush_timer->setInterval(FLUSH_INTERVAL);
+    connect(m_flush_timer, &QTimer::timeout, this, &AutomodState::flush);
+
+    const QList<DBManager::automodwarns> l_warns = m_db_manager->wait([](DBManager *f_db) { return f_db->getWarns(); });
+    for (const DBManager::automodwarns &l_warn : l_warns)
+        m_warns.insert(l_warn.ipid, l_warn);
+
+    const QList<DBManager::automod> l_hazards = m_db_manager->wait([](DBManager *f_db) { return f_db->getHazNums(); });
+    for (const DBManager::automod &l_hazard : l_hazards)
+        m_hazards.insert(l_hazard.ipid, l_hazard);
+}
+
+AutomodState::~AutomodState()
+{
+    flush();
+}
+
+DBManager::automodwarns AutomodState::warns(const QString &f_ipid) const
+{
+    return m_warns.value(f_ipid);
+}
+
+void AutomodState::setWarns(const QString &f_ipid, int f_warns, unsigned long f_date)
+{
+    DBManager::automodwarns &l_warn = m_warns[f_ipid];
+    l_warn.ipid = f_ipid;
+    l_warn.warns = f_warns;
+    l_warn.date = f_date;
+    m_dirty_warns.insert(f_ipid);
+    scheduleFlush();
+}
+
+DBManager::automod AutomodState::hazard(const QString &f_ipid) const
+{
+    return m_hazards.value(f_ipid);
+}
+
+void AutomodState::setHazard(const QString &f_ipid, int f_haznum, const QString &f_action, unsigned long f_date)
+{
+    DBManager::automod &l_hazard = m_hazards[f_ipid];
+    l_hazard.ipid = f_ipid;
+    l_hazard.haznum = f_haznum;
+    l_hazard.action = f_action;
+    l_hazard.date = f_date;
+    m_dirty_hazards.insert(f_ipid);
+    scheduleFlush();
+}
+
+void AutomodState::flush()
+{
+    m_flush_timer->stop();
+    if (m_dirty_warns.isEmpty() && m_dirty_hazards.isEmpty())
+        return;
+
+    QList<DBManager::automodwarns> l_warns;
+    for (const QString &l_ipid : std::as_const(m_dirty_warns))
+        l_warns.append(m_warns.value(l_ipid));
+
+    QList<DBManager::automod> l_hazards;
+    for (const QString &l_ipid : std::as_const(m_dirty_hazards))
+        l_hazards.append(m_hazards.value(l_ipid));
+
+    m_dirty_warns.clear();
+    m_dirty_hazards.clear();
+
+    m_db_manager->execute([l_warns, l_hazards](DBManager *f_db) {
+        for (const DBManager::automodwarns &l_warn : l_warns)
+            f_db->storeWarn(l_warn);
+        for (const DBManager::automod &l_hazard : l_hazards)
+            f_db->storeHazNum(l_hazard);
+    });
+}
+
+void AutomodState::scheduleFlush()
+{
+    if (!m_flush_timer->isActive())
+        m_flush_timer->start();
+}
@@ -0,0 +1,105 @@
+#ifndef AUTOMOD_STATE_H
+#define AUTOMOD_STATE_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include "db_manager.h"
+
+/**
+ * @brief Holds the automoderator's warn and hazard records in memory.
+ *
+ * @details The records are loaded once at startup, and the automoderator reads and changes them here without
+ * touching the database. Changed records are written back every #FLUSH_INTERVAL milliseconds as a single batch,
+ * and once more when the object is destroyed.
+ */
+class AutomodState : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Loads every automoderator record from the database.
+     *
+     * @param f_db_manager The database the records are read from and written back to. Must outlive this object.
+     * @param parent Qt-based parent, passed along to QObject's constructor.
+     */
+    AutomodState(DBManager *f_db_manager, QObject *parent = nullptr);
+
+    /**
+     * @brief Writes back any records that are still pending.
+     */
+    ~AutomodState();
+
+    /**
+     * @brief Returns the warn record of an IPID. All fields are zero if the IPID was never warned.
+     */
+    DBManager::automodwarns warns(const QString &f_ipid) const;
+
+    /**
+     * @brief Changes the warn record of an IPID.
+     */
+    void setWarns(const QString &f_ipid, int f_warns, unsigned long f_date);
+
+    /**
+     * @brief Returns the hazard record of an IPID. All fields are zero if the IPID was never punished.
+     */
+    DBManager::automod hazard(const QString &f_ipid) const;
+
+    /**
+     * @brief Changes the hazard record of an IPID.
+     */
+    void setHazard(const QString &f_ipid, int f_haznum, const QString &f_action, unsigned long f_date);
+
+  public slots:
+    /**
+     * @brief Queues every changed record for writing in one database transaction.
+     */
+    void flush();
+
+  private:
+    /**
+     * @brief How long, in milliseconds, a changed record may wait before it is written back.
+     */
+    static constexpr int FLUSH_INTERVAL = 5000;
+
+    /**
+     * @brief Starts the flush timer if it is not running yet.
+     */
+    void scheduleFlush();
+
+    /**
+     * @brief The database records are written back to.
+     */
+    DBManager *m_db_manager;
+
+    /**
+     * @brief Triggers flush() once #FLUSH_INTERVAL milliseconds after the first change.
+     */
+    QTimer *m_flush_timer;
+
+    /**
+     * @brief Warn records, keyed by IPID.
+     */
+    QHash<QString, DBManager::automodwarns> m_warns;
+
+    /**
+     * @brief Hazard records, keyed by IPID.
+     */
+    QHash<QString, DBManager::automod> m_hazards;
+
+    /**
+     * @brief IPIDs whose warn record changed since the last flush.
+     */
+    QSet<QString> m_dirty_warns;
+
+    /**
+     * @brief IPIDs whose hazard record changed since the last flush.
+     */
+    QSet<QString> m_dirty_hazards;
+};
+
+#endif // AUTOMOD_STATE_H
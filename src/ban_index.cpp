@@ -0,0 +1,96 @@
+#include "ban_index.h"
+
+#include <QDateTime>
+
+void BanIndex::load(const QList<DBManager::BanInfo> &f_bans)
+{
+    m_bans.clear();
+    m_by_ipid.clear();
+    m_by_hdid.clear();
+    m_expiry = {};
+
+    for (const DBManager::BanInfo &l_ban : f_bans)
+        insert(l_ban);
+}
+
+void BanIndex::insert(const DBManager::BanInfo &f_ban)
+{
+    remove(f_ban.id);
+
+    qint64 l_expiry = expiryOf(f_ban);
+    if (l_expiry != -1 && l_expiry <= QDateTime::currentSecsSinceEpoch())
+        return;
+
+    m_bans.insert(f_ban.id, f_ban);
+    if (!f_ban.ipid.isEmpty())
+        m_by_ipid.insert(f_ban.ipid, f_ban.id);
+    if (!f_ban.hdid.isEmpty())
+        m_by_hdid.insert(f_ban.hdid, f_ban.id);
+    if (l_expiry != -1)
+        m_expiry.push({l_expiry, f_ban.id});
+}
+
+void BanIndex::remove(int f_id)
+{
+    auto l_it = m_bans.find(f_id);
+    if (l_it == m_bans.end())
+        return;
+
+    m_by_ipid.remove(l_it->ipid, f_id);
+    m_by_hdid.remove(l_it->hdid, f_id);
+    m_bans.erase(l_it);
+}
+
+QPair<bool, DBManager::BanInfo> BanIndex::findByIPID(const QString &f_ipid)
+{
+    evictExpired();
+    return latestOf(m_by_ipid.values(f_ipid));
+}
+
+QPair<bool, DBManager::BanInfo> BanIndex::findByHDID(const QString &f_hdid)
+{
+    evictExpired();
+    return latestOf(m_by_hdid.values(f_hdid));
+}
+
+int BanIndex::size() const
+{
+    return m_bans.size();
+}
+
+qint64 BanIndex::expiryOf(const DBManager::BanInfo &f_ban)
+{
+    if (f_ban.duration == -2)
+        return -1;
+
+    return static_cast<qint64>(f_ban.time) + f_ban.duration;
+}
+
+void BanIndex::evictExpired()
+{
+    const qint64 l_now = QDateTime::currentSecsSinceEpoch();
+    while (!m_expiry.empty() && m_expiry.top().first <= l_now) {
+        const Expiry l_top = m_expiry.top();
+        m_expiry.pop();
+
+        // Skip entries left behind by bans that were lifted or had their duration changed.
+        auto l_it = m_bans.constFind(l_top.second);
+        if (l_it != m_bans.constEnd() && expiryOf(*l_it) == l_top.first)
+            remove(l_top.second);
+    }
+}
+
+QPair<bool, DBManager::BanInfo> BanIndex::latestOf(const QList<int> &f_ids) const
+{
+    if (f_ids.isEmpty())
+        return {false, DBManager::BanInfo{}};
+
+    const DBManager::BanInfo *l_latest = nullptr;
+    for (int l_id : f_ids) {
+        const DBManager::BanInfo &l_ban = *m_bans.constFind(l_id);
+        if (l_latest == nullptr || l_ban.time > l_latest->time)
+            l_latest = &l_ban;
+    }
+
+    return {true, *l_latest};
+}
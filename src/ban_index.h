@@ -0,0 +1,106 @@
+#ifndef BAN_INDEX_H
+#define BAN_INDEX_H
+
+#include <QHash>
+#include <QMultiHash>
+#include <QPair>
+#include <QString>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "db_manager.h"
+
+/**
+ * @brief An in-memory copy of every active ban, used to answer connect-time ban checks without touching the database.
+ *
+ * @details Bans are indexed by IPID and by hardware ID. Temporary bans are also kept in a min-heap ordered by their
+ * expiry time, so expired bans are dropped by looking at the top of the heap before each lookup.
+ *
+ * The index is loaded once at startup and kept in sync through DBManager::banChanged(). It must only be used from
+ * the thread owning the Server.
+ */
+class BanIndex
+{
+  public:
+    /**
+     * @brief Replaces the contents of the index. Inactive bans are skipped.
+     */
+    void load(const QList<DBManager::BanInfo> &f_bans);
+
+    /**
+     * @brief Adds a ban, or replaces the entry with the same ID. A ban that is no longer active is removed instead.
+     */
+    void insert(const DBManager::BanInfo &f_ban);
+
+    /**
+     * @brief Removes the ban with the given ID, if present.
+     */
+    void remove(int f_id);
+
+    /**
+     * @brief Returns the most recent active ban on the given IPID.
+     *
+     * @return A pair of whether the IPID is banned and, if so, the ban's details.
+     */
+    QPair<bool, DBManager::BanInfo> findByIPID(const QString &f_ipid);
+
+    /**
+     * @brief Returns the most recent active ban on the given hardware ID.
+     *
+     * @return A pair of whether the hardware ID is banned and, if so, the ban's details.
+     */
+    QPair<bool, DBManager::BanInfo> findByHDID(const QString &f_hdid);
+
+    /**
+     * @brief Returns the amount of active bans in the index.
+     */
+    int size() const;
+
+  private:
+    /**
+     * @brief The expiry time of a temporary ban and its ID.
+     */
+    using Expiry = QPair<qint64, int>;
+
+    /**
+     * @brief Returns the time, in seconds since epoch, at which the ban ends. -1 for permanent bans.
+     */
+    static qint64 expiryOf(const DBManager::BanInfo &f_ban);
+
+    /**
+     * @brief Drops every ban whose expiry time has passed.
+     */
+    void evictExpired();
+
+    /**
+     * @brief Returns the most recent ban among the given IDs.
+     */
+    QPair<bool, DBManager::BanInfo> latestOf(const QList<int> &f_ids) const;
+
+    /**
+     * @brief Active bans, keyed by their ID.
+     */
+    QHash<int, DBManager::BanInfo> m_bans;
+
+    /**
+     * @brief Ban IDs keyed by the banned IPID.
+     */
+    QMultiHash<QString, int> m_by_ipid;
+
+    /**
+     * @brief Ban IDs keyed by the banned hardware ID.
+     */
+    QMultiHash<QString, int> m_by_hdid;
+
+    /**
+     * @brief Temporary bans ordered by expiry, soonest first.
+     *
+     * @details Entries are not removed when a ban is lifted or changed. Instead, an entry whose time no longer
+     * matches the indexed ban is skipped when it reaches the top.
+     */
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> m_expiry;
+};
+
+#endif // BAN_INDEX_H
@@ -0,0 +1,78 @@
+#include "catalog.h"
+
+Catalog::Catalog(const QStringList &f_entries) :
+    m_entries(f_entries)
+{
+    reindex();
+}
+
+const QStringList &Catalog::entries() const { return m_entries; }
+
+int Catalog::size() const { return m_entries.size(); }
+
+bool Catalog::isEmpty() const { return m_entries.isEmpty(); }
+
+const QString &Catalog::at(int f_index) const { return m_entries.at(f_index); }
+
+int Catalog::indexOf(const QString &f_name, Qt::CaseSensitivity f_cs) const
+{
+    if (f_cs == Qt::CaseSensitive)
+        return m_exact.value(f_name, -1);
+    return m_folded.value(f_name.toCaseFolded(), -1);
+}
+
+bool Catalog::contains(const QString &f_name, Qt::CaseSensitivity f_cs) const
+{
+    if (f_cs == Qt::CaseSensitive)
+        return m_exact.contains(f_name);
+    return m_folded.contains(f_name.toCaseFolded());
+}
+
+void Catalog::append(const QString &f_name)
+{
+    m_entries.append(f_name);
+    indexEntry(m_entries.size() - 1);
+}
+
+void Catalog::insert(int f_index, const QString &f_name)
+{
+    m_entries.insert(f_index, f_name);
+    reindex();
+}
+
+void Catalog::replace(int f_index, const QString &f_name)
+{
+    m_entries.replace(f_index, f_name);
+    reindex();
+}
+
+void Catalog::swapItemsAt(int f_first, int f_second)
+{
+    m_entries.swapItemsAt(f_first, f_second);
+    reindex();
+}
+
+void Catalog::removeAll(const QString &f_name)
+{
+    if (m_entries.removeAll(f_name) > 0)
+        reindex();
+}
+
+void Catalog::indexEntry(int f_index)
+{
+    const QString &l_name = m_entries.at(f_index);
+    m_exact.insert(l_name, m_exact.value(l_name, f_index));
+
+    const QString l_folded = l_name.toCaseFolded();
+    m_folded.insert(l_folded, m_folded.value(l_folded, f_index));
+}
+
+void Catalog::reindex()
+{
+    m_exact.clear();
+    m_folded.clear();
+    m_exact.reserve(m_entries.size());
+    m_folded.reserve(m_entries.size());
+    for (int i = 0; i < m_entries.size(); i++)
+        indexEntry(i);
+}
@@ -0,0 +1,113 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief An ordered list of names that can be looked up in constant time.
+ *
+ * @details Used for the characters, backgrounds, music and area names of the server, which used to be searched
+ * linearly on every lookup. Next to the list itself, the catalog keeps one hash index of the exact names and one
+ * of their case-folded forms, both mapping to the first position a name appears at.
+ *
+ * Appending keeps the indexes up to date incrementally. Every other change rebuilds them, which is fine for
+ * the rare edits of area names and custom music lists.
+ */
+class Catalog
+{
+  public:
+    /**
+     * @brief Creates an empty catalog.
+     */
+    Catalog() = default;
+
+    /**
+     * @brief Creates a catalog of the given names, in order.
+     */
+    explicit Catalog(const QStringList &f_entries);
+
+    /**
+     * @brief Returns all names, in order.
+     */
+    const QStringList &entries() const;
+
+    /**
+     * @brief Returns the amount of names.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns true if the catalog holds no names.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns the name at the given position.
+     */
+    const QString &at(int f_index) const;
+
+    /**
+     * @brief Returns the first position of a name, or -1 if it is not in the catalog.
+     */
+    int indexOf(const QString &f_name, Qt::CaseSensitivity f_cs = Qt::CaseSensitive) const;
+
+    /**
+     * @brief Returns true if the name is in the catalog.
+     */
+    bool contains(const QString &f_name, Qt::CaseSensitivity f_cs = Qt::CaseSensitive) const;
+
+    /**
+     * @brief Adds a name to the end of the catalog.
+     */
+    void append(const QString &f_name);
+
+    /**
+     * @brief Inserts a name at the given position.
+     */
+    void insert(int f_index, const QString &f_name);
+
+    /**
+     * @brief Replaces the name at the given position.
+     */
+    void replace(int f_index, const QString &f_name);
+
+    /**
+     * @brief Swaps the names at the given positions.
+     */
+    void swapItemsAt(int f_first, int f_second);
+
+    /**
+     * @brief Removes every occurrence of a name, matched exactly.
+     */
+    void removeAll(const QString &f_name);
+
+  private:
+    /**
+     * @brief Adds the name at the given position to the indexes, unless it appeared earlier.
+     */
+    void indexEntry(int f_index);
+
+    /**
+     * @brief Rebuilds both indexes from scratch.
+     */
+    void reindex();
+
+    /**
+     * @brief The names, in order.
+     */
+    QStringList m_entries;
+
+    /**
+     * @brief First position of every name.
+     */
+    QHash<QString, int> m_exact;
+
+    /**
+     * @brief First position of every case-folded name.
+     */
+    QHash<QString, int> m_folded;
+};
+
+#endif // CATALOG_H
@@ -428,7 +428,7 @@ void AOClient::cmdSetBackground(int argc, QStringList argv)
     AreaData *area = server->getAreaById(areaId());
     QString f_background = argv.join(" ");
     if (checkPermission(ACLRole::CM) || !area->bgLocked()) {
-        if (server->getBackgrounds().contains(f_background, Qt::CaseInsensitive) || area->ignoreBgList() == true) {
+        if (server->getBackgroundCatalog().contains(f_background, Qt::CaseInsensitive) || area->ignoreBgList() == true) {
             area->setBackground(f_background);
 
             const QVector<AOClient *> l_clients = server->getClients();
@@ -684,7 +684,7 @@ void AOClient::cmdRenameArea(int argc, QStringList argv)
     Q_UNUSED(argc);
 
     QString l_area_name = dezalgo(argv.join(" "));
-    if (server->getAreaNames().contains(l_area_name)) {
+    if (server->getAreaCatalog().contains(l_area_name)) {
         sendServerMessage("An area with that name already exists.");
         return;
     }
@@ -714,7 +714,7 @@ void AOClient::cmdCreateArea(int argc, QStringList argv)
     }
 
     QString l_area_name = dezalgo(argv.join(" "));
-    if (server->getAreaNames().contains(l_area_name)) {
+    if (server->getAreaCatalog().contains(l_area_name)) {
         sendServerMessage("An area with that name already exists!");
         return;
     }
@@ -22,6 +22,9 @@
 #include "db_manager.h"
 #include "server.h"
 
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
 // This file is for commands under the authentication category in aoclient.h
 // Be sure to register the command in the header before adding it here!
 
@@ -60,26 +63,48 @@ void AOClient::cmdLogin(int argc, QStringList argv)
             return;
         }
 
-        QString l_username = argv[0];
-        QString l_password = argv[1];
-        if (server->getDatabaseManager()->authenticate(l_username, l_password)) {
-            m_moderator_name = l_username;
-            m_authenticated = true;
-            m_acl_role_id = server->getDatabaseManager()->getACL(l_username);
-            sendPacket("AUTH", {"1"}); // Client: "You were granted the Disable Modcalls button."
+        if (m_login_pending) {
+            sendServerMessage("Your previous login attempt is still being checked.");
+            return;
+        }
 
-            if (m_version.release <= 2 && m_version.major <= 9 && m_version.minor <= 0)
-                sendServerMessage("Logged in as a moderator."); // pre-2.9.1 clients are hardcoded to display the mod UI when this string is sent in OOC
+        if (!admitPasswordAttempt())
+            return;
 
-            sendServerMessage("Welcome, " + l_username);
-        }
-        else {
-            sendPacket("AUTH", {"0"}); // Client: "Login unsuccessful."
-            sendServerMessage("Incorrect password.");
-        }
+        // Frees the derivation slot once the last copy is gone, whether the check ran or the client left first.
+        LoginLimiter *l_limiter = server->getLoginLimiter();
+        std::shared_ptr<void> l_slot(nullptr, [l_limiter](void *) { l_limiter->release(); });
 
-        emit logLogin((character() + " " + characterName()), name(), l_username, m_ipid, server->getAreaName(areaId()), m_authenticated, QString::number(clientId()), m_hwid, server->getHubName(hubId()));
-        emit logCMD((character() + " " + characterName()), m_ipid, name(), "login", l_username, server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
+        QString l_username = argv[0];
+        QString l_password = argv[1];
+        m_login_pending = true;
+        server->getDatabaseManager()->query(
+            this, [l_username](DBManager *f_db) { return f_db->getCredentials(l_username); },
+            [this, l_username, l_password, l_slot](const DBManager::Credentials &f_credentials) {
+                if (!f_credentials.exists) {
+                    finishLogin(l_username, QString(), false);
+                    return;
+                }
+
+                // Hashing the password takes long enough to stall every client, so it runs on the global thread pool.
+                auto *l_watcher = new QFutureWatcher<bool>(this);
+                connect(l_watcher, &QFutureWatcher<bool>::finished, this, [this, l_watcher, l_username, l_password, f_credentials] {
+                    bool l_success = l_watcher->result();
+                    l_watcher->deleteLater();
+
+                    if (l_success)
+                        server->getLoginLimiter()->succeeded(m_ipid, m_hwid);
+
+                    // Update old-style hashes to new ones on the fly
+                    if (l_success && f_credentials.salt.length() < CryptoHelper::pbkdf2_salt_len)
+                        server->getDatabaseManager()->execute([l_username, l_password](DBManager *f_db) { f_db->updatePassword(l_username, l_password); });
+
+                    finishLogin(l_username, f_credentials.acl, l_success);
+                });
+                l_watcher->setFuture(QtConcurrent::run([l_slot, f_credentials, l_password] {
+                    return CryptoHelper::verify_password(f_credentials.salt, l_password, f_credentials.password);
+                }));
+            });
         break;
     }
     default:
@@ -90,6 +115,46 @@ void AOClient::cmdLogin(int argc, QStringList argv)
     }
 }
 
+bool AOClient::admitPasswordAttempt()
+{
+    qint64 l_retry_after = 0;
+    switch (server->getLoginLimiter()->admit(m_ipid, m_hwid, &l_retry_after)) {
+    case LoginLimiter::Verdict::Admitted:
+        return true;
+    case LoginLimiter::Verdict::LockedOut:
+        sendServerMessage("Too many password attempts. Try again in " + QString::number((l_retry_after + 999) / 1000) + " seconds.");
+        return false;
+    case LoginLimiter::Verdict::Busy:
+        sendServerMessage("The server is busy checking other passwords. Try again in a moment.");
+        return false;
+    }
+
+    return false;
+}
+
+void AOClient::finishLogin(const QString &f_username, const QString &f_acl, bool f_success)
+{
+    m_login_pending = false;
+    if (f_success) {
+        m_moderator_name = f_username;
+        m_authenticated = true;
+        m_acl_role_id = f_acl;
+        sendPacket("AUTH", {"1"}); // Client: "You were granted the Disable Modcalls button."
+
+        if (m_version.release <= 2 && m_version.major <= 9 && m_version.minor <= 0)
+            sendServerMessage("Logged in as a moderator."); // pre-2.9.1 clients are hardcoded to display the mod UI when this string is sent in OOC
+
+        sendServerMessage("Welcome, " + f_username);
+    }
+    else {
+        sendPacket("AUTH", {"0"}); // Client: "Login unsuccessful."
+        sendServerMessage("Incorrect password.");
+    }
+
+    emit logLogin((character() + " " + characterName()), name(), f_username, m_ipid, server->getAreaName(areaId()), m_authenticated, QString::number(clientId()), m_hwid, server->getHubName(hubId()));
+    emit logCMD((character() + " " + characterName()), m_ipid, name(), "login", f_username, server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
+}
+
 void AOClient::cmdChangeAuth(int argc, QStringList argv)
 {
     Q_UNUSED(argc);
@@ -121,7 +186,7 @@ void AOClient::cmdSetRootPass(int argc, QStringList argv)
     ConfigManager::setAuthType(DataTypes::AuthType::ADVANCED);
 
     QByteArray l_salt = CryptoHelper::randbytes(16);
-    server->getDatabaseManager()->createUser("root", l_salt, argv[0], ACLRolesHandler::SUPER_ID);
+    server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->createUser("root", l_salt, argv[0], ACLRolesHandler::SUPER_ID); });
     emit logCMD((character() + " " + characterName()), m_ipid, name(), "rootpass", argv[0], server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
 }
 
@@ -135,7 +200,7 @@ void AOClient::cmdAddUser(int argc, QStringList argv)
     }
 
     QByteArray l_salt = CryptoHelper::randbytes(16);
-    if (server->getDatabaseManager()->createUser(argv[0], l_salt, argv[1], ACLRolesHandler::NONE_ID)) {
+    if (server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->createUser(argv[0], l_salt, argv[1], ACLRolesHandler::NONE_ID); })) {
         sendServerMessage("Created user " + argv[0] + ".\nUse /addperm to modify their permissions.");
         emit logCMD((character() + " " + characterName()), m_ipid, name(), "rootpass", argv[0], server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
     }
@@ -147,7 +212,7 @@ void AOClient::cmdRemoveUser(int argc, QStringList argv)
 {
     Q_UNUSED(argc);
 
-    if (server->getDatabaseManager()->deleteUser(argv[0])) {
+    if (server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->deleteUser(argv[0]); })) {
         sendServerMessage("Successfully removed user " + argv[0] + ".");
         emit logCMD((character() + " " + characterName()), m_ipid, name(), "REMOVEUSER", argv[0], server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
     }
@@ -209,7 +274,7 @@ void AOClient::cmdSetPerms(int argc, QStringList argv)
         return;
     }
 
-    if (server->getDatabaseManager()->updateACL(l_target_username, l_target_acl))
+    if (server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->updateACL(l_target_username, l_target_acl); }))
         sendServerMessage("Successfully applied the role " + l_target_acl + " to the user " + l_target_username + ".");
     else
         sendServerMessage(l_target_username + " was not found.");
@@ -226,7 +291,7 @@ void AOClient::cmdListUsers(int argc, QStringList argv)
     Q_UNUSED(argc);
     Q_UNUSED(argv);
 
-    QStringList l_users = server->getDatabaseManager()->getUsers();
+    QStringList l_users = server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getUsers(); });
     sendServerMessage("All users:\n" + l_users.join("\n"));
 }
 
@@ -273,12 +338,33 @@ void AOClient::cmdChangePassword(int argc, QStringList argv)
         return;
     }
 
-    if (server->getDatabaseManager()->updatePassword(l_username, l_password)) {
-        sendServerMessage("Successfully changed password.");
-        emit logCMD((character() + " " + characterName()), m_ipid, name(), "CHANGEPASSWORD", "User: " + l_username + ". Password: " + l_password, server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
-    }
-    else {
-        sendServerMessage("There was an error changing the password.");
+    if (!admitPasswordAttempt())
         return;
-    }
+
+    // Frees the derivation slot once the hash is done, whether or not the client is still around.
+    LoginLimiter *l_limiter = server->getLoginLimiter();
+    std::shared_ptr<void> l_slot(nullptr, [l_limiter](void *) { l_limiter->release(); });
+
+    // Hashed on the global thread pool like a login, the database thread only stores the result.
+    const QByteArray l_salt = CryptoHelper::randbytes(CryptoHelper::pbkdf2_salt_len);
+    auto *l_watcher = new QFutureWatcher<QString>(this);
+    connect(l_watcher, &QFutureWatcher<QString>::finished, this, [this, l_watcher, l_username, l_password, l_salt] {
+        const QString l_hash = l_watcher->result();
+        l_watcher->deleteLater();
+
+        server->getDatabaseManager()->query(
+            this, [l_username, l_salt, l_hash](DBManager *f_db) { return f_db->updatePassword(l_username, l_salt, l_hash); },
+            [this, l_username, l_password](bool f_changed) {
+                if (!f_changed) {
+                    sendServerMessage("There was an error changing the password.");
+                    return;
+                }
+
+                sendServerMessage("Successfully changed password.");
+                emit logCMD((character() + " " + characterName()), m_ipid, name(), "CHANGEPASSWORD", "User: " + l_username + ". Password: " + l_password, server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
+            });
+    });
+    l_watcher->setFuture(QtConcurrent::run([l_slot, l_salt, l_password] {
+        return CryptoHelper::hash_password(l_salt, l_password);
+    }));
 }
@@ -19,6 +19,7 @@
 
 #include "area_data.h"
 #include "config_manager.h"
+#include "packet/ic_message.h"
 #include "packet/packet_factory.h"
 #include "server.h"
 
@@ -131,7 +132,7 @@ void AOClient::cmdExamine(int argc, QStringList argv)
     if (l_area->testimony().size() - 1 > 0) {
         l_area->restartTestimony();
         server->broadcast(PacketFactory::createPacket("RT", {"testimony2", "0"}), areaId());
-        server->broadcast(PacketFactory::createPacket("MS", {l_area->testimony()[0]}), areaId());
+        server->broadcast(ICMessage::fromFields(l_area->testimony()[0]), areaId());
         emit logCMD((character() + " " + characterName()), m_ipid, name(), "PLAYBACKTESTIMONY", "", server->getAreaById(areaId())->name(), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
         return;
     }
@@ -18,12 +18,13 @@
 #include "aoclient.h"
 #include "area_data.h"
 #include "config_manager.h"
+#include "http_service.h"
 #include "hub_data.h"
 #include "packet/packet_factory.h"
 #include "qhttpmultipart.h"
 #include "server.h"
 
-#include "QtConcurrent/qtconcurrentrun.h"
+#include <QPointer>
 #include <QProcess>
 #include <QQueue>
 
@@ -89,6 +90,8 @@ QStringList AOClient::buildAreaList(int area_idx, bool ignore_hubs)
                 char_entry.insert(0, "[VC]");
             if (l_client->m_is_afk)
                 char_entry.insert(0, "[AFK]");
+            if (m_authenticated && l_client->m_socket->isCongested())
+                char_entry.insert(0, "[LAG " + QString::number(l_client->m_socket->queuedBytes() / 1024) + " KiB]");
 
             entries.append(char_entry);
         }
@@ -270,7 +273,7 @@ void AOClient::playMusic(QStringList f_args, bool f_hubbroadcast, bool f_once, b
     }
 
     QString l_song = f_args.join(" ");
-    if (!l_song.startsWith("http") && !server->getMusicList().contains(l_song) && l_song != "~stop.mp3") {
+    if (!l_song.startsWith("http") && !server->getMusicCatalog().contains(l_song) && l_song != "~stop.mp3") {
         sendServerMessage("Unknown music file! You may have made a mistake in the filename or in the link.");
         return;
     }
@@ -290,21 +293,12 @@ void AOClient::playMusic(QStringList f_args, bool f_hubbroadcast, bool f_once, b
             QObject::connect(l_proc, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
                              [this, l_path, f_hubbroadcast, f_once, f_ambience](int l_code, QProcess::ExitStatus l_status) mutable {
                                  if (l_status == QProcess::NormalExit && l_code == 0) {
-                                     auto l_future = QtConcurrent::run([this, l_path]() {
-                                         return this->uploadToLetterBox(l_path);
-                                     });
-
-                                     QFutureWatcher<QString> *l_watch = new QFutureWatcher<QString>(this);
-                                     connect(l_watch, &QFutureWatcher<QString>::finished, this, [l_watch, f_hubbroadcast, f_once, f_ambience, this]() {
-                                         QString l_link = l_watch->future().result();
+                                     uploadToLetterBox(l_path, [this, f_hubbroadcast, f_once, f_ambience](QString l_link) {
                                          if (!l_link.isEmpty())
                                              startMusicPlaying(l_link, f_hubbroadcast, f_once, f_ambience);
                                          else
                                              sendServerMessage("Error: the server got a empty link!");
-                                         l_watch->deleteLater();
                                      });
-
-                                     l_watch->setFuture(l_future);
                                  }
                                  else
                                      sendServerMessage("Audio download failed: code " + QString::number(l_code));
@@ -324,13 +318,14 @@ void AOClient::playMusic(QStringList f_args, bool f_hubbroadcast, bool f_once, b
     startMusicPlaying(l_song, f_hubbroadcast, f_once, f_ambience);
 }
 
-QString AOClient::uploadToLetterBox(QString f_path)
+void AOClient::uploadToLetterBox(QString f_path, std::function<void(QString)> f_callback)
 {
     QFile *l_file = new QFile(f_path);
     if (!l_file->open(QIODevice::ReadOnly)) {
         sendServerMessage("Error: Failed to open file.");
         delete l_file;
-        return "";
+        f_callback("");
+        return;
     }
 
     QHttpPart l_filepart;
@@ -352,27 +347,28 @@ QString AOClient::uploadToLetterBox(QString f_path)
     l_typepart.setBody("fileupload");
     l_multipart->append(l_typepart);
 
-    QNetworkAccessManager *l_manager = new QNetworkAccessManager(this);
-    QNetworkReply *l_reply = l_manager->post(QNetworkRequest(QUrl("https://litterbox.catbox.moe/resources/internals/api.php")), l_multipart);
-    l_multipart->setParent(l_reply);
-
-    QEventLoop l_eventloop;
-    QObject::connect(l_reply, &QNetworkReply::finished, &l_eventloop, &QEventLoop::quit);
-    l_eventloop.exec();
-
-    QString l_response;
-    if (l_reply->error() == QNetworkReply::NoError)
-        l_response = l_reply->readAll();
-    else {
-        sendServerMessage("Error: " + l_reply->errorString());
-        l_response = "";
-    }
-
-    l_reply->deleteLater();
-    l_file->remove();
-    l_file->deleteLater();
-
-    return l_response;
+    // The temporary file is removed even if the client left during the upload, so no context is given.
+    QPointer<AOClient> l_client(this);
+    QPointer<QFile> l_upload(l_file);
+    server->getHttpService()->post(
+        QNetworkRequest(QUrl("https://litterbox.catbox.moe/resources/internals/api.php")), l_multipart, nullptr,
+        [l_client, l_upload, f_path, f_callback](const HttpService::Response &f_response) {
+            // The reply, and with it the file, is only deleted later. An open file cannot be removed on Windows.
+            if (l_upload.isNull())
+                QFile::remove(f_path);
+            else
+                l_upload->remove();
+
+            if (l_client.isNull())
+                return;
+
+            if (f_response.error == QNetworkReply::NoError)
+                f_callback(QString::fromUtf8(f_response.body));
+            else {
+                l_client->sendServerMessage("Error: " + f_response.error_string);
+                f_callback("");
+            }
+        });
 }
 
 void AOClient::startMusicPlaying(QString f_song, bool f_hubbroadcast, bool f_once, bool f_ambience)
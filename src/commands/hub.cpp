@@ -219,7 +219,7 @@ void AOClient::cmdHubRename(int argc, QStringList argv)
     Q_UNUSED(argc);
 
     QString l_hub_name = dezalgo(argv.join(" "));
-    if (server->getAreaNames().contains(l_hub_name)) {
+    if (server->getAreaCatalog().contains(l_hub_name)) {
         sendServerMessage("A hub with that name already exists.");
         return;
     }
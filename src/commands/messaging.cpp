@@ -146,7 +146,7 @@ void AOClient::cmdRandomChar(int argc, QStringList argv)
     bool l_taken = true;
     while (l_taken) {
         l_selected_char_id = genRand(0, server->getCharacterCount() - 1);
-        if (!l_area->charactersTaken().contains(l_selected_char_id))
+        if (!l_area->isCharacterTaken(l_selected_char_id))
             l_taken = false;
     }
 
@@ -21,7 +21,6 @@
 #include "db_manager.h"
 #include "packet/packet_factory.h"
 #include "server.h"
-#include <QtConcurrent/QtConcurrent>
 
 // This file is for commands under the moderation category in aoclient.h
 // Be sure to register the command in the header before adding it here!
@@ -65,7 +64,7 @@ void AOClient::cmdBan(int argc, QStringList argv)
         if (!l_ban_logged) {
             l_ban.ip = l_client->m_remote_ip;
             l_ban.hdid = l_client->m_hwid;
-            server->getDatabaseManager()->addBan(l_ban);
+            server->getDatabaseManager()->execute([l_ban](DBManager *f_db) { f_db->addBan(l_ban); });
             sendServerMessage("Banned user with ipid " + l_ban.ipid + " for reason: " + l_ban.reason);
             l_ban_logged = true;
         }
@@ -76,7 +75,7 @@ void AOClient::cmdBan(int argc, QStringList argv)
         else
             l_ban_duration = "Permanently.";
 
-        int l_ban_id = server->getDatabaseManager()->getBanID(l_ban.ip);
+        int l_ban_id = server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getBanID(l_ban.ip); });
         sendServerMessage("Ban ID: " + QString::number(l_ban_id));
         l_client->sendPacket("KB", {l_ban.reason + "\nID: " + QString::number(l_ban_id) + "\nUntil: " + l_ban_duration});
         l_client->m_socket->close();
@@ -93,10 +92,10 @@ void AOClient::cmdBan(int argc, QStringList argv)
     // We're banning someone not connected.
     if (!l_ban_logged) {
         l_ban.ip = m_remote_ip;
-        server->getDatabaseManager()->addBan(l_ban);
+        server->getDatabaseManager()->execute([l_ban](DBManager *f_db) { f_db->addBan(l_ban); });
 
         QString l_ban_duration;
-        int l_ban_id = server->getDatabaseManager()->getBanID(l_ban.ip);
+        int l_ban_id = server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getBanID(l_ban.ip); });
         sendServerMessage("Banned " + l_ban.ipid + " for reason: " + l_ban.reason);
         sendServerMessage("Ban ID: " + QString::number(l_ban_id));
 
@@ -404,7 +403,7 @@ void AOClient::cmdBans(int argc, QStringList argv)
     l_recent_bans << "Last 5 bans:";
     l_recent_bans << "-----";
 
-    const QList<DBManager::BanInfo> l_bans_list = server->getDatabaseManager()->getRecentBans();
+    const QList<DBManager::BanInfo> l_bans_list = server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getRecentBans(); });
     for (const DBManager::BanInfo &l_ban : l_bans_list) {
         QString l_banned_until;
         if (l_ban.duration == -2)
@@ -435,7 +434,7 @@ void AOClient::cmdUnBan(int argc, QStringList argv)
         sendServerMessage("Invalid ban ID.");
         return;
     }
-    else if (server->getDatabaseManager()->invalidateBan(l_target_ban))
+    else if (server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->invalidateBan(l_target_ban); }))
         sendServerMessage("Successfully invalidated ban " + argv[0] + ".");
     else
         sendServerMessage("Couldn't invalidate ban " + argv[0] + ", are you sure it exists?");
@@ -677,7 +676,7 @@ void AOClient::cmdBanInfo(int argc, QStringList argv)
     }
 
     QString id = argv[0];
-    const QList<DBManager::BanInfo> l_bans = server->getDatabaseManager()->getBanInfo(l_lookup_type, id);
+    const QList<DBManager::BanInfo> l_bans = server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getBanInfo(l_lookup_type, id); });
     for (const DBManager::BanInfo &l_ban : l_bans) {
         QString l_banned_until;
         if (l_ban.duration == -2)
@@ -707,9 +706,8 @@ void AOClient::cmdReload(int argc, QStringList argv)
         sendServerMessage("Another reloading configurations is still not finished.");
         return;
     }
-    server->reload_watcher.setFuture(QtConcurrent::run(&Server::reloadSettings, server, clientId()));
+    server->reloadSettings(clientId());
     sendServerMessage("Reloading configurations...");
-    server->handleDiscordIntegration(); // It's here to avoid uptime webhook breaking
     emit logCMD((character() + " " + characterName()), m_ipid, name(), "RELOAD", "", server->getAreaName(areaId()), QString::number(clientId()), m_hwid, server->getHubName(hubId()));
 }
 
@@ -840,7 +838,7 @@ void AOClient::cmdUpdateBan(int argc, QStringList argv)
         sendServerMessage("Invalid update type.");
         return;
     }
-    if (!server->getDatabaseManager()->updateBan(l_ban_id, argv[1], l_updated_info)) {
+    if (!server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->updateBan(l_ban_id, argv[1], l_updated_info); })) {
         sendServerMessage("There was an error updating the ban. Please confirm the ban ID is valid.");
         return;
     }
@@ -910,7 +908,7 @@ void AOClient::cmdIpidInfo(int argc, QStringList argv)
     QStringList l_ipid_info;
     l_ipid_info << "-----";
     QString l_ipid = argv[0];
-    const QList<DBManager::idipinfo> l_ipidinfo = server->getDatabaseManager()->getIpidInfo(l_ipid);
+    const QList<DBManager::idipinfo> l_ipidinfo = server->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getIpidInfo(l_ipid); });
     for (const DBManager::idipinfo &l_ipidip : l_ipidinfo) {
         l_ipid_info << "IPID: " + l_ipidip.ipid;
         l_ipid_info << "IP: " + l_ipidip.ip;
@@ -27,6 +27,8 @@ QSettings *ConfigManager::m_ambience = new QSettings("config/ambience.ini", QSet
 QElapsedTimer *ConfigManager::m_uptimeTimer = new QElapsedTimer;
 QStringList *ConfigManager::m_musicList = new QStringList;
 QStringList *ConfigManager::m_ordered_list = new QStringList;
+std::atomic<const ConfigManager::Snapshot *> ConfigManager::m_snapshot{ConfigManager::parseSnapshot()};
+QList<ConfigManager::RetiredSnapshot> *ConfigManager::m_retired_snapshots = new QList<ConfigManager::RetiredSnapshot>;
 
 bool ConfigManager::verifyServerConfig()
 {
@@ -98,11 +100,12 @@ bool ConfigManager::verifyServerConfig()
         m_commands->cdns = QStringList{"cdn.discord.com"};
 
     m_uptimeTimer->start();
+    publishSnapshot();
 
     return true;
 }
 
-QString ConfigManager::bindIP() { return m_settings->value("Options/bind_ip", "all").toString(); }
+QString ConfigManager::bindIP() { return snapshot()->bind_ip; }
 
 QStringList ConfigManager::charlist()
 {
@@ -132,22 +135,25 @@ QStringList ConfigManager::backgrounds()
 
 QStringList ConfigManager::musiclist()
 {
-    // Make sure the list is empty before appending new data.
-    if (!m_ordered_list->empty())
-        m_ordered_list->clear();
+    *m_ordered_list = loadMusicList();
+    return *m_musicList;
+}
 
+QStringList ConfigManager::loadMusicList()
+{
+    QStringList l_ordered_list;
     QFile l_file("config/music.txt");
     l_file.open(QIODevice::ReadOnly | QIODevice::Text);
 
     while (!l_file.atEnd())
-        m_ordered_list->append(l_file.readLine().trimmed());
+        l_ordered_list.append(l_file.readLine().trimmed());
 
     l_file.close();
 
-    if (m_ordered_list->contains(".")) // Add a default category if none exists
-        m_ordered_list->insert(0, "==Music==");
+    if (l_ordered_list.contains(".")) // Add a default category if none exists
+        l_ordered_list.insert(0, "==Music==");
 
-    return *m_musicList;
+    return l_ordered_list;
 }
 
 QStringList ConfigManager::ordered_songs() { return *m_ordered_list; }
@@ -238,262 +244,337 @@ void ConfigManager::reloadSettings()
     m_settings->sync();
     m_discord->sync();
     m_logtext->sync();
+    publishSnapshot();
 }
 
-QStringList ConfigManager::loadConfigFile(const QString filename)
+void ConfigManager::publishSnapshot()
 {
-    QStringList stringlist;
-    QFile l_file("config/text/" + filename + ".txt");
-    l_file.open(QIODevice::ReadOnly | QIODevice::Text);
-
-    while (!(l_file.atEnd()))
-        stringlist.append(l_file.readLine().trimmed());
-
-    l_file.close();
-    return stringlist;
+    // Snapshots are only published from the main thread, which is also the only one freeing them.
+    while (!m_retired_snapshots->isEmpty() && m_retired_snapshots->constFirst().age.hasExpired(SNAPSHOT_GRACE))
+        delete m_retired_snapshots->takeFirst().snapshot;
+
+    // Other threads may still be reading the previous snapshot, so it is retired instead of deleted.
+    const Snapshot *l_previous = m_snapshot.exchange(parseSnapshot(), std::memory_order_acq_rel);
+    if (l_previous != nullptr) {
+        RetiredSnapshot l_retired;
+        l_retired.snapshot = l_previous;
+        l_retired.age.start();
+        m_retired_snapshots->append(l_retired);
+    }
 }
 
-int ConfigManager::maxPlayers()
+const ConfigManager::Snapshot *ConfigManager::snapshot() { return m_snapshot.load(std::memory_order_acquire); }
+
+ConfigManager::Snapshot *ConfigManager::parseSnapshot()
 {
+    Snapshot *l_snapshot = new Snapshot;
     bool ok;
-    int l_players = m_settings->value("Options/max_players", 100).toInt(&ok);
+
+    l_snapshot->bind_ip = m_settings->value("Options/bind_ip", "all").toString();
+
+    l_snapshot->max_players = m_settings->value("Options/max_players", 100).toInt(&ok);
     if (!ok) {
         qWarning("max_players is not an int!");
-        l_players = 100;
+        l_snapshot->max_players = 100;
     }
 
-    return l_players;
-}
-
-int ConfigManager::serverPort()
-{
     if (m_settings->contains("Options/webao_port")) {
         qWarning("webao_port is deprecated, use port instead");
-        return m_settings->value("Options/webao_port", 27016).toInt();
+        l_snapshot->port = m_settings->value("Options/webao_port", 27016).toInt();
+    }
+    else {
+        l_snapshot->port = m_settings->value("Options/port", 27016).toInt();
     }
 
-    return m_settings->value("Options/port", 27016).toInt();
-}
-
-QString ConfigManager::serverDescription() { return m_settings->value("Options/server_description", "This is my flashy new server!").toString(); }
-
-QString ConfigManager::serverName() { return m_settings->value("Options/server_name", "An Unnamed Server").toString(); }
-
-QString ConfigManager::motd() { return m_settings->value("Options/motd", "MOTD not set").toString(); }
-
-bool ConfigManager::webaoEnabled() { return m_settings->value("Options/webao_enable", false).toBool(); }
-
-DataTypes::AuthType ConfigManager::authType()
-{
-    QString l_auth = m_settings->value("Options/auth", "simple").toString().toUpper();
-    return toDataType<DataTypes::AuthType>(l_auth);
-}
-
-QString ConfigManager::modpass() { return m_settings->value("Options/modpass", "changeme").toString(); }
+    l_snapshot->server_description = m_settings->value("Options/server_description", "This is my flashy new server!").toString();
+    l_snapshot->server_name = m_settings->value("Options/server_name", "An Unnamed Server").toString();
+    l_snapshot->motd = m_settings->value("Options/motd", "MOTD not set").toString();
+    l_snapshot->webao_enabled = m_settings->value("Options/webao_enable", false).toBool();
+    l_snapshot->auth = toDataType<DataTypes::AuthType>(m_settings->value("Options/auth", "simple").toString().toUpper());
+    l_snapshot->modpass = m_settings->value("Options/modpass", "changeme").toString();
 
-int ConfigManager::logBuffer()
-{
-    bool ok;
-    int l_buffer = m_settings->value("Options/logbuffer", 500).toInt(&ok);
+    l_snapshot->log_buffer = m_settings->value("Options/logbuffer", 500).toInt(&ok);
     if (!ok) {
         qWarning("logbuffer is not an int!");
-        l_buffer = 500;
+        l_snapshot->log_buffer = 500;
     }
 
-    return l_buffer;
-}
+    l_snapshot->log_buffer_size = m_settings->value("Options/logbuffer_size", 1024).toLongLong(&ok) * 1024;
+    if (!ok) {
+        qWarning("logbuffer_size is not an int!");
+        l_snapshot->log_buffer_size = 1024 * 1024;
+    }
 
-DataTypes::LogType ConfigManager::loggingType()
-{
-    QString l_log = m_settings->value("Options/logging", "modcall").toString().toUpper();
-    return toDataType<DataTypes::LogType>(l_log);
-}
+    l_snapshot->logging = toDataType<DataTypes::LogType>(m_settings->value("Options/logging", "modcall").toString().toUpper());
 
-int ConfigManager::maxStatements()
-{
-    bool ok;
-    int l_max = m_settings->value("Options/maximum_statements", 10).toInt(&ok);
+    l_snapshot->max_statements = m_settings->value("Options/maximum_statements", 10).toInt(&ok);
     if (!ok) {
         qWarning("maximum_statements is not an int!");
-        l_max = 10;
+        l_snapshot->max_statements = 10;
     }
 
-    return l_max;
-}
-int ConfigManager::multiClientLimit()
-{
-    bool ok;
-    int l_limit = m_settings->value("Options/multiclient_limit", 15).toInt(&ok);
+    l_snapshot->multiclient_limit = m_settings->value("Options/multiclient_limit", 15).toInt(&ok);
     if (!ok) {
         qWarning("multiclient_limit is not an int!");
-        l_limit = 15;
+        l_snapshot->multiclient_limit = 15;
     }
 
-    return l_limit;
-}
-
-int ConfigManager::maxCharacters()
-{
-    bool ok;
-    int l_max = m_settings->value("Options/maximum_characters", 256).toInt(&ok);
+    l_snapshot->max_characters = m_settings->value("Options/maximum_characters", 256).toInt(&ok);
     if (!ok) {
         qWarning("maximum_characters is not an int!");
-        l_max = 256;
+        l_snapshot->max_characters = 256;
     }
 
-    return l_max;
-}
-
-int ConfigManager::maxCharactersChillMod()
-{
-    bool ok;
-    int l_max = m_settings->value("Options/maximum_characters_chillmod", 128).toInt(&ok);
+    l_snapshot->max_characters_chillmod = m_settings->value("Options/maximum_characters_chillmod", 128).toInt(&ok);
     if (!ok) {
         qWarning("maximum_characters_chillmod is not an int!");
-        l_max = 128;
+        l_snapshot->max_characters_chillmod = 128;
     }
 
-    return l_max;
-}
-
-int ConfigManager::messageFloodguard()
-{
-    bool ok;
-    int l_flood = m_settings->value("Options/message_floodguard", 250).toInt(&ok);
+    l_snapshot->message_floodguard = m_settings->value("Options/message_floodguard", 250).toInt(&ok);
     if (!ok) {
         qWarning("message_floodguard is not an int!");
-        l_flood = 250;
-    }
-
-    return l_flood;
-}
-
-QUrl ConfigManager::assetUrl()
-{
-    QByteArray l_url = m_settings->value("Options/asset_url", "").toString().toUtf8();
-    if (QUrl(l_url).isValid())
-        return QUrl(l_url);
-    else {
-        qWarning("asset_url is not a valid url!");
-        return QUrl(NULL);
+        l_snapshot->message_floodguard = 250;
     }
-}
 
-int ConfigManager::diceMaxValue()
-{
-    bool ok;
-    int l_value = m_settings->value("Dice/max_value", 100).toInt(&ok);
+    l_snapshot->outbound_queue_limit = m_settings->value("Options/outbound_queue_limit", 1024).toLongLong(&ok) * 1024;
     if (!ok) {
-        qWarning("max_value is not an int!");
-        l_value = 100;
+        qWarning("outbound_queue_limit is not an int!");
+        l_snapshot->outbound_queue_limit = 1024 * 1024;
     }
 
-    return l_value;
-}
-
-int ConfigManager::diceMaxDice()
-{
-    bool ok;
-    int l_dice = m_settings->value("Dice/max_dice", 100).toInt(&ok);
+    l_snapshot->outbound_queue_grace = m_settings->value("Options/outbound_queue_grace", 10).toInt(&ok);
     if (!ok) {
-        qWarning("max_dice is not an int!");
-        l_dice = 100;
+        qWarning("outbound_queue_grace is not an int!");
+        l_snapshot->outbound_queue_grace = 10;
     }
 
-    return l_dice;
-}
+    l_snapshot->network_threads = m_settings->value("Options/network_threads", 0).toInt(&ok);
+    if (!ok || l_snapshot->network_threads < 0) {
+        qWarning("network_threads is not a valid thread count!");
+        l_snapshot->network_threads = 0;
+    }
 
-bool ConfigManager::discordWebhookEnabled() { return m_discord->value("Discord/webhook_enabled", false).toBool(); }
+    // The game thread keeps one core to itself.
+    if (l_snapshot->network_threads == 0)
+        l_snapshot->network_threads = qMax(QThread::idealThreadCount() - 1, 1);
 
-bool ConfigManager::discordModcallWebhookEnabled() { return m_discord->value("Discord/webhook_modcall_enabled", false).toBool(); }
+    l_snapshot->connection_rate_ip = m_settings->value("Options/connection_rate_ip", 20).toInt(&ok);
+    if (!ok) {
+        qWarning("connection_rate_ip is not an int!");
+        l_snapshot->connection_rate_ip = 20;
+    }
 
-QString ConfigManager::discordModcallWebhookUrl() { return m_discord->value("Discord/webhook_modcall_url", "").toString(); }
+    l_snapshot->connection_rate_subnet = m_settings->value("Options/connection_rate_subnet", 60).toInt(&ok);
+    if (!ok) {
+        qWarning("connection_rate_subnet is not an int!");
+        l_snapshot->connection_rate_subnet = 60;
+    }
 
-QString ConfigManager::discordModcallWebhookContent() { return m_discord->value("Discord/webhook_modcall_content", "").toString(); }
+    l_snapshot->connection_rate_global = m_settings->value("Options/connection_rate_global", 50).toInt(&ok);
+    if (!ok) {
+        qWarning("connection_rate_global is not an int!");
+        l_snapshot->connection_rate_global = 50;
+    }
 
-bool ConfigManager::discordModcallWebhookSendFile() { return m_discord->value("Discord/webhook_modcall_sendfile", false).toBool(); }
+    QByteArray l_url = m_settings->value("Options/asset_url", "").toString().toUtf8();
+    if (QUrl(l_url).isValid())
+        l_snapshot->asset_url = QUrl(l_url);
+    else
+        qWarning("asset_url is not a valid url!");
 
-bool ConfigManager::discordBanWebhookEnabled() { return m_discord->value("Discord/webhook_ban_enabled", false).toBool(); }
+    l_snapshot->dice_max_value = m_settings->value("Dice/max_value", 100).toInt(&ok);
+    if (!ok) {
+        qWarning("max_value is not an int!");
+        l_snapshot->dice_max_value = 100;
+    }
 
-QString ConfigManager::discordBanWebhookUrl() { return m_discord->value("Discord/webhook_ban_url", "").toString(); }
+    l_snapshot->dice_max_dice = m_settings->value("Dice/max_dice", 100).toInt(&ok);
+    if (!ok) {
+        qWarning("max_dice is not an int!");
+        l_snapshot->dice_max_dice = 100;
+    }
 
-bool ConfigManager::discordUptimeEnabled() { return m_discord->value("Discord/webhook_uptime_enabled", "false").toBool(); }
+    l_snapshot->discord_webhook_enabled = m_discord->value("Discord/webhook_enabled", false).toBool();
+    l_snapshot->discord_modcall_webhook_enabled = m_discord->value("Discord/webhook_modcall_enabled", false).toBool();
+    l_snapshot->discord_modcall_webhook_url = m_discord->value("Discord/webhook_modcall_url", "").toString();
+    l_snapshot->discord_modcall_webhook_content = m_discord->value("Discord/webhook_modcall_content", "").toString();
+    l_snapshot->discord_modcall_webhook_sendfile = m_discord->value("Discord/webhook_modcall_sendfile", false).toBool();
+    l_snapshot->discord_ban_webhook_enabled = m_discord->value("Discord/webhook_ban_enabled", false).toBool();
+    l_snapshot->discord_ban_webhook_url = m_discord->value("Discord/webhook_ban_url", "").toString();
+    l_snapshot->discord_uptime_enabled = m_discord->value("Discord/webhook_uptime_enabled", "false").toBool();
 
-int ConfigManager::discordUptimeTime()
-{
-    bool ok;
-    int l_aliveTime = m_discord->value("Discord/webhook_uptime_time", "60").toInt(&ok);
+    l_snapshot->discord_uptime_time = m_discord->value("Discord/webhook_uptime_time", "60").toInt(&ok);
     if (!ok) {
         qWarning("alive_time is not an int");
-        l_aliveTime = 60;
+        l_snapshot->discord_uptime_time = 60;
     }
 
-    return l_aliveTime;
-}
+    l_snapshot->discord_uptime_webhook_url = m_discord->value("Discord/webhook_uptime_url", "").toString();
 
-QString ConfigManager::discordUptimeWebhookUrl() { return m_discord->value("Discord/webhook_uptime_url", "").toString(); }
-
-QString ConfigManager::discordWebhookColor()
-{
     const QString l_default_color = "13312842";
-    QString l_color = m_discord->value("Discord/webhook_color", l_default_color).toString();
-    if (l_color.isEmpty())
-        return l_default_color;
-    else
-        return l_color;
-}
+    l_snapshot->discord_webhook_color = m_discord->value("Discord/webhook_color", l_default_color).toString();
+    if (l_snapshot->discord_webhook_color.isEmpty())
+        l_snapshot->discord_webhook_color = l_default_color;
 
-bool ConfigManager::passwordRequirements() { return m_settings->value("Password/password_requirements", true).toBool(); }
+    l_snapshot->password_requirements = m_settings->value("Password/password_requirements", true).toBool();
 
-int ConfigManager::passwordMinLength()
-{
-    bool ok;
-    int l_min = m_settings->value("Password/pass_min_length", 8).toInt(&ok);
+    l_snapshot->password_min_length = m_settings->value("Password/pass_min_length", 8).toInt(&ok);
     if (!ok) {
         qWarning("pass_min_length is not an int!");
-        l_min = 8;
+        l_snapshot->password_min_length = 8;
     }
 
-    return l_min;
-}
-
-int ConfigManager::passwordMaxLength()
-{
-    bool ok;
-    int l_max = m_settings->value("Password/pass_max_length", 0).toInt(&ok);
+    l_snapshot->password_max_length = m_settings->value("Password/pass_max_length", 0).toInt(&ok);
     if (!ok) {
         qWarning("pass_max_length is not an int!");
-        l_max = 0;
+        l_snapshot->password_max_length = 0;
     }
 
-    return l_max;
+    l_snapshot->password_require_mix_case = m_settings->value("Password/pass_required_mix_case", true).toBool();
+    l_snapshot->password_require_numbers = m_settings->value("Password/pass_required_numbers", true).toBool();
+    l_snapshot->password_require_special = m_settings->value("Password/pass_required_special", true).toBool();
+    l_snapshot->password_can_contain_username = m_settings->value("Password/pass_can_contain_username", false).toBool();
+
+    l_snapshot->automod_trigger = m_settings->value("Options/automodtrig", 300).toInt();
+    l_snapshot->automod_ooc_trigger = m_settings->value("Options/automodooctrig", 300).toInt();
+    l_snapshot->automod_warns = m_settings->value("Options/automodwarns", 3).toInt();
+    l_snapshot->automod_haznum_term = m_settings->value("Options/automodhaznumterm", "7d").toString();
+    l_snapshot->automod_ban_duration = m_settings->value("Options/automodbanduration", "7d").toString();
+    l_snapshot->automod_warn_term = m_settings->value("Options/automodwarnterm", "30m").toString();
+    l_snapshot->ytdlp = m_settings->value("Options/ytdlp", true).toBool();
+
+    l_snapshot->advertise = m_settings->value("Advertiser/advertise", "true").toBool();
+    l_snapshot->serverlist_url = m_settings->value("Advertiser/ms_ip", "").toUrl();
+    l_snapshot->hostname = m_settings->value("Advertiser/hostname", "").toString();
+    l_snapshot->cloudflare_enabled = m_settings->value("Advertiser/cloudflare_enabled", "false").toBool();
+
+    l_snapshot->wuso = m_settings->value("Options/wuso", "false").toBool();
+    l_snapshot->area_limit = m_settings->value("Options/arealimit", "25").toInt();
+
+    return l_snapshot;
 }
 
-bool ConfigManager::passwordRequireMixCase() { return m_settings->value("Password/pass_required_mix_case", true).toBool(); }
+QStringList ConfigManager::loadConfigFile(const QString filename)
+{
+    QStringList stringlist;
+    QFile l_file("config/text/" + filename + ".txt");
+    l_file.open(QIODevice::ReadOnly | QIODevice::Text);
+
+    while (!(l_file.atEnd()))
+        stringlist.append(l_file.readLine().trimmed());
+
+    l_file.close();
+    return stringlist;
+}
+
+int ConfigManager::maxPlayers() { return snapshot()->max_players; }
+
+int ConfigManager::serverPort() { return snapshot()->port; }
+
+QString ConfigManager::serverDescription() { return snapshot()->server_description; }
+
+QString ConfigManager::serverName() { return snapshot()->server_name; }
+
+QString ConfigManager::motd() { return snapshot()->motd; }
 
-bool ConfigManager::passwordRequireNumbers() { return m_settings->value("Password/pass_required_numbers", true).toBool(); }
+bool ConfigManager::webaoEnabled() { return snapshot()->webao_enabled; }
 
-bool ConfigManager::passwordRequireSpecialCharacters() { return m_settings->value("Password/pass_required_special", true).toBool(); }
+DataTypes::AuthType ConfigManager::authType() { return snapshot()->auth; }
 
-bool ConfigManager::passwordCanContainUsername() { return m_settings->value("Password/pass_can_contain_username", false).toBool(); }
+QString ConfigManager::modpass() { return snapshot()->modpass; }
+
+int ConfigManager::logBuffer() { return snapshot()->log_buffer; }
+
+qsizetype ConfigManager::logBufferSize() { return snapshot()->log_buffer_size; }
+
+DataTypes::LogType ConfigManager::loggingType() { return snapshot()->logging; }
+
+int ConfigManager::maxStatements() { return snapshot()->max_statements; }
+
+int ConfigManager::multiClientLimit() { return snapshot()->multiclient_limit; }
+
+int ConfigManager::maxCharacters() { return snapshot()->max_characters; }
+
+int ConfigManager::maxCharactersChillMod() { return snapshot()->max_characters_chillmod; }
+
+int ConfigManager::messageFloodguard() { return snapshot()->message_floodguard; }
+
+qint64 ConfigManager::outboundQueueLimit() { return snapshot()->outbound_queue_limit; }
+
+int ConfigManager::outboundQueueGrace() { return snapshot()->outbound_queue_grace; }
+
+int ConfigManager::networkThreads() { return snapshot()->network_threads; }
+
+int ConfigManager::connectionRateIP() { return snapshot()->connection_rate_ip; }
+
+int ConfigManager::connectionRateSubnet() { return snapshot()->connection_rate_subnet; }
+
+int ConfigManager::connectionRateGlobal() { return snapshot()->connection_rate_global; }
+
+QUrl ConfigManager::assetUrl() { return snapshot()->asset_url; }
+
+int ConfigManager::diceMaxValue() { return snapshot()->dice_max_value; }
+
+int ConfigManager::diceMaxDice() { return snapshot()->dice_max_dice; }
+
+bool ConfigManager::discordWebhookEnabled() { return snapshot()->discord_webhook_enabled; }
+
+bool ConfigManager::discordModcallWebhookEnabled() { return snapshot()->discord_modcall_webhook_enabled; }
+
+QString ConfigManager::discordModcallWebhookUrl() { return snapshot()->discord_modcall_webhook_url; }
+
+QString ConfigManager::discordModcallWebhookContent() { return snapshot()->discord_modcall_webhook_content; }
+
+bool ConfigManager::discordModcallWebhookSendFile() { return snapshot()->discord_modcall_webhook_sendfile; }
+
+bool ConfigManager::discordBanWebhookEnabled() { return snapshot()->discord_ban_webhook_enabled; }
+
+QString ConfigManager::discordBanWebhookUrl() { return snapshot()->discord_ban_webhook_url; }
+
+bool ConfigManager::discordUptimeEnabled() { return snapshot()->discord_uptime_enabled; }
+
+int ConfigManager::discordUptimeTime() { return snapshot()->discord_uptime_time; }
+
+QString ConfigManager::discordUptimeWebhookUrl() { return snapshot()->discord_uptime_webhook_url; }
+
+QString ConfigManager::discordWebhookColor() { return snapshot()->discord_webhook_color; }
+
+bool ConfigManager::passwordRequirements() { return snapshot()->password_requirements; }
+
+int ConfigManager::passwordMinLength() { return snapshot()->password_min_length; }
+
+int ConfigManager::passwordMaxLength() { return snapshot()->password_max_length; }
+
+bool ConfigManager::passwordRequireMixCase() { return snapshot()->password_require_mix_case; }
+
+bool ConfigManager::passwordRequireNumbers() { return snapshot()->password_require_numbers; }
+
+bool ConfigManager::passwordRequireSpecialCharacters() { return snapshot()->password_require_special; }
+
+bool ConfigManager::passwordCanContainUsername() { return snapshot()->password_can_contain_username; }
 
 QString ConfigManager::LogText(QString f_logtype) { return m_logtext->value("LogConfiguration/" + f_logtype, "").toString(); }
 
-int ConfigManager::autoModTrigger() { return m_settings->value("Options/automodtrig", 300).toInt(); }
+int ConfigManager::autoModTrigger() { return snapshot()->automod_trigger; }
 
-int ConfigManager::autoModOocTrigger() { return m_settings->value("Options/automodooctrig", 300).toInt(); }
+int ConfigManager::autoModOocTrigger() { return snapshot()->automod_ooc_trigger; }
 
-int ConfigManager::autoModWarns() { return m_settings->value("Options/automodwarns", 3).toInt(); }
+int ConfigManager::autoModWarns() { return snapshot()->automod_warns; }
 
-QString ConfigManager::autoModHaznumTerm() { return m_settings->value("Options/automodhaznumterm", "7d").toString(); }
+QString ConfigManager::autoModHaznumTerm() { return snapshot()->automod_haznum_term; }
 
-QString ConfigManager::autoModBanDuration() { return m_settings->value("Options/automodbanduration", "7d").toString(); }
+QString ConfigManager::autoModBanDuration() { return snapshot()->automod_ban_duration; }
 
-QString ConfigManager::autoModWarnTerm() { return m_settings->value("Options/automodwarnterm", "30m").toString(); }
+QString ConfigManager::autoModWarnTerm() { return snapshot()->automod_warn_term; }
 
-bool ConfigManager::useYtdlp() { return m_settings->value("Options/ytdlp", true).toBool(); }
+bool ConfigManager::useYtdlp() { return snapshot()->ytdlp; }
 
-void ConfigManager::setAuthType(const DataTypes::AuthType f_auth) { m_settings->setValue("Options/auth", fromDataType<DataTypes::AuthType>(f_auth).toLower()); }
+void ConfigManager::setAuthType(const DataTypes::AuthType f_auth)
+{
+    m_settings->setValue("Options/auth", fromDataType<DataTypes::AuthType>(f_auth).toLower());
+    publishSnapshot();
+}
 
 QStringList ConfigManager::magic8BallAnswers() { return m_commands->magic_8ball; }
 
@@ -501,25 +582,33 @@ QStringList ConfigManager::gimpList() { return m_commands->gimps; }
 
 QStringList ConfigManager::cdnList() { return m_commands->cdns; }
 
-bool ConfigManager::publishServerEnabled() { return m_settings->value("Advertiser/advertise", "true").toBool(); }
+bool ConfigManager::publishServerEnabled() { return snapshot()->advertise; }
 
-QUrl ConfigManager::serverlistURL() { return m_settings->value("Advertiser/ms_ip", "").toUrl(); }
+QUrl ConfigManager::serverlistURL() { return snapshot()->serverlist_url; }
 
-QString ConfigManager::serverDomainName() { return m_settings->value("Advertiser/hostname", "").toString(); }
+QString ConfigManager::serverDomainName() { return snapshot()->hostname; }
 
-bool ConfigManager::advertiseWSProxy() { return m_settings->value("Advertiser/cloudflare_enabled", "false").toBool(); }
+bool ConfigManager::advertiseWSProxy() { return snapshot()->cloudflare_enabled; }
 
 qint64 ConfigManager::uptime() { return m_uptimeTimer->elapsed(); }
 
-void ConfigManager::setMotd(const QString f_motd) { m_settings->setValue("Options/motd", f_motd); }
+void ConfigManager::setMotd(const QString f_motd)
+{
+    m_settings->setValue("Options/motd", f_motd);
+    publishSnapshot();
+}
 
-bool ConfigManager::webUsersSpectableOnly() { return m_settings->value("Options/wuso", "false").toBool(); }
+bool ConfigManager::webUsersSpectableOnly() { return snapshot()->wuso; }
 
-void ConfigManager::webUsersSpectableOnlyToggle() { m_settings->setValue("Options/wuso", !webUsersSpectableOnly()); }
+void ConfigManager::webUsersSpectableOnlyToggle()
+{
+    m_settings->setValue("Options/wuso", !webUsersSpectableOnly());
+    publishSnapshot();
+}
 
 QStringList ConfigManager::getCustomStatuses() { return loadConfigFile("customstatuses"); }
 
-int ConfigManager::getAreaCountLimit() { return m_settings->value("Options/arealimit", "25").toInt(); }
+int ConfigManager::getAreaCountLimit() { return snapshot()->area_limit; }
 
 bool ConfigManager::fileExists(const QFileInfo &f_file) { return (f_file.exists() && f_file.isFile()); }
 
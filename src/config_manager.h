@@ -28,8 +28,11 @@
 #include <QHostAddress>
 #include <QMetaEnum>
 #include <QSettings>
+#include <QThread>
 #include <QUrl>
 
+#include <atomic>
+
 #include "data_types.h"
 
 /**
@@ -74,6 +77,15 @@ class ConfigManager
      */
     static QStringList musiclist();
 
+    /**
+     * @brief Reads the ordered musiclist from music.txt.
+     *
+     * @details Unlike musiclist(), this does not touch any shared state and may be called from any thread.
+     *
+     * @return See short description.
+     */
+    static QStringList loadMusicList();
+
     /**
      * @brief Returns an ordered QList of all basesongs of this server.
      *
@@ -181,6 +193,13 @@ class ConfigManager
      */
     static int logBuffer();
 
+    /**
+     * @brief Returns the maximum combined size, in characters, of the log entries an area stores.
+     *
+     * @return See short description.
+     */
+    static qsizetype logBufferSize();
+
     /**
      * @brief Returns the server's logging type.
      *
@@ -227,6 +246,48 @@ class ConfigManager
      */
     static int messageFloodguard();
 
+    /**
+     * @brief Returns the maximum amount of data, in bytes, that may be waiting to be sent to a single client.
+     *
+     * @return See short description.
+     */
+    static qint64 outboundQueueLimit();
+
+    /**
+     * @brief Returns how long, in seconds, a client may stay above the outbound queue limit before being disconnected.
+     *
+     * @return See short description.
+     */
+    static int outboundQueueGrace();
+
+    /**
+     * @brief Returns the amount of threads that handle websocket I/O.
+     *
+     * @return See short description. If the option is 0, one less than the amount of cores, but at least one.
+     */
+    static int networkThreads();
+
+    /**
+     * @brief Returns how many connections per minute are accepted from a single IP address.
+     *
+     * @return See short description. 0 disables the limit.
+     */
+    static int connectionRateIP();
+
+    /**
+     * @brief Returns how many connections per minute are accepted from a single /24 (IPv4) or /48 (IPv6) subnet.
+     *
+     * @return See short description. 0 disables the limit.
+     */
+    static int connectionRateSubnet();
+
+    /**
+     * @brief Returns how many connections per second are accepted in total.
+     *
+     * @return See short description. 0 disables the limit.
+     */
+    static int connectionRateGlobal();
+
     /**
      * @brief Returns the URL where the server should retrieve remote assets from.
      *
@@ -522,11 +583,118 @@ class ConfigManager
         QStringList cdns;        //!< Contains domains for custom song validation, found in config/text/cdns.txt
     };
 
+    /**
+     * @brief An immutable copy of every scalar setting from config.ini and discord.ini, parsed and validated once.
+     *
+     * @details The fields are named after the keys they are read from. See the getter of the same setting for its meaning.
+     */
+    struct Snapshot
+    {
+        QString bind_ip;
+        int max_players;
+        int port;
+        QString server_description;
+        QString server_name;
+        QString motd;
+        bool webao_enabled;
+        DataTypes::AuthType auth;
+        QString modpass;
+        int log_buffer;
+        qsizetype log_buffer_size;
+        DataTypes::LogType logging;
+        int max_statements;
+        int multiclient_limit;
+        int max_characters;
+        int max_characters_chillmod;
+        int message_floodguard;
+        qint64 outbound_queue_limit;
+        int outbound_queue_grace;
+        int network_threads;
+        int connection_rate_ip;
+        int connection_rate_subnet;
+        int connection_rate_global;
+        QUrl asset_url;
+        int dice_max_value;
+        int dice_max_dice;
+        bool discord_webhook_enabled;
+        bool discord_modcall_webhook_enabled;
+        QString discord_modcall_webhook_url;
+        QString discord_modcall_webhook_content;
+        bool discord_modcall_webhook_sendfile;
+        bool discord_ban_webhook_enabled;
+        QString discord_ban_webhook_url;
+        bool discord_uptime_enabled;
+        int discord_uptime_time;
+        QString discord_uptime_webhook_url;
+        QString discord_webhook_color;
+        bool password_requirements;
+        int password_min_length;
+        int password_max_length;
+        bool password_require_mix_case;
+        bool password_require_numbers;
+        bool password_require_special;
+        bool password_can_contain_username;
+        int automod_trigger;
+        int automod_ooc_trigger;
+        int automod_warns;
+        QString automod_haznum_term;
+        QString automod_ban_duration;
+        QString automod_warn_term;
+        bool ytdlp;
+        bool advertise;
+        QUrl serverlist_url;
+        QString hostname;
+        bool cloudflare_enabled;
+        bool wuso;
+        int area_limit;
+    };
+
     /**
      * @brief Contains the settings required for various commands.
      */
     static CommandSettings *m_commands;
 
+    /**
+     * @brief A replaced snapshot that another thread may still be reading.
+     */
+    struct RetiredSnapshot
+    {
+        const Snapshot *snapshot; //!< The replaced snapshot.
+        QElapsedTimer age;        //!< Started when the snapshot was replaced.
+    };
+
+    /**
+     * @brief Milliseconds a replaced snapshot is kept before it is freed.
+     *
+     * @details Getters only hold the snapshot pointer while copying out a single field, so this is generous.
+     */
+    static constexpr qint64 SNAPSHOT_GRACE = 10000;
+
+    /**
+     * @brief The current settings. Replaced as a whole whenever the configuration is reloaded or changed.
+     */
+    static std::atomic<const Snapshot *> m_snapshot;
+
+    /**
+     * @brief Snapshots that were replaced, oldest first. Freed by publishSnapshot() once #SNAPSHOT_GRACE has passed.
+     */
+    static QList<RetiredSnapshot> *m_retired_snapshots;
+
+    /**
+     * @brief Returns the current settings.
+     */
+    static const Snapshot *snapshot();
+
+    /**
+     * @brief Reads all scalar settings from the settings files into a new snapshot.
+     */
+    static Snapshot *parseSnapshot();
+
+    /**
+     * @brief Parses a new snapshot and makes it the current one.
+     */
+    static void publishSnapshot();
+
     /**
      * @brief Stores all server configuration values.
      */
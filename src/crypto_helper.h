@@ -20,6 +20,7 @@
 
 #include <QMessageAuthenticationCode>
 #include <QString>
+#include <cstring>
 #if QT_VERSION > QT_VERSION_CHECK(5, 10, 0)
 #include <QRandomGenerator>
 #endif
@@ -66,6 +67,105 @@ class CryptoHelper
         return hmac(salt.toUtf8(), password.toUtf8()).toHex();
     }
 
+    /**
+     * @brief Minimal SHA-256 implementation whose state can be copied
+     *
+     * @details QCryptographicHash cannot be copied halfway through a message, which is what lets PBKDF2 hash the
+     * HMAC key pads once per derivation instead of once per iteration.
+     */
+    struct Sha256
+    {
+        quint32 state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        quint8 buffer[64] = {};
+        quint64 length = 0; //!< Bytes hashed so far.
+
+        void update(const void *f_data, qsizetype f_size)
+        {
+            const quint8 *l_data = static_cast<const quint8 *>(f_data);
+            qsizetype l_used = static_cast<qsizetype>(length % 64);
+            length += f_size;
+            if (l_used != 0) {
+                qsizetype l_take = qMin<qsizetype>(64 - l_used, f_size);
+                memcpy(buffer + l_used, l_data, l_take);
+                l_data += l_take;
+                f_size -= l_take;
+                if (l_used + l_take < 64)
+                    return;
+                compress(buffer);
+            }
+
+            for (; f_size >= 64; l_data += 64, f_size -= 64)
+                compress(l_data);
+            memcpy(buffer, l_data, f_size);
+        }
+
+        void finish(quint8 *f_digest)
+        {
+            const quint64 l_bits = length * 8;
+            const quint8 l_padding[64] = {0x80};
+            qsizetype l_used = static_cast<qsizetype>(length % 64);
+            update(l_padding, l_used < 56 ? 56 - l_used : 120 - l_used);
+
+            quint8 l_length[8];
+            for (int i = 0; i < 8; i++)
+                l_length[i] = static_cast<quint8>(l_bits >> (56 - 8 * i));
+            update(l_length, 8);
+
+            for (int i = 0; i < 8; i++) {
+                f_digest[4 * i] = static_cast<quint8>(state[i] >> 24);
+                f_digest[4 * i + 1] = static_cast<quint8>(state[i] >> 16);
+                f_digest[4 * i + 2] = static_cast<quint8>(state[i] >> 8);
+                f_digest[4 * i + 3] = static_cast<quint8>(state[i]);
+            }
+        }
+
+        void compress(const quint8 *f_block)
+        {
+            static constexpr quint32 k[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+            auto rotr = [](quint32 x, int n) { return (x >> n) | (x << (32 - n)); };
+
+            quint32 w[64];
+            for (int i = 0; i < 16; i++)
+                w[i] = (quint32(f_block[4 * i]) << 24) | (quint32(f_block[4 * i + 1]) << 16) | (quint32(f_block[4 * i + 2]) << 8) | quint32(f_block[4 * i + 3]);
+            for (int i = 16; i < 64; i++) {
+                quint32 s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                quint32 s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            quint32 a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; i++) {
+                quint32 t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+                quint32 t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                h = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = b;
+                b = a;
+                a = t1 + t2;
+            }
+
+            state[0] += a;
+            state[1] += b;
+            state[2] += c;
+            state[3] += d;
+            state[4] += e;
+            state[5] += f;
+            state[6] += g;
+            state[7] += h;
+        }
+    };
+
     /**
      * @brief Perform the PBKDF2 key-derivation function
      *
@@ -73,25 +173,65 @@ class CryptoHelper
      * does not apply here. Instead, we fix the output to the size of the underlying
      * hash function, which greatly simplifies the algorithm.
      *
+     * Each iteration costs two SHA-256 compressions and no allocations.
+     *
      * @param salt Salt value
      * @param password Password value
      * @return QString PBKDF2 result, hex encoded
      */
     static QString pbkdf2(QByteArray salt, QString password)
     {
-        QByteArray bigendian_one("\x00\x00\x00\x01", 4);
-        QByteArray last_block = salt;
-        last_block.append(bigendian_one);
+        // HMAC hashes (key ^ ipad) and (key ^ opad) as the first block of every call. Both only depend on the
+        // password, so they are hashed once here and every iteration continues from a copy.
+        QByteArray l_key = password.toUtf8();
+        quint8 l_key_block[64] = {};
+        if (l_key.size() > 64) {
+            Sha256 l_key_hash;
+            l_key_hash.update(l_key.constData(), l_key.size());
+            l_key_hash.finish(l_key_block);
+        }
+        else
+            memcpy(l_key_block, l_key.constData(), l_key.size());
+
+        quint8 l_inner_pad[64];
+        quint8 l_outer_pad[64];
+        for (int i = 0; i < 64; i++) {
+            l_inner_pad[i] = l_key_block[i] ^ 0x36;
+            l_outer_pad[i] = l_key_block[i] ^ 0x5c;
+        }
+
+        Sha256 l_inner;
+        l_inner.update(l_inner_pad, 64);
+        Sha256 l_outer;
+        l_outer.update(l_outer_pad, 64);
+
+        // U_1 = HMAC(password, salt || INT(1))
+        const quint8 bigendian_one[4] = {0, 0, 0, 1};
+        quint8 l_block[pbkdf2_output_len];
+        Sha256 l_hash = l_inner;
+        l_hash.update(salt.constData(), salt.size());
+        l_hash.update(bigendian_one, 4);
+        l_hash.finish(l_block);
+        l_hash = l_outer;
+        l_hash.update(l_block, pbkdf2_output_len);
+        l_hash.finish(l_block);
 
-        QByteArray result(pbkdf2_output_len, '\0');
+        quint8 l_result[pbkdf2_output_len];
+        memcpy(l_result, l_block, pbkdf2_output_len);
 
-        for (unsigned int i = 0; i < pbkdf2_cost; i++) {
-            last_block = hmac(password.toUtf8(), last_block);
-            for (unsigned int n = 0; n < pbkdf2_output_len; n++)
-                result[n] = result[n] ^ last_block[n];
+        // U_i = HMAC(password, U_(i-1))
+        for (quint32 i = 1; i < pbkdf2_cost; i++) {
+            l_hash = l_inner;
+            l_hash.update(l_block, pbkdf2_output_len);
+            l_hash.finish(l_block);
+            l_hash = l_outer;
+            l_hash.update(l_block, pbkdf2_output_len);
+            l_hash.finish(l_block);
+            for (int n = 0; n < pbkdf2_output_len; n++)
+                l_result[n] ^= l_block[n];
         }
 
-        return result.toHex();
+        return QByteArray(reinterpret_cast<const char *>(l_result), pbkdf2_output_len).toHex();
     }
 
   public:
@@ -125,6 +265,21 @@ class CryptoHelper
         return pbkdf2(salt, password);
     }
 
+    /**
+     * @brief Check a password against a stored hash
+     *
+     * @details Expensive for PBKDF2 hashes, so callers on the game thread should run it through QtConcurrent.
+     *
+     * @param salt Salt value the stored hash was made with
+     * @param password Password value to check
+     * @param stored_hash The stored hash, hex encoded
+     * @return bool True if the password matches
+     */
+    static bool verify_password(QByteArray salt, QString password, QString stored_hash)
+    {
+        return hash_password(salt, password) == stored_hash;
+    }
+
     /**
      * @brief Generate a random octet
      *
@@ -19,7 +19,18 @@
 #include <QDir>
 
 DBManager::DBManager() :
-    DRIVER("QSQLITE")
+    DRIVER("QSQLITE"),
+    CONN_NAME("akashi"),
+    m_thread(new QThread(this)),
+    m_worker(new QObject)
+{
+    m_thread->setObjectName("database");
+    m_worker->moveToThread(m_thread);
+    m_thread->start();
+    QMetaObject::invokeMethod(m_worker, [this] { openDB(); }, Qt::BlockingQueuedConnection);
+}
+
+void DBManager::openDB()
 {
     const QString db_filename = "logs/akashi.db";
     QFileInfo db_info(db_filename);
@@ -33,16 +44,23 @@ DBManager::DBManager() :
             qCritical() << tr("Database Error: Missing permissions. Check if \"%1\" is writable.").arg(db_filename);
     }
 
-    db = QSqlDatabase::addDatabase(DRIVER);
+    db = QSqlDatabase::addDatabase(DRIVER, CONN_NAME);
     db.setDatabaseName("logs/akashi.db");
     if (!db.open())
         qCritical() << "Database Error:" << db.lastError();
 
-    QSqlQuery create_ban_table("CREATE TABLE IF NOT EXISTS bans ('ID' INTEGER, 'IPID' TEXT, 'HDID' TEXT, 'IP' TEXT, 'TIME' INTEGER, 'REASON' TEXT, 'DURATION' INTEGER, 'MODERATOR' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))");
-    QSqlQuery create_user_table("CREATE TABLE IF NOT EXISTS users ('ID' INTEGER, 'USERNAME' TEXT, 'SALT' TEXT, 'PASSWORD' TEXT, 'ACL' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))");
-    QSqlQuery create_ipidip_table("CREATE TABLE IF NOT EXISTS ipidip ('ID' INTEGER, 'IPID' TEXT, 'IP' TEXT, 'CREATED' TEXT, 'HWID' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))");
-    QSqlQuery create_automod_table("CREATE TABLE IF NOT EXISTS automod ('ID' INTEGER, 'IPID' TEXT, 'DATE' TEXT, 'ACTION' TEXT, 'HAZNUM' INTEGER, PRIMARY KEY('ID' AUTOINCREMENT))");
-    QSqlQuery create_automodwarns_table("CREATE TABLE IF NOT EXISTS automodwarns ('ID' INTEGER, 'IPID' TEXT, 'DATE' TEXT, 'WARNS' INTEGER, PRIMARY KEY('ID' AUTOINCREMENT))");
+    // WAL lets readers and the batched writes proceed without blocking each other, and NORMAL is
+    // durable in WAL mode except for the last commits before a power loss.
+    QSqlQuery("PRAGMA journal_mode = WAL", db);
+    QSqlQuery("PRAGMA synchronous = NORMAL", db);
+    QSqlQuery("PRAGMA cache_size = -" + QString::number(CACHE_SIZE), db);
+    QSqlQuery("PRAGMA temp_store = MEMORY", db);
+
+    QSqlQuery create_ban_table("CREATE TABLE IF NOT EXISTS bans ('ID' INTEGER, 'IPID' TEXT, 'HDID' TEXT, 'IP' TEXT, 'TIME' INTEGER, 'REASON' TEXT, 'DURATION' INTEGER, 'MODERATOR' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", db);
+    QSqlQuery create_user_table("CREATE TABLE IF NOT EXISTS users ('ID' INTEGER, 'USERNAME' TEXT, 'SALT' TEXT, 'PASSWORD' TEXT, 'ACL' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", db);
+    QSqlQuery create_ipidip_table("CREATE TABLE IF NOT EXISTS ipidip ('ID' INTEGER, 'IPID' TEXT, 'IP' TEXT, 'CREATED' TEXT, 'HWID' TEXT, PRIMARY KEY('ID' AUTOINCREMENT))", db);
+    QSqlQuery create_automod_table("CREATE TABLE IF NOT EXISTS automod ('ID' INTEGER, 'IPID' TEXT, 'DATE' TEXT, 'ACTION' TEXT, 'HAZNUM' INTEGER, PRIMARY KEY('ID' AUTOINCREMENT))", db);
+    QSqlQuery create_automodwarns_table("CREATE TABLE IF NOT EXISTS automodwarns ('ID' INTEGER, 'IPID' TEXT, 'DATE' TEXT, 'WARNS' INTEGER, PRIMARY KEY('ID' AUTOINCREMENT))", db);
 
     create_ban_table.exec();
     create_user_table.exec();
@@ -50,7 +68,7 @@ DBManager::DBManager() :
     create_automod_table.exec();
     create_automodwarns_table.exec();
 
-    QSqlQuery query;
+    QSqlQuery query(db);
     query.prepare("SELECT HWID FROM ipidip");
     query.setForwardOnly(true);
     query.exec();
@@ -64,12 +82,53 @@ DBManager::DBManager() :
     db_version = checkVersion();
     if (db_version != DB_VERSION)
         updateDB(db_version);
+
+    m_commit_timer = new QTimer(m_worker);
+    m_commit_timer->setSingleShot(true);
+    m_commit_timer->setInterval(WRITE_BATCH_INTERVAL);
+    connect(m_commit_timer, &QTimer::timeout, m_worker, [this] { commitWrites(); });
+}
+
+QSqlQuery &DBManager::statement(const QString &f_sql)
+{
+    auto l_it = m_statements.find(f_sql);
+    if (l_it == m_statements.end()) {
+        QSqlQuery l_query(db);
+        l_query.setForwardOnly(true);
+        if (!l_query.prepare(f_sql))
+            qDebug() << "SQL Error:" << l_query.lastError().text();
+        l_it = m_statements.insert(f_sql, l_query);
+    }
+
+    return l_it.value();
+}
+
+void DBManager::releaseStatements()
+{
+    for (QSqlQuery &l_query : m_statements)
+        if (l_query.isActive())
+            l_query.finish();
+}
+
+void DBManager::commitWrites()
+{
+    m_commit_timer->stop();
+    if (m_pending_writes.isEmpty())
+        return;
+
+    const QList<std::function<void()>> l_writes = std::exchange(m_pending_writes, {});
+    db.transaction();
+    for (const std::function<void()> &l_write : l_writes)
+        l_write();
+
+    releaseStatements();
+    if (!db.commit())
+        qDebug() << "SQL Error:" << db.lastError().text();
 }
 
 QPair<bool, DBManager::BanInfo> DBManager::isIPBanned(QString ipid)
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM BANS WHERE IPID = ? ORDER BY TIME DESC");
+    QSqlQuery &query = statement("SELECT * FROM BANS WHERE IPID = ? ORDER BY TIME DESC");
     query.addBindValue(ipid);
     query.exec();
     BanInfo ban;
@@ -97,8 +156,7 @@ QPair<bool, DBManager::BanInfo> DBManager::isIPBanned(QString ipid)
 
 QPair<bool, DBManager::BanInfo> DBManager::isHDIDBanned(QString hdid)
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM BANS WHERE HDID = ? ORDER BY TIME DESC");
+    QSqlQuery &query = statement("SELECT * FROM BANS WHERE HDID = ? ORDER BY TIME DESC");
     query.addBindValue(hdid);
     query.exec();
     BanInfo ban;
@@ -126,8 +184,7 @@ QPair<bool, DBManager::BanInfo> DBManager::isHDIDBanned(QString hdid)
 
 int DBManager::getBanID(QString hdid)
 {
-    QSqlQuery query;
-    query.prepare("SELECT ID FROM BANS WHERE HDID = ? ORDER BY TIME DESC");
+    QSqlQuery &query = statement("SELECT ID FROM BANS WHERE HDID = ? ORDER BY TIME DESC");
     query.addBindValue(hdid);
     query.exec();
     if (query.first())
@@ -138,8 +195,7 @@ int DBManager::getBanID(QString hdid)
 
 int DBManager::getBanID(QHostAddress ip)
 {
-    QSqlQuery query;
-    query.prepare("SELECT ID FROM BANS WHERE IP = ? ORDER BY TIME DESC");
+    QSqlQuery &query = statement("SELECT ID FROM BANS WHERE IP = ? ORDER BY TIME DESC");
     query.addBindValue(ip.toString());
     query.exec();
     if (query.first())
@@ -151,9 +207,7 @@ int DBManager::getBanID(QHostAddress ip)
 QList<DBManager::BanInfo> DBManager::getRecentBans()
 {
     QList<BanInfo> return_list;
-    QSqlQuery query;
-    query.prepare("SELECT * FROM BANS ORDER BY TIME DESC LIMIT 5");
-    query.setForwardOnly(true);
+    QSqlQuery &query = statement("SELECT * FROM BANS ORDER BY TIME DESC LIMIT 5");
     query.exec();
     while (query.next()) {
         BanInfo ban;
@@ -172,11 +226,39 @@ QList<DBManager::BanInfo> DBManager::getRecentBans()
     return return_list;
 }
 
+QList<DBManager::BanInfo> DBManager::getActiveBans()
+{
+    QList<BanInfo> return_list;
+    QSqlQuery &query = statement("SELECT * FROM BANS WHERE DURATION = -2 OR TIME + DURATION > ?");
+    query.addBindValue(QDateTime::currentSecsSinceEpoch());
+    query.exec();
+    while (query.next()) {
+        BanInfo ban;
+        ban.id = query.value(0).toInt();
+        ban.ipid = query.value(1).toString();
+        ban.hdid = query.value(2).toString();
+        ban.ip = QHostAddress(query.value(3).toString());
+        ban.time = static_cast<unsigned long>(query.value(4).toULongLong());
+        ban.reason = query.value(5).toString();
+        ban.duration = query.value(6).toLongLong();
+        ban.moderator = query.value(7).toString();
+        return_list.append(ban);
+    }
+
+    return return_list;
+}
+
+void DBManager::publishBan(int f_id)
+{
+    const QList<BanInfo> l_bans = getBanInfo("banid", QString::number(f_id));
+    if (!l_bans.isEmpty())
+        emit banChanged(l_bans.first());
+}
+
 void DBManager::addBan(BanInfo ban)
 {
-    QSqlQuery query;
     QList<DBManager::idipinfo> l_ipidinfo = getIpidInfo(ban.ipid);
-    query.prepare("INSERT INTO BANS(IPID, HDID, IP, TIME, REASON, DURATION, MODERATOR) VALUES(?, ?, ?, ?, ?, ?, ?)");
+    QSqlQuery &query = statement("INSERT INTO BANS(IPID, HDID, IP, TIME, REASON, DURATION, MODERATOR) VALUES(?, ?, ?, ?, ?, ?, ?)");
     query.addBindValue(ban.ipid);
     if (!ban.hdid.isEmpty())
         query.addBindValue(ban.hdid);
@@ -191,38 +273,39 @@ void DBManager::addBan(BanInfo ban)
     query.addBindValue(ban.duration);
     query.addBindValue(ban.moderator);
 
-    if (!query.exec())
+    if (!query.exec()) {
         qDebug() << "SQL Error:" << query.lastError().text();
+        return;
+    }
+
+    publishBan(query.lastInsertId().toInt());
 }
 
 bool DBManager::invalidateBan(int id)
 {
-    QSqlQuery ban_exists;
-    ban_exists.prepare("SELECT DURATION FROM bans WHERE ID = ?");
+    QSqlQuery &ban_exists = statement("SELECT DURATION FROM bans WHERE ID = ?");
     ban_exists.addBindValue(id);
     ban_exists.exec();
     if (!ban_exists.first())
         return false;
 
-    QSqlQuery query;
-    query.prepare("UPDATE bans SET DURATION = 0 WHERE ID = ?");
+    QSqlQuery &query = statement("UPDATE bans SET DURATION = 0 WHERE ID = ?");
     query.addBindValue(id);
     query.exec();
+    publishBan(id);
     return true;
 }
 
 bool DBManager::createUser(QString f_username, QByteArray f_salt, QString f_password, QString f_acl)
 {
-    QSqlQuery username_exists;
-    username_exists.prepare("SELECT ACL FROM users WHERE USERNAME = ?");
+    QSqlQuery &username_exists = statement("SELECT ACL FROM users WHERE USERNAME = ?");
     username_exists.addBindValue(f_username);
     username_exists.exec();
     if (username_exists.first())
         return false;
 
-    QSqlQuery query;
     QString salted_password = CryptoHelper::hash_password(f_salt, f_password);
-    query.prepare("INSERT INTO users(USERNAME, SALT, PASSWORD, ACL) VALUES(?, ?, ?, ?)");
+    QSqlQuery &query = statement("INSERT INTO users(USERNAME, SALT, PASSWORD, ACL) VALUES(?, ?, ?, ?)");
     query.addBindValue(f_username);
     query.addBindValue(f_salt.toHex());
     query.addBindValue(salted_password);
@@ -233,17 +316,15 @@ bool DBManager::createUser(QString f_username, QByteArray f_salt, QString f_pass
 
 bool DBManager::deleteUser(QString username)
 {
-    QSqlQuery username_exists;
-    username_exists.prepare("SELECT ACL FROM users WHERE USERNAME = ?");
+    QSqlQuery &username_exists = statement("SELECT ACL FROM users WHERE USERNAME = ?");
     username_exists.addBindValue(username);
     username_exists.exec();
-    if (username_exists.first())
+    if (!username_exists.first())
         return false;
 
-    QSqlQuery query;
-    query.prepare("DELETE FROM users WHERE USERNAME = ?");
-    username_exists.addBindValue(username);
-    username_exists.exec();
+    QSqlQuery &query = statement("DELETE FROM users WHERE USERNAME = ?");
+    query.addBindValue(username);
+    query.exec();
     return true;
 }
 
@@ -252,7 +333,7 @@ QString DBManager::getACL(QString moderator_name)
     if (moderator_name == "")
         return 0;
 
-    QSqlQuery query("SELECT ACL FROM users WHERE USERNAME = ?");
+    QSqlQuery &query = statement("SELECT ACL FROM users WHERE USERNAME = ?");
     query.addBindValue(moderator_name);
     query.exec();
     if (!query.first())
@@ -261,41 +342,31 @@ QString DBManager::getACL(QString moderator_name)
     return query.value(0).toString();
 }
 
-bool DBManager::authenticate(QString username, QString password)
+DBManager::Credentials DBManager::getCredentials(QString username)
 {
-    QSqlQuery query_salt("SELECT SALT FROM users WHERE USERNAME = ?");
-    query_salt.addBindValue(username);
-    query_salt.exec();
-    if (!query_salt.first())
-        return false;
-
-    QString salt = query_salt.value(0).toString();
-    QString salted_password = CryptoHelper::hash_password(QByteArray::fromHex(salt.toUtf8()), password);
-    QSqlQuery query_pass("SELECT PASSWORD FROM users WHERE USERNAME = ?");
-    query_pass.addBindValue(username);
-    query_pass.exec();
-    if (!query_pass.first())
-        return false;
-
-    QString stored_pass = query_pass.value(0).toString();
-    // Update old-style hashes to new ones on the fly
-    if (QByteArray::fromHex(salt.toUtf8()).length() < CryptoHelper::pbkdf2_salt_len && salted_password == stored_pass)
-        updatePassword(username, password);
+    Credentials credentials;
+    QSqlQuery &query = statement("SELECT SALT, PASSWORD, ACL FROM users WHERE USERNAME = ?");
+    query.addBindValue(username);
+    query.exec();
+    if (!query.first())
+        return credentials;
 
-    return salted_password == stored_pass;
+    credentials.exists = true;
+    credentials.salt = QByteArray::fromHex(query.value(0).toString().toUtf8());
+    credentials.password = query.value(1).toString();
+    credentials.acl = query.value(2).toString();
+    return credentials;
 }
 
 bool DBManager::updateACL(QString f_username, QString f_acl)
 {
-    QSqlQuery l_username_exists;
-    l_username_exists.prepare("SELECT ACL FROM users WHERE USERNAME = ?");
+    QSqlQuery &l_username_exists = statement("SELECT ACL FROM users WHERE USERNAME = ?");
     l_username_exists.addBindValue(f_username);
     l_username_exists.exec();
     if (!l_username_exists.first())
         return false;
 
-    QSqlQuery l_update_acl;
-    l_update_acl.prepare("UPDATE users SET ACL = ? WHERE USERNAME = ?");
+    QSqlQuery &l_update_acl = statement("UPDATE users SET ACL = ? WHERE USERNAME = ?");
     l_update_acl.addBindValue(f_acl);
     l_update_acl.addBindValue(f_username);
     l_update_acl.exec();
@@ -305,7 +376,8 @@ bool DBManager::updateACL(QString f_username, QString f_acl)
 QStringList DBManager::getUsers()
 {
     QStringList users;
-    QSqlQuery query("SELECT USERNAME FROM users ORDER BY ID");
+    QSqlQuery &query = statement("SELECT USERNAME FROM users ORDER BY ID");
+    query.exec();
     while (query.next())
         users.append(query.value(0).toString());
 
@@ -314,21 +386,21 @@ QStringList DBManager::getUsers()
 
 QList<DBManager::BanInfo> DBManager::getBanInfo(QString lookup_type, QString id)
 {
-    QSqlQuery query;
+    QString l_sql;
     QList<BanInfo> invalid;
     if (lookup_type == "banid")
-        query.prepare("SELECT * FROM BANS WHERE ID = ?");
+        l_sql = "SELECT * FROM BANS WHERE ID = ?";
     else if (lookup_type == "hdid")
-        query.prepare("SELECT * FROM BANS WHERE HDID = ?");
+        l_sql = "SELECT * FROM BANS WHERE HDID = ?";
     else if (lookup_type == "ipid")
-        query.prepare("SELECT * FROM BANS WHERE IPID = ?");
+        l_sql = "SELECT * FROM BANS WHERE IPID = ?";
     else {
         qCritical("Invalid ban lookup type!");
         return invalid;
     }
 
+    QSqlQuery &query = statement(l_sql);
     query.addBindValue(id);
-    query.setForwardOnly(true);
     query.exec();
     QList<BanInfo> return_list;
     while (query.next()) {
@@ -348,211 +420,118 @@ QList<DBManager::BanInfo> DBManager::getBanInfo(QString lookup_type, QString id)
     return return_list;
 }
 
-int DBManager::getHazNum(QString ipid)
+QList<DBManager::automod> DBManager::getHazNums()
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM AUTOMOD WHERE IPID = ?");
-    query.addBindValue(ipid);
-    query.setForwardOnly(true);
+    QList<automod> return_list;
+    QSqlQuery &query = statement("SELECT IPID, DATE, ACTION, HAZNUM FROM automod ORDER BY ID DESC");
     query.exec();
     while (query.next()) {
         automod num;
-        return query.value(4).toInt();
+        num.ipid = query.value(0).toString();
+        num.date = static_cast<unsigned long>(query.value(1).toULongLong());
+        num.action = query.value(2).toString();
+        num.haznum = query.value(3).toInt();
+        return_list.append(num);
     }
 
-    return 0;
-}
-
-long DBManager::getHazNumDate(QString ipid)
-{
-    QSqlQuery query;
-    query.prepare("SELECT * FROM AUTOMOD WHERE IPID = ?");
-    query.addBindValue(ipid);
-    query.setForwardOnly(true);
-    query.exec();
-    while (query.next()) {
-        automod num;
-        return query.value(2).toLongLong();
-    }
-
-    return 0;
+    return return_list;
 }
 
-void DBManager::addHazNum(automod num)
+void DBManager::storeHazNum(automod num)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO AUTOMOD(IPID, DATE, ACTION, HAZNUM) VALUES(?, ?, ?, ?)");
-    query.addBindValue(num.ipid);
+    QSqlQuery &query = statement("UPDATE automod SET DATE = ?, ACTION = ?, HAZNUM = ? WHERE IPID = ?");
     query.addBindValue(QString::number(num.date));
     query.addBindValue(num.action);
     query.addBindValue(num.haznum);
-
-    if (!query.exec())
-        qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-void DBManager::updateHazNum(QString ipid, long date)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE automod SET DATE = ? WHERE IPID = ?");
-    query.addBindValue(QString::number(date));
-    query.addBindValue(ipid);
-
-    if (!query.exec())
-        qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-void DBManager::updateHazNum(QString ipid, int haznum)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE automod SET HAZNUM = ? WHERE IPID = ?");
-    query.addBindValue(haznum);
-    query.addBindValue(ipid);
-
-    if (!query.exec())
-        qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-void DBManager::updateHazNum(QString ipid, QString action)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE automod SET ACTION = ? WHERE IPID = ?");
-    query.addBindValue(action);
-    query.addBindValue(ipid);
-
-    if (!query.exec())
+    query.addBindValue(num.ipid);
+    if (!query.exec()) {
         qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-bool DBManager::hazNumExist(QString ipid)
-{
-    QSqlQuery query;
-    query.prepare("SELECT * FROM automod WHERE IPID = ?");
-    query.addBindValue(ipid);
-    query.setForwardOnly(true);
-    query.exec();
-
-    while (query.next()) {
-        automodwarns warn;
-        warn.ipid = query.value(1).toString();
-        if (!warn.ipid.isEmpty())
-            return true;
+        return;
     }
 
-    return false;
-}
-
-int DBManager::getWarnNum(QString ipid)
-{
-    QSqlQuery query;
-    query.prepare("SELECT * FROM AUTOMODWARNS WHERE IPID = ?");
-    query.addBindValue(ipid);
-    query.setForwardOnly(true);
-    query.exec();
-
-    while (query.next()) {
-        automodwarns warn;
-        return query.value(3).toInt();
-    }
+    if (query.numRowsAffected() > 0)
+        return;
 
-    return 0;
+    QSqlQuery &insert = statement("INSERT INTO AUTOMOD(IPID, DATE, ACTION, HAZNUM) VALUES(?, ?, ?, ?)");
+    insert.addBindValue(num.ipid);
+    insert.addBindValue(QString::number(num.date));
+    insert.addBindValue(num.action);
+    insert.addBindValue(num.haznum);
+    if (!insert.exec())
+        qDebug() << "SQL Error:" << insert.lastError().text();
 }
 
-long DBManager::getWarnDate(QString ipid)
+QList<DBManager::automodwarns> DBManager::getWarns()
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM AUTOMODWARNS WHERE IPID = ?");
-    query.addBindValue(ipid);
-    query.setForwardOnly(true);
+    QList<automodwarns> return_list;
+    QSqlQuery &query = statement("SELECT IPID, DATE, WARNS FROM automodwarns ORDER BY ID DESC");
     query.exec();
-
     while (query.next()) {
         automodwarns warn;
-        return query.value(2).toLongLong();
+        warn.ipid = query.value(0).toString();
+        warn.date = static_cast<unsigned long>(query.value(1).toULongLong());
+        warn.warns = query.value(2).toInt();
+        return_list.append(warn);
     }
 
-    return 0;
+    return return_list;
 }
 
-void DBManager::addWarn(automodwarns warn)
+void DBManager::storeWarn(automodwarns warn)
 {
-    QSqlQuery query;
-    query.prepare("INSERT INTO AUTOMODWARNS(IPID, DATE, WARNS) VALUES(?, ?, ?)");
-    query.addBindValue(warn.ipid);
+    QSqlQuery &query = statement("UPDATE automodwarns SET DATE = ?, WARNS = ? WHERE IPID = ?");
     query.addBindValue(QString::number(warn.date));
     query.addBindValue(warn.warns);
-
-    if (!query.exec())
-        qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-void DBManager::updateWarn(QString ipid, int warns)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE automodwarns SET WARNS = ? WHERE IPID = ?");
-    query.addBindValue(warns);
-    query.addBindValue(ipid);
-
-    if (!query.exec())
-        qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-void DBManager::updateWarn(QString ipid, long date)
-{
-    QSqlQuery query;
-    query.prepare("UPDATE automodwarns SET DATE = ? WHERE IPID = ?");
-    query.addBindValue(QString::number(date));
-    query.addBindValue(ipid);
-
-    if (!query.exec())
+    query.addBindValue(warn.ipid);
+    if (!query.exec()) {
         qDebug() << "SQL Error:" << query.lastError().text();
-}
-
-bool DBManager::warnExist(QString ipid)
-{
-    QSqlQuery query;
-    query.prepare("SELECT * FROM automodwarns WHERE IPID = ?");
-    query.addBindValue(ipid);
-    query.setForwardOnly(true);
-    query.exec();
-
-    while (query.next()) {
-        automodwarns warn;
-        warn.ipid = query.value(1).toString();
-        if (!warn.ipid.isEmpty())
-            return true;
+        return;
     }
 
-    return false;
+    if (query.numRowsAffected() > 0)
+        return;
+
+    QSqlQuery &insert = statement("INSERT INTO AUTOMODWARNS(IPID, DATE, WARNS) VALUES(?, ?, ?)");
+    insert.addBindValue(warn.ipid);
+    insert.addBindValue(QString::number(warn.date));
+    insert.addBindValue(warn.warns);
+    if (!insert.exec())
+        qDebug() << "SQL Error:" << insert.lastError().text();
 }
 
 bool DBManager::updateBan(int ban_id, QString field, QVariant updated_info)
 {
-    QSqlQuery query;
+    QSqlQuery *query = nullptr;
     if (field == "reason") {
-        query.prepare("UPDATE bans SET REASON = ? WHERE ID = ?");
-        query.addBindValue(updated_info.toString());
+        query = &statement("UPDATE bans SET REASON = ? WHERE ID = ?");
+        query->addBindValue(updated_info.toString());
     }
     else if (field == "duration") {
-        query.prepare("UPDATE bans SET DURATION = ? WHERE ID = ?");
-        query.addBindValue(updated_info.toLongLong());
+        query = &statement("UPDATE bans SET DURATION = ? WHERE ID = ?");
+        query->addBindValue(updated_info.toLongLong());
     }
+    else
+        return false;
 
-    query.addBindValue(ban_id);
-    if (!query.exec()) {
-        qDebug() << query.lastError();
+    query->addBindValue(ban_id);
+    if (!query->exec()) {
+        qDebug() << query->lastError();
         return false;
     }
-    else
-        return true;
+
+    publishBan(ban_id);
+    return true;
 }
 
 bool DBManager::updatePassword(QString username, QString password)
 {
     QByteArray salt = CryptoHelper::randbytes(16);
-    QString salted_password = CryptoHelper::hash_password(salt, password);
-    QSqlQuery query;
-    query.prepare("UPDATE users SET PASSWORD = ?, SALT = ? WHERE USERNAME = ?");
+    return updatePassword(username, salt, CryptoHelper::hash_password(salt, password));
+}
+
+bool DBManager::updatePassword(QString username, QByteArray salt, QString salted_password)
+{
+    QSqlQuery &query = statement("UPDATE users SET PASSWORD = ?, SALT = ? WHERE USERNAME = ?");
     query.addBindValue(salted_password);
     query.addBindValue(salt.toHex());
     query.addBindValue(username);
@@ -563,7 +542,7 @@ bool DBManager::updatePassword(QString username, QString password)
 
 int DBManager::checkVersion()
 {
-    QSqlQuery query;
+    QSqlQuery query(db);
     query.prepare("PRAGMA user_version");
     query.exec();
 
@@ -577,25 +556,32 @@ void DBManager::updateDB(int current_version)
 {
     switch (current_version) {
     case 0:
-        QSqlQuery("ALTER TABLE bans ADD COLUMN MODERATOR TEXT");
+        QSqlQuery("ALTER TABLE bans ADD COLUMN MODERATOR TEXT", db);
         Q_FALLTHROUGH();
     case 1:
-        QSqlQuery("PRAGMA user_version = " + QString::number(1));
+        QSqlQuery("UPDATE users SET ACL = 'SUPER' WHERE USERNAME = 'root'", db);
+        QSqlQuery("PRAGMA user_version = " + QString::number(2), db);
         Q_FALLTHROUGH();
     case 2:
-        QSqlQuery("UPDATE users SET ACL = 'SUPER' WHERE USERNAME = 'root'");
-        QSqlQuery("PRAGMA user_version = " + QString::number(DB_VERSION));
+        // Every lookup filters on IPID, HDID, IP or USERNAME, and the ban lookups sort by TIME.
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_ipid ON bans (IPID, TIME)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_hdid ON bans (HDID, TIME)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_ip ON bans (IP, TIME)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS bans_time ON bans (TIME)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS ipidip_ipid ON ipidip (IPID)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS automod_ipid ON automod (IPID)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS automodwarns_ipid ON automodwarns (IPID)", db);
+        QSqlQuery("CREATE INDEX IF NOT EXISTS users_username ON users (USERNAME)", db);
+        QSqlQuery("ANALYZE", db);
+        QSqlQuery("PRAGMA user_version = " + QString::number(DB_VERSION), db);
         break;
     }
 }
 
 bool DBManager::ipidExist(QString ipid)
 {
-    QSqlQuery query;
-
-    query.prepare("SELECT * FROM IPIDIP WHERE IPID = ?");
+    QSqlQuery &query = statement("SELECT * FROM IPIDIP WHERE IPID = ?");
     query.addBindValue(ipid);
-    query.setForwardOnly(true);
     query.exec();
 
     while (query.next()) {
@@ -614,29 +600,27 @@ bool DBManager::ipidExist(QString ipid)
 void DBManager::ipidip(QString ipid, QString ip, QString date, QString hwid)
 {
     if (ipidExist(ipid)) {
-        QSqlQuery query;
+        QSqlQuery query(db);
         query.prepare("SELECT * FROM IPIDIP WHERE IPID = ?");
         query.addBindValue(ipid);
-        query.setForwardOnly(true);
         query.exec();
         while (query.next()) {
             idipinfo ipidip;
             ipidip.hwid = query.value(4).toString();
             if (!hwid.isEmpty() && hwid != ipidip.hwid) {
-                query.clear();
-                query.prepare("UPDATE ipidip SET HWID = ? WHERE IPID = ?");
-                query.addBindValue(hwid);
-                query.addBindValue(ipid);
-                if (!query.exec())
-                    qDebug() << "SQL Error: " << query.lastError().text();
+                QSqlQuery &update = statement("UPDATE ipidip SET HWID = ? WHERE IPID = ?");
+                update.addBindValue(hwid);
+                update.addBindValue(ipid);
+                if (!update.exec())
+                    qDebug() << "SQL Error: " << update.lastError().text();
+                break;
             }
         }
 
         return;
     }
 
-    QSqlQuery query;
-    query.prepare("INSERT INTO IPIDIP(IPID, IP, CREATED, HWID) VALUES(?, ?, ?, ?)");
+    QSqlQuery &query = statement("INSERT INTO IPIDIP(IPID, IP, CREATED, HWID) VALUES(?, ?, ?, ?)");
     query.addBindValue(ipid);
     query.addBindValue(ip);
     query.addBindValue(date);
@@ -648,10 +632,8 @@ void DBManager::ipidip(QString ipid, QString ip, QString date, QString hwid)
 
 QList<DBManager::idipinfo> DBManager::getIpidInfo(QString ipid)
 {
-    QSqlQuery query;
-    query.prepare("SELECT * FROM IPIDIP WHERE IPID = ?");
+    QSqlQuery &query = statement("SELECT * FROM IPIDIP WHERE IPID = ?");
     query.addBindValue(ipid);
-    query.setForwardOnly(true);
     query.exec();
 
     QList<idipinfo> return_list;
@@ -668,4 +650,19 @@ QList<DBManager::idipinfo> DBManager::getIpidInfo(QString ipid)
     return return_list;
 }
 
-DBManager::~DBManager() { db.close(); }
+DBManager::~DBManager()
+{
+    QMetaObject::invokeMethod(
+        m_worker, [this] {
+            commitWrites();
+            delete m_commit_timer;
+            m_statements.clear();
+            db.close();
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(CONN_NAME);
+        },
+        Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_worker;
+}
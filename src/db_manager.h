@@ -18,15 +18,21 @@
 #ifndef BAN_MANAGER_H
 #define BAN_MANAGER_H
 
-#define DB_VERSION 2
+#define DB_VERSION 3
 
 #include <QDateTime>
 #include <QFileInfo>
 #include <QHostAddress>
+#include <QMap>
+#include <QPointer>
 #include <QSqlDatabase>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QThread>
+#include <QTimer>
+
+#include <functional>
 
 #include "acl_roles_handler.h"
 #include "crypto_helper.h"
@@ -40,6 +46,9 @@
  * The DBManager handles user data, keeping track of only 'special' persons who are handled
  * differently than the average user.
  * This comes in two forms, when the user's client is banned, and when the user is a moderator.
+ *
+ * All queries run on a dedicated database thread which owns its own connection. The query methods below
+ * must therefore only be called from inside a job handed to query(), execute() or wait().
  */
 class DBManager : public QObject
 {
@@ -55,10 +64,86 @@ class DBManager : public QObject
     DBManager();
 
     /**
-     * @brief Destructor for the DBManager class. Closes the underlying database.
+     * @brief Destructor for the DBManager class. Commits pending writes, closes the underlying database
+     * and stops the database thread.
      */
     ~DBManager();
 
+    /**
+     * @brief Runs a job on the database thread and hands its result to a callback on the owning thread.
+     *
+     * @details Pending writes are committed before the job runs, so it always observes them.
+     * The callback is dropped if the context object has been destroyed by the time the result arrives.
+     *
+     * @param f_context The object the callback belongs to.
+     * @param f_job A callable taking a DBManager pointer. Runs on the database thread.
+     * @param f_callback A callable taking the job's result. Runs on the thread owning the DBManager.
+     */
+    template <typename Job, typename Callback>
+    void query(QObject *f_context, Job f_job, Callback f_callback)
+    {
+        QPointer<QObject> l_context(f_context);
+        QMetaObject::invokeMethod(
+            m_worker, [this, l_context, f_job, f_callback] {
+                commitWrites();
+                auto l_result = f_job(this);
+                releaseStatements();
+                QMetaObject::invokeMethod(
+                    this, [l_context, f_callback, l_result] {
+                        if (!l_context.isNull())
+                            f_callback(l_result);
+                    },
+                    Qt::QueuedConnection);
+            },
+            Qt::QueuedConnection);
+    }
+
+    /**
+     * @brief Queues a write job on the database thread without waiting for it.
+     *
+     * @details Writes are collected and committed together in a single transaction, either after
+     * #WRITE_BATCH_INTERVAL milliseconds or once #WRITE_BATCH_SIZE of them are pending.
+     *
+     * @param f_job A callable taking a DBManager pointer. Runs on the database thread.
+     */
+    template <typename Job>
+    void execute(Job f_job)
+    {
+        QMetaObject::invokeMethod(
+            m_worker, [this, f_job] {
+                m_pending_writes.append([this, f_job] { f_job(this); });
+                if (m_pending_writes.size() >= WRITE_BATCH_SIZE)
+                    commitWrites();
+                else if (!m_commit_timer->isActive())
+                    m_commit_timer->start();
+            },
+            Qt::QueuedConnection);
+    }
+
+    /**
+     * @brief Runs a job on the database thread and blocks until it has finished.
+     *
+     * @details Reserved for infrequent moderator and account commands whose reply depends on the result.
+     * Anything on the connection or chat path should use query() or execute() instead.
+     *
+     * @param f_job A callable taking a DBManager pointer. Runs on the database thread.
+     *
+     * @return The result of the job.
+     */
+    template <typename Job>
+    auto wait(Job f_job) -> decltype(f_job(this))
+    {
+        decltype(f_job(this)) l_result;
+        QMetaObject::invokeMethod(
+            m_worker, [this, &f_job, &l_result] {
+                commitWrites();
+                l_result = f_job(this);
+                releaseStatements();
+            },
+            Qt::BlockingQueuedConnection);
+        return l_result;
+    }
+
     /**
      * @brief Details about a ban.
      */
@@ -118,6 +203,11 @@ class DBManager : public QObject
      */
     QList<BanInfo> getRecentBans();
 
+    /**
+     * @brief Gets every ban that is permanent or has not expired yet.
+     */
+    QList<BanInfo> getActiveBans();
+
     /**
      * @brief Registers a ban into the database.
      *
@@ -170,15 +260,25 @@ class DBManager : public QObject
     QString getACL(QString f_username);
 
     /**
-     * @brief Authenticates a given user.
+     * @brief The stored login details of a user.
+     */
+    struct Credentials
+    {
+        bool exists = false; //!< False if there is no user with the given name.
+        QByteArray salt;     //!< The salt the password was hashed with.
+        QString password;    //!< The salted password hash, hex encoded.
+        QString acl;         //!< The user's ACL role identifier.
+    };
+
+    /**
+     * @brief Looks up what is needed to authenticate a given user.
      *
-     * @param username The username of the user trying to log in.
-     * @param password The password of the user.
+     * @details Only reads the record. The password itself is checked by the caller with CryptoHelper::verify_password(),
+     * so the expensive hashing does not occupy the database thread.
      *
-     * @return True if the salted version of the inputted password matches the one stored in the user's record,
-     * false if the user does not exist in the records, of if the passwords don't match.
+     * @param username The username of the user trying to log in.
      */
-    bool authenticate(QString username, QString password);
+    Credentials getCredentials(QString username);
 
     /**
      * @brief Updates the ACL role identifier of a given user.
@@ -230,63 +330,28 @@ class DBManager : public QObject
     };
 
     /**
-     * @brief Returns the hazard level of the user.
-     */
-    int getHazNum(QString ipid);
-
-    /**
-     * @brief Returns the date when the punishment was last received.
-     */
-    long getHazNumDate(QString ipid);
-
-    /**
-     * @brief Registers a punishment from the automoderator into the database.
-     */
-    void addHazNum(automod num);
-
-    /**
-     * @brief Updates a punishment from the automoderator.
-     */
-    void updateHazNum(QString ipid, long date);
-
-    /**
-     * @overload
-     */
-    void updateHazNum(QString ipid, int haznum);
-
-    /**
-     * @overload
-     */
-    void updateHazNum(QString ipid, QString action);
-
-    bool hazNumExist(QString ipid);
-
-    /**
-     * @brief Returns the user's number of warns.
-     */
-    int getWarnNum(QString ipid);
-
-    /**
-     * @brief Returns the date when the last warn was received.
+     * @brief Returns every hazard record of the automoderator.
+     *
+     * @details If an IPID has more than one row, the oldest one comes last.
      */
-    long getWarnDate(QString ipid);
+    QList<automod> getHazNums();
 
     /**
-     * @brief Registers get warn into the database.
+     * @brief Writes the hazard record of an IPID, creating it if it does not exist yet.
      */
-    void addWarn(automodwarns warn);
+    void storeHazNum(automod num);
 
     /**
-     * @brief Updates info of warns.
+     * @brief Returns every warn record of the automoderator.
+     *
+     * @details If an IPID has more than one row, the oldest one comes last.
      */
-    void updateWarn(QString ipid, int warns);
+    QList<automodwarns> getWarns();
 
     /**
-     * @overload
+     * @brief Writes the warn record of an IPID, creating it if it does not exist yet.
      */
-    void updateWarn(QString ipid, long date);
-
-    bool warnExist(QString ipid);
+    void storeWarn(automodwarns warn);
 
     /**
      * @brief Updates a ban.
@@ -312,6 +377,21 @@ class DBManager : public QObject
      */
     bool updatePassword(QString username, QString password);
 
+    /**
+     * @brief Updates the password of the given user to an already hashed one.
+     *
+     * @details Lets callers derive the hash off the database thread, see CryptoHelper::hash_password().
+     *
+     * @param username The username to change.
+     *
+     * @param salt The salt the password was hashed with.
+     *
+     * @param salted_password The hashed new password.
+     *
+     * @return True if the password change was successful.
+     */
+    bool updatePassword(QString username, QByteArray salt, QString salted_password);
+
     /**
      * @brief Details about user's IPID.
      */
@@ -338,22 +418,98 @@ class DBManager : public QObject
      */
     bool ipidExist(QString ipid);
 
+  signals:
+    /**
+     * @brief Emitted from the database thread after a ban was added, lifted or edited.
+     *
+     * @param f_ban The ban as it is now stored. Lifted bans have a duration of 0.
+     */
+    void banChanged(DBManager::BanInfo f_ban);
+
   private:
+    /**
+     * @brief The maximum number of writes collected before they are committed.
+     */
+    static constexpr int WRITE_BATCH_SIZE = 64;
+
+    /**
+     * @brief The maximum time, in milliseconds, a write waits before it is committed.
+     */
+    static constexpr int WRITE_BATCH_INTERVAL = 100;
+
+    /**
+     * @brief The size of SQLite's page cache, in KiB.
+     */
+    static constexpr int CACHE_SIZE = 16384;
+
     /**
      * @brief The name of the database connection driver.
      */
     const QString DRIVER;
 
     /**
-     * @note Unused.
+     * @brief The name of the connection owned by the database thread.
      */
     const QString CONN_NAME;
 
     /**
-     * @note Unused.
+     * @brief Opens the database and creates or updates its tables. Runs on the database thread.
      */
     void openDB();
 
+    /**
+     * @brief Commits all pending writes in a single transaction. Runs on the database thread.
+     */
+    void commitWrites();
+
+    /**
+     * @brief Reads the ban with the given ID back from the table and emits banChanged() with it.
+     */
+    void publishBan(int f_id);
+
+    /**
+     * @brief Returns the cached prepared query for the given SQL, preparing it on first use.
+     *
+     * @details Bound values are reset by every exec(), so the query can be rebound and executed again.
+     * The reference stays valid until the database is closed.
+     *
+     * @param f_sql The statement to prepare.
+     *
+     * @return A forward-only query prepared on #db.
+     */
+    QSqlQuery &statement(const QString &f_sql);
+
+    /**
+     * @brief Finishes every active cached query, so none of them holds a read transaction open
+     * between jobs.
+     */
+    void releaseStatements();
+
+    /**
+     * @brief The thread all queries run on.
+     */
+    QThread *m_thread;
+
+    /**
+     * @brief An object living on #m_thread, used as the target for queued jobs.
+     */
+    QObject *m_worker;
+
+    /**
+     * @brief Commits pending writes after #WRITE_BATCH_INTERVAL milliseconds. Lives on #m_thread.
+     */
+    QTimer *m_commit_timer = nullptr;
+
+    /**
+     * @brief Writes waiting for the next commit. Only touched on #m_thread.
+     */
+    QList<std::function<void()>> m_pending_writes;
+
+    /**
+     * @brief Prepared queries keyed by their SQL. A QMap, so references to its values survive later inserts.
+     */
+    QMap<QString, QSqlQuery> m_statements;
+
     /**
      * @brief The backing database that stores user details.
      */
@@ -18,151 +18,240 @@
 #include "discord.h"
 #include "config_manager.h"
 
-Discord::Discord(QObject *parent) :
-    QObject(parent)
-{
+#include <QtConcurrent/QtConcurrent>
 
-    m_nam = new QNetworkAccessManager();
-    connect(m_nam, &QNetworkAccessManager::finished,
-            this, &Discord::onReplyFinished);
+Discord::Discord(HttpService *f_http, QObject *parent) :
+    QObject(parent),
+    m_http(f_http)
+{
+    m_send_timer = new QTimer(this);
+    m_send_timer->setSingleShot(true);
+    connect(m_send_timer, &QTimer::timeout,
+            this, &Discord::sendNext);
 
     m_uptimePostTimer = new QTimer;
     connect(m_uptimePostTimer, &QTimer::timeout,
             this, &Discord::onUptimeWebhookRequested);
 }
 
-void Discord::onModcallWebhookRequested(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason, const QQueue<QString> &f_buffer)
+void Discord::onModcallWebhookRequested(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason, const LogRingBuffer::Snapshot &f_buffer)
 {
-    m_request.setUrl(QUrl(ConfigManager::discordModcallWebhookUrl()));
-    QJsonDocument l_json = constructModcallJson(f_name, f_hub, f_area, f_reason);
-    postJsonWebhook(l_json);
+    const QUrl l_url(ConfigManager::discordModcallWebhookUrl());
+    const QString l_content = ConfigManager::discordModcallWebhookContent();
+    const QJsonObject l_embed = constructModcallEmbed(f_name, f_hub, f_area, f_reason);
 
-    if (ConfigManager::discordModcallWebhookSendFile()) {
-        QHttpMultiPart *l_multipart = constructLogMultipart(f_buffer);
-        postMultipartWebhook(*l_multipart);
+    if (!ConfigManager::discordModcallWebhookSendFile()) {
+        enqueue(l_url, l_content, l_embed);
+        return;
     }
+
+    QFutureWatcher<QByteArray> *l_watcher = new QFutureWatcher<QByteArray>(this);
+    connect(l_watcher, &QFutureWatcher<QByteArray>::finished, this, [this, l_watcher, l_url, l_content, l_embed]() {
+        enqueue(l_url, l_content, l_embed, l_watcher->result());
+        l_watcher->deleteLater();
+    });
+    l_watcher->setFuture(QtConcurrent::run([f_buffer]() { return f_buffer.join("\n").toUtf8(); }));
 }
 
 void Discord::onBanWebhookRequested(const QString &f_ipid, const QString &f_moderator, const QString &f_duration, const QString &f_reason, const int &f_banID)
 {
-    m_request.setUrl(QUrl(ConfigManager::discordBanWebhookUrl()));
-
-    QJsonDocument l_json = constructBanJson(f_ipid, f_moderator, f_duration, f_reason, f_banID);
-    postJsonWebhook(l_json);
+    enqueue(QUrl(ConfigManager::discordBanWebhookUrl()), QString(), constructBanEmbed(f_ipid, f_moderator, f_duration, f_reason, f_banID));
 }
 
 void Discord::onUptimeWebhookRequested()
 {
-    m_request.setUrl(QUrl(ConfigManager::discordUptimeWebhookUrl()));
-
     qint64 l_expiredTimeSeconds = ConfigManager::uptime() / 1000;
     int minutes = (l_expiredTimeSeconds / 60) % 60;
     int hours = (l_expiredTimeSeconds / (60 * 60)) % 24;
     int days = (l_expiredTimeSeconds / (60 * 60 * 24)) % 365;
     QString f_timeExpired = QString::number(days) + " days, " + QString::number(hours) + " hours and " + QString::number(minutes) + " minutes.";
-    QJsonDocument l_json = constructUptimeJson(f_timeExpired);
-    postJsonWebhook(l_json);
+    enqueue(QUrl(ConfigManager::discordUptimeWebhookUrl()), QString(), constructUptimeEmbed(f_timeExpired));
 }
 
-QJsonDocument Discord::constructModcallJson(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason) const
+QJsonObject Discord::constructModcallEmbed(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason) const
 {
-    QJsonArray l_array;
-    QJsonObject l_object{
+    return QJsonObject{
         {"color", ConfigManager::discordWebhookColor()},
         {"title", f_name + " filed a modcall in " + f_area + " [Hub: " + f_hub + "]"},
         {"description", f_reason}};
-    l_array.append(l_object);
-
-    QJsonObject l_json;
-    if (!ConfigManager::discordModcallWebhookContent().isEmpty())
-        l_json["content"] = ConfigManager::discordModcallWebhookContent();
-    l_json["embeds"] = l_array;
-    return QJsonDocument(l_json);
 }
 
-QJsonDocument Discord::constructBanJson(const QString &f_ipid, const QString &f_moderator, const QString &f_duration, const QString &f_reason, const int &f_banID)
+QJsonObject Discord::constructBanEmbed(const QString &f_ipid, const QString &f_moderator, const QString &f_duration, const QString &f_reason, const int &f_banID) const
 {
-    QJsonArray l_array;
-    QJsonObject l_object{
+    return QJsonObject{
         {"color", ConfigManager::discordWebhookColor()},
         {"title", "Ban issued by " + f_moderator},
         {"description", "Client IPID : " + f_ipid + "\nBan ID: " + QString::number(f_banID) + "\nBan reason : " + f_reason + "\nBanned until : " + f_duration}};
-    l_array.append(l_object);
-
-    QJsonObject l_json;
-    l_json["embeds"] = l_array;
-    return QJsonDocument(l_json);
 }
 
-QJsonDocument Discord::constructUptimeJson(const QString &f_timeExpired)
+QJsonObject Discord::constructUptimeEmbed(const QString &f_timeExpired) const
 {
-    QJsonArray l_array;
-    QJsonObject l_object{
+    return QJsonObject{
         {"color", ConfigManager::discordWebhookColor()},
         {"title", "Your server is online!"},
         {"description", "Your server has been online for " + f_timeExpired}};
-    l_array.append(l_object);
+}
 
+QJsonDocument Discord::constructPayloadJson(const Delivery &f_delivery) const
+{
     QJsonObject l_json;
-    l_json["embeds"] = l_array;
+    if (!f_delivery.content.isEmpty())
+        l_json["content"] = f_delivery.content;
+    l_json["embeds"] = f_delivery.embeds;
     return QJsonDocument(l_json);
 }
 
-QHttpMultiPart *Discord::constructLogMultipart(const QQueue<QString> &f_buffer) const
+QHttpMultiPart *Discord::constructMultipart(const Delivery &f_delivery) const
 {
-    QHttpPart l_file;
-    l_file.setRawHeader(QByteArray("Content-Disposition"), QByteArray("form-data; name=\"file\"; filename=\"log.txt\""));
-    l_file.setRawHeader(QByteArray("Content-Type"), QByteArray("plain/text"));
+    QHttpPart l_payload;
+    l_payload.setRawHeader(QByteArray("Content-Disposition"), QByteArray("form-data; name=\"payload_json\""));
+    l_payload.setRawHeader(QByteArray("Content-Type"), QByteArray("application/json"));
+    l_payload.setBody(constructPayloadJson(f_delivery).toJson(QJsonDocument::Compact));
 
-    QString l_log;
-    for (const QString &log_entry : f_buffer)
-        l_log.append(log_entry + "\n");
-
-    l_file.setBody(l_log.toUtf8());
+    QHttpPart l_file;
+    l_file.setRawHeader(QByteArray("Content-Disposition"), QByteArray("form-data; name=\"files[0]\"; filename=\"log.txt\""));
+    l_file.setRawHeader(QByteArray("Content-Type"), QByteArray("text/plain"));
+    l_file.setBody(f_delivery.attachment);
 
-    QHttpMultiPart *l_multipart = new QHttpMultiPart();
+    QHttpMultiPart *l_multipart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    l_multipart->append(l_payload);
     l_multipart->append(l_file);
     return l_multipart;
 }
 
-void Discord::postJsonWebhook(const QJsonDocument &f_json)
+void Discord::enqueue(const QUrl &f_url, const QString &f_content, const QJsonObject &f_embed, const QByteArray &f_attachment)
 {
-    if (!QUrl(m_request.url()).isValid()) {
+    if (!f_url.isValid()) {
         qWarning("Invalid webhook URL!");
         return;
     }
 
-    m_request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    m_nam->post(m_request, f_json.toJson());
+    // Modcall reasons are not length limited, and a single overlong embed would get the message rejected.
+    QJsonObject l_embed = f_embed;
+    const QString l_title = l_embed.value("title").toString().left(MAX_EMBED_TITLE);
+    const QString l_description = l_embed.value("description").toString().left(MAX_EMBED_DESCRIPTION);
+    l_embed["title"] = l_title;
+    l_embed["description"] = l_description;
+    const int l_embed_text = l_title.size() + l_description.size();
+
+    // The first message is off limits while it is on the wire.
+    const int l_first_open = m_in_flight ? 1 : 0;
+    if (f_attachment.isEmpty() && m_queue.size() > l_first_open) {
+        Delivery &l_last = m_queue.last();
+        if (l_last.url == f_url && l_last.content == f_content && l_last.attachment.isEmpty() && l_last.embeds.size() < MAX_EMBEDS &&
+            l_last.embed_text + l_embed_text <= MAX_EMBED_TEXT) {
+            l_last.embeds.append(l_embed);
+            l_last.embed_text += l_embed_text;
+            return;
+        }
+    }
+
+    Delivery l_delivery;
+    l_delivery.url = f_url;
+    l_delivery.content = f_content;
+    l_delivery.embeds.append(l_embed);
+    l_delivery.embed_text = l_embed_text;
+    l_delivery.attachment = f_attachment;
+    m_queue.enqueue(l_delivery);
+
+    while (m_queue.size() > MAX_QUEUED) {
+        qWarning("Discord webhook queue is full, dropping the oldest message.");
+        m_queue.removeAt(l_first_open);
+    }
+
+    if (!m_in_flight && !m_send_timer->isActive())
+        m_send_timer->start(COALESCE_DELAY);
 }
 
-void Discord::postMultipartWebhook(QHttpMultiPart &f_multipart)
+void Discord::sendNext()
 {
-    if (!QUrl(m_request.url()).isValid()) {
-        qWarning("Invalid webhook URL!");
-        f_multipart.deleteLater();
+    if (m_in_flight || m_queue.isEmpty())
         return;
-    }
 
-    m_request.setHeader(QNetworkRequest::ContentTypeHeader, "multipart/form-data; boundary=" + f_multipart.boundary());
+    const Delivery &l_delivery = m_queue.head();
+    QNetworkRequest l_request(l_delivery.url);
+    auto l_callback = [this](const HttpService::Response &f_response) { onReplyFinished(f_response); };
 
-    QNetworkReply *l_reply = m_nam->post(m_request, &f_multipart);
-    f_multipart.setParent(l_reply);
+    if (l_delivery.attachment.isEmpty()) {
+        l_request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        m_http->post(l_request, constructPayloadJson(l_delivery).toJson(QJsonDocument::Compact), this, l_callback);
+    }
+    else {
+        QHttpMultiPart *l_multipart = constructMultipart(l_delivery);
+        l_request.setHeader(QNetworkRequest::ContentTypeHeader, "multipart/form-data; boundary=" + l_multipart->boundary());
+        m_http->post(l_request, l_multipart, this, l_callback);
+    }
+    m_in_flight = true;
 }
 
-void Discord::onReplyFinished(QNetworkReply *f_reply)
+void Discord::onReplyFinished(const HttpService::Response &f_response)
 {
-    auto l_data = f_reply->readAll();
-    f_reply->deleteLater();
+    m_in_flight = false;
+    if (m_queue.isEmpty())
+        return;
 
 #ifdef DISCORD_DEBUG
-    QDebug() << l_data;
-#else
-    Q_UNUSED(l_data);
+    qDebug() << f_response.status << f_response.body;
 #endif
+
+    const qint64 l_delay = rateLimitDelay(f_response);
+    if (f_response.status == 429) {
+        qWarning() << "Discord webhook is rate limited, retrying in" << l_delay << "ms.";
+        scheduleNext(l_delay);
+        return;
+    }
+
+    if (f_response.ok()) {
+        m_queue.dequeue();
+        scheduleNext(qMax<qint64>(l_delay, 0));
+        return;
+    }
+
+    // No HTTP response or a server error: worth another try. Anything else would be rejected again.
+    if (f_response.status == 0 || f_response.status >= 500) {
+        Delivery &l_delivery = m_queue.head();
+        l_delivery.attempts++;
+        if (l_delivery.attempts < MAX_ATTEMPTS) {
+            const qint64 l_backoff = qMin(BASE_RETRY << (l_delivery.attempts - 1), MAX_RETRY);
+            scheduleNext(qMax(l_delay, l_backoff));
+            return;
+        }
+        qWarning() << "Giving up on Discord webhook after" << MAX_ATTEMPTS << "attempts:" << f_response.error_string;
+    }
+    else
+        qWarning() << "Discord webhook rejected the message with status" << f_response.status << ":" << f_response.body;
+
+    m_queue.dequeue();
+    scheduleNext(qMax<qint64>(l_delay, 0));
+}
+
+void Discord::scheduleNext(qint64 f_delay)
+{
+    if (m_queue.isEmpty())
+        return;
+    m_send_timer->start(std::chrono::milliseconds(f_delay));
 }
 
-Discord::~Discord() { m_nam->deleteLater(); }
+qint64 Discord::rateLimitDelay(const HttpService::Response &f_response)
+{
+    bool l_ok = false;
+    double l_seconds = -1;
+
+    if (f_response.status == 429) {
+        l_seconds = f_response.header("Retry-After").toDouble(&l_ok);
+        if (!l_ok)
+            l_seconds = QJsonDocument::fromJson(f_response.body).object().value("retry_after").toDouble(BASE_RETRY / 1000.0);
+    }
+    else if (f_response.header("X-RateLimit-Remaining") == "0") {
+        l_seconds = f_response.header("X-RateLimit-Reset-After").toDouble(&l_ok);
+        if (!l_ok)
+            l_seconds = -1;
+    }
+
+    if (l_seconds < 0)
+        return -1;
+    return qMin(static_cast<qint64>(l_seconds * 1000), MAX_RETRY);
+}
 
 void Discord::startUptimeTimer()
 {
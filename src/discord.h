@@ -19,12 +19,25 @@
 #define DISCORD_H
 
 #include <QCoreApplication>
+#include <QQueue>
 #include <QtNetwork>
 
+#include "http_service.h"
+#include "logger/log_ring_buffer.h"
+
 class ConfigManager;
 
 /**
  * @brief A class for handling all Discord webhook requests.
+ *
+ * @details Webhook messages are not posted right away but go through a delivery queue, one message at a time.
+ * Embeds queued for the same webhook within #COALESCE_DELAY are merged into a single message of up to #MAX_EMBEDS
+ * embeds, so a burst of modcalls costs a few requests instead of dozens.
+ *
+ * The queue follows Discord's rate limits: it waits out a 429 for as long as Retry-After asks, and pauses once the
+ * X-RateLimit-Remaining header reaches zero until X-RateLimit-Reset-After has passed. Network and server errors are
+ * retried with an exponential backoff, up to #MAX_ATTEMPTS times. Once more than #MAX_QUEUED messages are waiting,
+ * the oldest ones are dropped.
  */
 class Discord : public QObject
 {
@@ -34,23 +47,13 @@ class Discord : public QObject
     /**
      * @brief Constructor for the Discord object
      *
-     * @param f_webhook_url The URL to send webhook POST requests to.
-     * @param f_webhook_content The content to include in the webhook POST request.
-     * @param f_webhook_sendfile Whether or not to send a file containing area logs with the webhook POST request.
+     * @param f_http The HTTP service webhooks are posted through.
      * @param parent Qt-based parent, passed along to inherited constructor from QObject.
      */
-    Discord(QObject *parent = nullptr);
-
-    /**
-     * @brief Deconstructor for the Discord class.
-     *
-     * @details Marks the network access manager to be deleted later.
-     */
-    ~Discord();
+    Discord(HttpService *f_http, QObject *parent = nullptr);
 
     /**
      * @brief Method to start the Uptime Webhook posting timer.
-     * json The JSON document to send.
      */
     void startUptimeTimer();
 
@@ -63,12 +66,15 @@ class Discord : public QObject
     /**
      * @brief Handles a modcall webhook request.
      *
+     * @details If log files are enabled, the log attachment is built on the thread pool and the modcall is queued
+     * once it is ready.
+     *
      * @param f_name The name of the modcall sender.
      * @param f_area The name of the area the modcall was sent from.
      * @param f_reason The reason for the modcall.
      * @param f_buffer The area's log buffer.
      */
-    void onModcallWebhookRequested(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason, const QQueue<QString> &f_buffer);
+    void onModcallWebhookRequested(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason, const LogRingBuffer::Snapshot &f_buffer);
 
     /**
      * @brief Handles a ban webhook request.
@@ -87,14 +93,82 @@ class Discord : public QObject
 
   private:
     /**
-     * @brief The QNetworkAccessManager for webhooks.
+     * @brief Embeds Discord accepts in a single message.
+     */
+    static constexpr int MAX_EMBEDS = 10;
+
+    /**
+     * @brief Characters Discord accepts in the title of an embed.
+     */
+    static constexpr int MAX_EMBED_TITLE = 256;
+
+    /**
+     * @brief Characters Discord accepts in the description of an embed.
+     */
+    static constexpr int MAX_EMBED_DESCRIPTION = 4096;
+
+    /**
+     * @brief Characters Discord accepts in the titles and descriptions of all embeds of a message combined.
+     */
+    static constexpr int MAX_EMBED_TEXT = 6000;
+
+    /**
+     * @brief Messages kept waiting before the oldest ones are dropped.
+     */
+    static constexpr int MAX_QUEUED = 32;
+
+    /**
+     * @brief Milliseconds a new message waits for further embeds to merge with before it is sent.
+     */
+    static constexpr int COALESCE_DELAY = 1000;
+
+    /**
+     * @brief Times a message is sent before it is given up on after network or server errors.
+     */
+    static constexpr int MAX_ATTEMPTS = 5;
+
+    /**
+     * @brief The backoff, in milliseconds, after the first failed attempt. Doubles with every further one.
+     */
+    static constexpr qint64 BASE_RETRY = 2000;
+
+    /**
+     * @brief The longest wait, in milliseconds, the queue accepts before sending again.
+     */
+    static constexpr qint64 MAX_RETRY = 300000;
+
+    /**
+     * @brief A message waiting to be posted to a webhook.
      */
-    QNetworkAccessManager *m_nam;
+    struct Delivery
+    {
+        QUrl url;              //!< The webhook to post to.
+        QString content;       //!< The plain text content of the message. May be empty.
+        QJsonArray embeds;     //!< The embeds of the message.
+        int embed_text = 0;    //!< The characters in the titles and descriptions of #embeds.
+        QByteArray attachment; //!< The log file attached to the message. Messages with an attachment are never merged.
+        int attempts = 0;      //!< The attempts that failed with a network or server error.
+    };
 
     /**
-     * @brief The QNetworkRequest for webhooks.
+     * @brief The HTTP service webhooks are posted through.
      */
-    QNetworkRequest m_request;
+    HttpService *m_http;
+
+    /**
+     * @brief Messages waiting to be posted, oldest first. While #m_in_flight is set, the first one is on the wire.
+     */
+    QQueue<Delivery> m_queue;
+
+    /**
+     * @brief Whether the first message of the queue is currently being posted.
+     */
+    bool m_in_flight = false;
+
+    /**
+     * @brief Fires when the next message may be sent.
+     */
+    QTimer *m_send_timer;
 
     /**
      * @brief Timer to post a message that the server is still alive.
@@ -102,65 +176,89 @@ class Discord : public QObject
     QTimer *m_uptimePostTimer;
 
     /**
-     * @brief Constructs a new JSON document for modcalls.
+     * @brief Constructs a new embed for modcalls.
      *
      * @param f_name The name of the modcall sender.
      * @param f_area The name of the area the modcall was sent from.
      * @param f_reason The reason for the modcall.
      *
-     * @return A JSON document for the modcall.
+     * @return A JSON object for the modcall.
      */
-    QJsonDocument constructModcallJson(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason) const;
+    QJsonObject constructModcallEmbed(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason) const;
 
     /**
-     * @brief Constructs a new QHttpMultiPart document for log files.
+     * @brief Constructs a new embed for bans.
      *
-     * @param f_buffer The area's log buffer.
+     * @param f_ipid The IPID of the client.
+     * @param f_moderator The name of the moderator banning.
+     * @param f_duration The date the ban expires.
+     * @param f_reason The reason of the ban.
      *
-     * @return A QHttpMultiPart containing the log file.
+     * @return A JSON object for the ban.
      */
-    QHttpMultiPart *constructLogMultipart(const QQueue<QString> &f_buffer) const;
+    QJsonObject constructBanEmbed(const QString &f_ipid, const QString &f_moderator, const QString &f_duration, const QString &f_reason, const int &f_banID) const;
 
-  private slots:
     /**
-     * @brief Handles a network reply from a webhook POST request.
+     * @brief Constructs a new embed for the server alive message.
+     *
+     * @param f_timeExpired formatted uptime as a string.
      *
-     * @param f_reply Pointer to the QNetworkReply created by the webhook POST request.
+     * @return A JSON object for the alive notification.
      */
-    void onReplyFinished(QNetworkReply *f_reply);
+    QJsonObject constructUptimeEmbed(const QString &f_timeExpired) const;
 
     /**
-     * @brief Sends a webhook POST request with the given JSON document.
+     * @brief Constructs the JSON body of a message.
+     *
+     * @param f_delivery The message to post.
      *
-     * @param f_json The JSON document to send.
+     * @return A JSON document holding the content and embeds of the message.
      */
-    void postJsonWebhook(const QJsonDocument &f_json);
+    QJsonDocument constructPayloadJson(const Delivery &f_delivery) const;
 
     /**
-     * @brief Sends a webhook POST request with the given QHttpMultiPart.
+     * @brief Constructs the QHttpMultiPart body of a message with a log file.
      *
-     * @param f_multipart The QHttpMultiPart to send.
+     * @param f_delivery The message to post.
+     *
+     * @return A QHttpMultiPart containing the message and its log file.
      */
-    void postMultipartWebhook(QHttpMultiPart &f_multipart);
+    QHttpMultiPart *constructMultipart(const Delivery &f_delivery) const;
 
     /**
-     * @brief Constructs a new JSON document for bans.
+     * @brief Queues an embed for a webhook, merging it into the last waiting message if possible.
      *
-     * @param f_ipid The IPID of the client.
-     * @param f_moderator The name of the moderator banning.
-     * @param f_duration The date the ban expires.
-     * @param f_reason The reason of the ban.
+     * @details Overlong titles and descriptions are cut to what Discord accepts. An embed is only merged if the message
+     * stays within the embed limits afterwards, as Discord rejects the whole message otherwise.
      *
-     * @return A JSON document for the ban.
+     * @param f_url The webhook to post to.
+     * @param f_content The plain text content of the message. May be empty.
+     * @param f_embed The embed to post.
+     * @param f_attachment The log file to attach. May be empty.
      */
-    QJsonDocument constructBanJson(const QString &f_ipid, const QString &f_moderator, const QString &f_duration, const QString &f_reason, const int &f_banID);
+    void enqueue(const QUrl &f_url, const QString &f_content, const QJsonObject &f_embed, const QByteArray &f_attachment = QByteArray());
+
     /**
-     * @brief Constructs a new JSON document for the server alive message.
-     * @param f_timeExpired formatted uptime as a string.
+     * @brief Posts the first message of the queue.
+     */
+    void sendNext();
+
+    /**
+     * @brief Handles the response to a webhook POST request.
      *
-     * @return A JSON document for the alive notification.
+     * @param f_response The response to the webhook POST request.
+     */
+    void onReplyFinished(const HttpService::Response &f_response);
+
+    /**
+     * @brief Waits the given amount of milliseconds before sending the next message.
+     */
+    void scheduleNext(qint64 f_delay);
+
+    /**
+     * @brief Returns how long, in milliseconds, Discord asked to wait before the next request, or -1 if it did not.
      */
-    QJsonDocument constructUptimeJson(const QString &f_timeExpired);
+    static qint64 rateLimitDelay(const HttpService::Response &f_response);
 };
 
 #endif // DISCORD_H
@@ -0,0 +1,162 @@
+#include "http_service.h"
+
+#include <QHttpMultiPart>
+
+namespace {
+/**
+ * @brief Returns the key requests share their connection slots under: scheme, host and port of the URL.
+ */
+QString hostKey(const QUrl &f_url)
+{
+    return f_url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toString();
+}
+}
+
+QByteArray HttpService::Response::header(const QByteArray &f_name) const
+{
+    for (const QNetworkReply::RawHeaderPair &l_header : headers) {
+        if (l_header.first.compare(f_name, Qt::CaseInsensitive) == 0)
+            return l_header.second;
+    }
+    return QByteArray();
+}
+
+HttpService::HttpService(QObject *parent) :
+    QObject(parent),
+    m_manager(new QNetworkAccessManager(this))
+{
+    m_manager->setTransferTimeout(TRANSFER_TIMEOUT);
+}
+
+void HttpService::get(const QNetworkRequest &f_request, QObject *f_context, Callback f_callback, qint64 f_cache_ttl)
+{
+    Waiter l_waiter = makeWaiter(f_context, std::move(f_callback));
+    const QUrl l_url = f_request.url();
+
+    if (f_cache_ttl > 0) {
+        auto l_cached = m_cache.constFind(l_url);
+        if (l_cached != m_cache.constEnd() && !l_cached->age.hasExpired(l_cached->ttl)) {
+            const Response l_response = l_cached->response;
+            QMetaObject::invokeMethod(this, [l_waiter, l_response] { deliver(l_waiter, l_response); }, Qt::QueuedConnection);
+            return;
+        }
+
+        auto l_inflight = m_inflight.find(l_url);
+        if (l_inflight != m_inflight.end()) {
+            l_inflight->append(l_waiter);
+            return;
+        }
+        m_inflight.insert(l_url, {});
+    }
+
+    Pending l_pending;
+    l_pending.operation = QNetworkAccessManager::GetOperation;
+    l_pending.request = f_request;
+    l_pending.cache_ttl = f_cache_ttl;
+    l_pending.waiter = l_waiter;
+    enqueue(std::move(l_pending));
+}
+
+void HttpService::post(const QNetworkRequest &f_request, const QByteArray &f_data, QObject *f_context, Callback f_callback)
+{
+    Pending l_pending;
+    l_pending.operation = QNetworkAccessManager::PostOperation;
+    l_pending.request = f_request;
+    l_pending.data = f_data;
+    l_pending.waiter = makeWaiter(f_context, std::move(f_callback));
+    enqueue(std::move(l_pending));
+}
+
+void HttpService::post(const QNetworkRequest &f_request, QHttpMultiPart *f_multipart, QObject *f_context, Callback f_callback)
+{
+    f_multipart->setParent(this);
+
+    Pending l_pending;
+    l_pending.operation = QNetworkAccessManager::PostOperation;
+    l_pending.request = f_request;
+    l_pending.multipart = f_multipart;
+    l_pending.waiter = makeWaiter(f_context, std::move(f_callback));
+    enqueue(std::move(l_pending));
+}
+
+void HttpService::enqueue(Pending f_pending)
+{
+    const QString l_host = hostKey(f_pending.request.url());
+    m_queues[l_host].enqueue(std::move(f_pending));
+    dispatch(l_host);
+}
+
+void HttpService::dispatch(const QString &f_host)
+{
+    auto l_queue = m_queues.find(f_host);
+    if (l_queue == m_queues.end())
+        return;
+
+    int &l_active = m_active[f_host];
+    while (l_active < MAX_PER_HOST && !l_queue->isEmpty()) {
+        Pending l_pending = l_queue->dequeue();
+
+        QNetworkReply *l_reply;
+        if (l_pending.operation == QNetworkAccessManager::GetOperation)
+            l_reply = m_manager->get(l_pending.request);
+        else if (l_pending.multipart != nullptr) {
+            l_reply = m_manager->post(l_pending.request, l_pending.multipart);
+            l_pending.multipart->setParent(l_reply);
+            l_pending.multipart = nullptr;
+        }
+        else
+            l_reply = m_manager->post(l_pending.request, l_pending.data);
+
+        l_active++;
+        connect(l_reply, &QNetworkReply::finished, this, [this, l_reply, l_pending = std::move(l_pending)]() mutable {
+            finished(l_reply, std::move(l_pending));
+        });
+    }
+
+    if (l_queue->isEmpty())
+        m_queues.erase(l_queue);
+    if (l_active == 0)
+        m_active.remove(f_host);
+}
+
+void HttpService::finished(QNetworkReply *f_reply, Pending f_pending)
+{
+    Response l_response;
+    l_response.error = f_reply->error();
+    if (l_response.error != QNetworkReply::NoError)
+        l_response.error_string = f_reply->errorString();
+    l_response.status = f_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    l_response.body = f_reply->readAll();
+    l_response.headers = f_reply->rawHeaderPairs();
+    f_reply->deleteLater();
+
+    const QUrl l_url = f_pending.request.url();
+    const QString l_host = hostKey(l_url);
+    if (--m_active[l_host] == 0)
+        m_active.remove(l_host);
+    dispatch(l_host);
+
+    QList<Waiter> l_waiters{f_pending.waiter};
+    if (f_pending.cache_ttl > 0) {
+        l_waiters.append(m_inflight.take(l_url));
+        CacheEntry &l_entry = m_cache[l_url];
+        l_entry.age.start();
+        l_entry.ttl = f_pending.cache_ttl;
+        l_entry.response = l_response;
+    }
+
+    for (const Waiter &l_waiter : std::as_const(l_waiters))
+        deliver(l_waiter, l_response);
+}
+
+void HttpService::deliver(const Waiter &f_waiter, const Response &f_response)
+{
+    if (!f_waiter.callback || (f_waiter.has_context && f_waiter.context.isNull()))
+        return;
+    f_waiter.callback(f_response);
+}
+
+HttpService::Waiter HttpService::makeWaiter(QObject *f_context, Callback f_callback)
+{
+    return Waiter{f_context, f_context != nullptr, std::move(f_callback)};
+}
@@ -0,0 +1,182 @@
+#ifndef HTTP_SERVICE_H
+#define HTTP_SERVICE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QUrl>
+
+#include <functional>
+
+class QHttpMultiPart;
+
+/**
+ * @brief Performs every outbound HTTP request of the server over one shared network access manager.
+ *
+ * @details Sharing the manager lets requests to the same host reuse its keep-alive connections. At most
+ * #MAX_PER_HOST requests per host are on the wire at once, the rest wait in a per-host queue. Every request
+ * is aborted if no data moved for #TRANSFER_TIMEOUT milliseconds.
+ *
+ * GET responses may be cached for a caller-chosen time. While a cached GET is still in flight, identical GETs
+ * wait for its response instead of sending their own.
+ *
+ * Callbacks are always invoked asynchronously on the thread owning the service, and are dropped if their
+ * context object was destroyed in the meantime. The service must only be used from the thread owning it.
+ */
+class HttpService : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The outcome of a request.
+     */
+    struct Response
+    {
+        QNetworkReply::NetworkError error = QNetworkReply::NoError; //!< The network error, if any.
+        QString error_string;                                       //!< A human readable description of the error.
+        int status = 0;                                             //!< The HTTP status code, or 0 if none was received.
+        QByteArray body;                                            //!< The response body.
+        QList<QNetworkReply::RawHeaderPair> headers;                //!< The response headers.
+
+        /**
+         * @brief Returns true if the request succeeded with a 2xx status.
+         */
+        bool ok() const { return error == QNetworkReply::NoError && status >= 200 && status < 300; }
+
+        /**
+         * @brief Returns the value of a response header, matched case-insensitively.
+         */
+        QByteArray header(const QByteArray &f_name) const;
+    };
+
+    using Callback = std::function<void(const Response &)>;
+
+    /**
+     * @brief Creates the service and its network access manager.
+     */
+    explicit HttpService(QObject *parent = nullptr);
+
+    /**
+     * @brief Sends a GET request.
+     *
+     * @param f_request The request to send.
+     * @param f_context The callback is dropped if this object is destroyed first. May be null.
+     * @param f_callback Receives the response. May be empty.
+     * @param f_cache_ttl If positive, the response is cached for this many milliseconds, failures included.
+     */
+    void get(const QNetworkRequest &f_request, QObject *f_context, Callback f_callback, qint64 f_cache_ttl = 0);
+
+    /**
+     * @brief Sends a POST request with a raw body.
+     */
+    void post(const QNetworkRequest &f_request, const QByteArray &f_data, QObject *f_context, Callback f_callback);
+
+    /**
+     * @brief Sends a POST request with a multipart body. The service takes ownership of the multipart.
+     */
+    void post(const QNetworkRequest &f_request, QHttpMultiPart *f_multipart, QObject *f_context, Callback f_callback);
+
+  private:
+    /**
+     * @brief Requests allowed on the wire to a single host at once.
+     */
+    static constexpr int MAX_PER_HOST = 4;
+
+    /**
+     * @brief Milliseconds without any transfer after which a request is aborted.
+     */
+    static constexpr int TRANSFER_TIMEOUT = 30000;
+
+    /**
+     * @brief A caller waiting for a response.
+     */
+    struct Waiter
+    {
+        QPointer<QObject> context;
+        bool has_context;
+        Callback callback;
+    };
+
+    /**
+     * @brief A request waiting for, or occupying, a slot of its host.
+     */
+    struct Pending
+    {
+        QNetworkAccessManager::Operation operation;
+        QNetworkRequest request;
+        QByteArray data;
+        QHttpMultiPart *multipart = nullptr;
+        qint64 cache_ttl = 0;
+        Waiter waiter;
+    };
+
+    /**
+     * @brief A cached GET response.
+     */
+    struct CacheEntry
+    {
+        QElapsedTimer age;
+        qint64 ttl;
+        Response response;
+    };
+
+    /**
+     * @brief Queues a request for its host and sends it if a slot is free.
+     */
+    void enqueue(Pending f_pending);
+
+    /**
+     * @brief Sends queued requests of a host until its slots are used up.
+     */
+    void dispatch(const QString &f_host);
+
+    /**
+     * @brief Collects the response of a finished request and hands it to everyone waiting for it.
+     */
+    void finished(QNetworkReply *f_reply, Pending f_pending);
+
+    /**
+     * @brief Hands a response to a waiter, unless its context is gone.
+     */
+    static void deliver(const Waiter &f_waiter, const Response &f_response);
+
+    /**
+     * @brief Builds a waiter for the given context and callback.
+     */
+    static Waiter makeWaiter(QObject *f_context, Callback f_callback);
+
+    /**
+     * @brief The only network access manager of the server.
+     */
+    QNetworkAccessManager *m_manager;
+
+    /**
+     * @brief Requests waiting for a free slot, by host.
+     */
+    QHash<QString, QQueue<Pending>> m_queues;
+
+    /**
+     * @brief Requests on the wire, by host.
+     */
+    QHash<QString, int> m_active;
+
+    /**
+     * @brief Cached GETs that are queued or on the wire, by URL, with the callers of identical GETs that joined them.
+     */
+    QHash<QUrl, QList<Waiter>> m_inflight;
+
+    /**
+     * @brief Cached GET responses, by URL.
+     */
+    QHash<QUrl, CacheEntry> m_cache;
+};
+
+#endif // HTTP_SERVICE_H
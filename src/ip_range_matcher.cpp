@@ -0,0 +1,68 @@
+#include "ip_range_matcher.h"
+
+void IPRangeMatcher::load(const QStringList &f_ranges)
+{
+    m_nodes = {Node{}};
+    m_size = 0;
+
+    for (const QString &l_range : f_ranges) {
+        const QPair<QHostAddress, int> l_subnet = QHostAddress::parseSubnet(l_range);
+        if (l_subnet.second < 0)
+            continue;
+
+        // IPv4 subnets live below ::ffff:0:0/96.
+        const Q_IPV6ADDR l_address = l_subnet.first.toIPv6Address();
+        const int l_prefix = l_subnet.first.protocol() == QAbstractSocket::IPv4Protocol ? l_subnet.second + 96 : l_subnet.second;
+
+        int l_node = 0;
+        for (int i = 0; i < l_prefix && !m_nodes.at(l_node).terminal; i++) {
+            const int l_bit = bitAt(l_address, i);
+            if (m_nodes.at(l_node).children[l_bit] < 0) {
+                m_nodes[l_node].children[l_bit] = m_nodes.size();
+                m_nodes.append(Node{});
+            }
+            l_node = m_nodes.at(l_node).children[l_bit];
+        }
+
+        // A wider subnet that is already loaded makes this one redundant.
+        if (!m_nodes.at(l_node).terminal) {
+            m_nodes[l_node].terminal = true;
+            m_nodes[l_node].children[0] = -1;
+            m_nodes[l_node].children[1] = -1;
+        }
+        m_size++;
+    }
+}
+
+bool IPRangeMatcher::contains(const QHostAddress &f_address) const
+{
+    if (f_address.isNull())
+        return false;
+
+    const Q_IPV6ADDR l_address = f_address.toIPv6Address();
+    int l_node = 0;
+    for (int i = 0; i < 128; i++) {
+        if (m_nodes.at(l_node).terminal)
+            return true;
+
+        l_node = m_nodes.at(l_node).children[bitAt(l_address, i)];
+        if (l_node < 0)
+            return false;
+    }
+
+    return m_nodes.at(l_node).terminal;
+}
+
+int IPRangeMatcher::size() const { return m_size; }
+
+QHostAddress IPRangeMatcher::normalize(const QHostAddress &f_address)
+{
+    bool l_ok;
+    const quint32 l_ipv4 = f_address.toIPv4Address(&l_ok);
+    if (l_ok)
+        return QHostAddress(l_ipv4);
+
+    return f_address;
+}
+
+int IPRangeMatcher::bitAt(const Q_IPV6ADDR &f_address, int f_position) { return (f_address[f_position / 8] >> (7 - f_position % 8)) & 1; }
@@ -0,0 +1,67 @@
+#ifndef IP_RANGE_MATCHER_H
+#define IP_RANGE_MATCHER_H
+
+#include <QHostAddress>
+#include <QList>
+#include <QStringList>
+
+/**
+ * @brief Matches addresses against a list of IPv4 and IPv6 subnets.
+ *
+ * @details The subnets are compiled into a binary radix trie over the 128 bits of an IPv6 address. IPv4 subnets are
+ * stored as their IPv4-mapped IPv6 equivalent, so `1.2.3.4` and `::ffff:1.2.3.4` match the same entries.
+ * A lookup walks at most one node per prefix bit, no matter how many subnets are loaded.
+ */
+class IPRangeMatcher
+{
+  public:
+    /**
+     * @brief Replaces all loaded subnets.
+     *
+     * @param f_ranges Subnets in the notation accepted by QHostAddress::parseSubnet(), e.g. `10.0.0.0/8` or `2001:db8::/32`.
+     * Lines that are not a valid subnet are skipped.
+     */
+    void load(const QStringList &f_ranges);
+
+    /**
+     * @brief Returns true if the address is inside any of the loaded subnets.
+     */
+    bool contains(const QHostAddress &f_address) const;
+
+    /**
+     * @brief Returns the amount of subnets that were loaded.
+     */
+    int size() const;
+
+    /**
+     * @brief Converts an IPv4-mapped IPv6 address to its IPv4 form. Other addresses are returned unchanged.
+     */
+    static QHostAddress normalize(const QHostAddress &f_address);
+
+  private:
+    /**
+     * @brief A single bit position in the trie.
+     */
+    struct Node
+    {
+        int children[2] = {-1, -1}; //!< Indices of the nodes for the next bit being 0 or 1. -1 if absent.
+        bool terminal = false;      //!< If true, a subnet ends here and every address below it matches.
+    };
+
+    /**
+     * @brief Returns the bit of the address at the given position, counting from the most significant bit.
+     */
+    static int bitAt(const Q_IPV6ADDR &f_address, int f_position);
+
+    /**
+     * @brief The nodes of the trie. The root is always the first node.
+     */
+    QList<Node> m_nodes{Node{}};
+
+    /**
+     * @brief The amount of subnets that were loaded.
+     */
+    int m_size = 0;
+};
+
+#endif // IP_RANGE_MATCHER_H
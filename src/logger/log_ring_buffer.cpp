@@ -0,0 +1,90 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "logger/log_ring_buffer.h"
+
+int LogRingBuffer::Snapshot::size() const { return m_count; }
+
+bool LogRingBuffer::Snapshot::isEmpty() const { return m_count == 0; }
+
+const QString &LogRingBuffer::Snapshot::at(int f_index) const
+{
+    const int l_position = m_first + f_index;
+    return m_blocks.at(l_position / BLOCK_SIZE)->entries.at(l_position % BLOCK_SIZE);
+}
+
+QString LogRingBuffer::Snapshot::join(const QString &f_separator) const
+{
+    qsizetype l_size = 0;
+    for (int i = 0; i < m_count; i++)
+        l_size += at(i).size() + f_separator.size();
+
+    QString l_joined;
+    l_joined.reserve(l_size);
+    for (int i = 0; i < m_count; i++) {
+        l_joined.append(at(i));
+        l_joined.append(f_separator);
+    }
+
+    return l_joined;
+}
+
+void LogRingBuffer::setLimits(int f_max_entries, qsizetype f_max_size)
+{
+    m_max_entries = qMax(f_max_entries, 1);
+    m_max_size = f_max_size;
+    evict();
+}
+
+void LogRingBuffer::append(const QString &f_entry)
+{
+    const int l_position = m_first + m_count;
+    if (l_position / BLOCK_SIZE >= m_blocks.size())
+        m_blocks.append(std::make_shared<Block>());
+
+    m_blocks.last()->entries[l_position % BLOCK_SIZE] = f_entry;
+    m_count++;
+    m_size += f_entry.size();
+    evict();
+}
+
+LogRingBuffer::Snapshot LogRingBuffer::snapshot() const
+{
+    Snapshot l_snapshot;
+    l_snapshot.m_first = m_first;
+    l_snapshot.m_count = m_count;
+    l_snapshot.m_blocks.reserve(m_blocks.size());
+    for (const std::shared_ptr<Block> &l_block : m_blocks)
+        l_snapshot.m_blocks.append(l_block);
+
+    return l_snapshot;
+}
+
+void LogRingBuffer::evict()
+{
+    while (m_count > m_max_entries || (m_size > m_max_size && m_count > 1)) {
+        // The evicted entry is left in its slot, as a snapshot may still be reading it.
+        m_size -= m_blocks.constFirst()->entries.at(m_first).size();
+        m_first++;
+        m_count--;
+
+        if (m_first == BLOCK_SIZE) {
+            m_blocks.removeFirst();
+            m_first = 0;
+        }
+    }
+}
@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef LOG_RING_BUFFER_H
+#define LOG_RING_BUFFER_H
+
+#include <QList>
+#include <QString>
+
+#include <array>
+#include <memory>
+
+/**
+ * @brief A bounded history of log entries, used for the per-area log buffers.
+ *
+ * @details Entries are stored in fixed-size blocks that are never modified once an entry has been written, so a
+ * Snapshot only has to share the blocks it covers. Appending is O(1) and evicts the oldest entries once either the
+ * entry or the size limit is exceeded.
+ */
+class LogRingBuffer
+{
+  private:
+    /**
+     * @brief The amount of entries stored per block.
+     */
+    static constexpr int BLOCK_SIZE = 64;
+
+    /**
+     * @brief A fixed-size run of entries.
+     */
+    struct Block
+    {
+        std::array<QString, BLOCK_SIZE> entries; //!< The entries. Slots are written once and never changed afterwards.
+    };
+
+  public:
+    /**
+     * @brief An immutable view of the entries a buffer held at one point in time.
+     *
+     * @details Copying a snapshot only copies references to the underlying blocks. Snapshots stay valid after the buffer
+     * moves on or is destroyed, and may be read from any thread.
+     */
+    class Snapshot
+    {
+      public:
+        /**
+         * @brief Returns the amount of entries in the snapshot.
+         */
+        int size() const;
+
+        /**
+         * @brief Returns true if the snapshot contains no entries.
+         */
+        bool isEmpty() const;
+
+        /**
+         * @brief Returns the entry at the given position, starting from the oldest.
+         */
+        const QString &at(int f_index) const;
+
+        /**
+         * @brief Returns all entries concatenated, each followed by the separator.
+         */
+        QString join(const QString &f_separator = QString()) const;
+
+      private:
+        friend class LogRingBuffer;
+
+        QList<std::shared_ptr<const Block>> m_blocks; //!< The blocks covering the entries.
+        int m_first = 0;                              //!< The position of the oldest entry in the first block.
+        int m_count = 0;                              //!< The amount of entries.
+    };
+
+    /**
+     * @brief Sets the limits of the buffer, evicting the oldest entries if they are exceeded.
+     *
+     * @param f_max_entries The maximum amount of entries.
+     * @param f_max_size The maximum combined size of all entries, in characters. The newest entry is always kept.
+     */
+    void setLimits(int f_max_entries, qsizetype f_max_size);
+
+    /**
+     * @brief Adds an entry, evicting the oldest ones if a limit is exceeded.
+     */
+    void append(const QString &f_entry);
+
+    /**
+     * @brief Returns a view of the current entries.
+     */
+    Snapshot snapshot() const;
+
+  private:
+    /**
+     * @brief Removes the oldest entries until both limits are met.
+     */
+    void evict();
+
+    /**
+     * @brief The blocks holding the entries, oldest first.
+     */
+    QList<std::shared_ptr<Block>> m_blocks;
+
+    /**
+     * @brief The position of the oldest entry in the first block.
+     */
+    int m_first = 0;
+
+    /**
+     * @brief The amount of entries in the buffer.
+     */
+    int m_count = 0;
+
+    /**
+     * @brief The combined size of all entries, in characters.
+     */
+    qsizetype m_size = 0;
+
+    /**
+     * @brief The maximum amount of entries.
+     */
+    int m_max_entries = 500;
+
+    /**
+     * @brief The maximum combined size of all entries, in characters.
+     */
+    qsizetype m_max_size = 1024 * 1024;
+};
+
+#endif // LOG_RING_BUFFER_H
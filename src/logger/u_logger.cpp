@@ -27,7 +27,14 @@ ULogger::ULogger(QObject *parent) :
         break;
     case DataTypes::LogType::FULL:
     case DataTypes::LogType::FULLAREA:
+        // Entries are written on a separate thread, so the game thread never waits for the disk.
+        m_writer_thread = new QThread(this);
+        m_writer_thread->setObjectName("log-writer");
         writerFull = new WriterFull;
+        writerFull->moveToThread(m_writer_thread);
+        connect(m_writer_thread, &QThread::started, writerFull, &WriterFull::start);
+        connect(m_writer_thread, &QThread::finished, writerFull, &QObject::deleteLater);
+        m_writer_thread->start();
         break;
     }
 
@@ -36,14 +43,13 @@ ULogger::ULogger(QObject *parent) :
 
 ULogger::~ULogger()
 {
-    switch (ConfigManager::loggingType()) {
-    case DataTypes::LogType::MODCALL:
+    if (writerModcall != nullptr)
         writerModcall->deleteLater();
-        break;
-    case DataTypes::LogType::FULL:
-    case DataTypes::LogType::FULLAREA:
-        writerFull->deleteLater();
-        break;
+
+    // The writer is deleted on its own thread once it finishes, which writes out whatever is still pending.
+    if (m_writer_thread != nullptr) {
+        m_writer_thread->quit();
+        m_writer_thread->wait();
     }
 }
 
@@ -126,7 +132,7 @@ void ULogger::logModcall(const QString &f_char_name, const QString &f_ipid, cons
                              .arg(l_time, f_area_name, f_char_name, f_ooc_name, f_ipid, f_uid, f_hwid, f_hub);
     updateAreaBuffer(f_area_name, l_logEvent);
 
-    if (ConfigManager::loggingType() == DataTypes::LogType::MODCALL)
+    if (ConfigManager::loggingType() == DataTypes::LogType::MODCALL && writerModcall != nullptr)
         writerModcall->flush(f_area_name, buffer(f_area_name));
 }
 
@@ -186,16 +192,13 @@ void ULogger::loadLogtext()
 
 void ULogger::updateAreaBuffer(const QString &f_area_name, const QString &f_log_entry)
 {
-    QQueue<QString> l_buffer = m_bufferMap.value(f_area_name);
-
-    if (l_buffer.length() <= ConfigManager::logBuffer())
-        l_buffer.enqueue(f_log_entry);
-    else {
-        l_buffer.dequeue();
-        l_buffer.enqueue(f_log_entry);
-    }
+    // Updated in place, the limits are re-applied in case they changed on reload.
+    LogRingBuffer &l_buffer = m_bufferMap[f_area_name];
+    l_buffer.setLimits(ConfigManager::logBuffer(), ConfigManager::logBufferSize());
+    l_buffer.append(f_log_entry);
 
-    m_bufferMap.insert(f_area_name, l_buffer);
+    if (writerFull == nullptr)
+        return;
 
     if (ConfigManager::loggingType() == DataTypes::LogType::FULL)
         writerFull->flush(f_log_entry);
@@ -204,4 +207,11 @@ void ULogger::updateAreaBuffer(const QString &f_area_name, const QString &f_log_
         writerFull->flush(f_log_entry, f_area_name);
 }
 
-QQueue<QString> ULogger::buffer(const QString &f_area_name) { return m_bufferMap.value(f_area_name); }
+LogRingBuffer::Snapshot ULogger::buffer(const QString &f_area_name)
+{
+    auto l_buffer = m_bufferMap.constFind(f_area_name);
+    if (l_buffer == m_bufferMap.cend())
+        return LogRingBuffer::Snapshot();
+
+    return l_buffer->snapshot();
+}
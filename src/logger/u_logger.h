@@ -18,12 +18,13 @@
 #ifndef U_LOGGER_H
 #define U_LOGGER_H
 
+#include "logger/log_ring_buffer.h"
 #include "logger/writer_full.h"
 #include "logger/writer_modcall.h"
 #include <QDateTime>
-#include <QMap>
+#include <QHash>
 #include <QObject>
-#include <QQueue>
+#include <QThread>
 
 /**
  * @brief The Universal Logger class to provide a common place to handle, store and write logs to file.
@@ -45,10 +46,10 @@ class ULogger : public QObject
     virtual ~ULogger();
 
     /**
-     * @brief Returns the buffer of a respective area. Primarily used by the Discord Webhook.
+     * @brief Returns a snapshot of the buffer of a respective area. Primarily used by the Discord Webhook.
      * @param Name of the area which buffer is requested.
      */
-    QQueue<QString> buffer(const QString &f_areaName);
+    LogRingBuffer::Snapshot buffer(const QString &f_areaName);
 
   public slots:
 
@@ -142,21 +143,26 @@ class ULogger : public QObject
     void updateAreaBuffer(const QString &f_areaName, const QString &f_log_entry);
 
     /**
-     * @brief QMap of all available area buffers.
+     * @brief QHash of all available area buffers.
      *
-     * @details This QMap uses the area name as the index key to access its respective buffer.
+     * @details This QHash uses the area name as the index key to access its respective buffer.
      */
-    QMap<QString, QQueue<QString>> m_bufferMap;
+    QHash<QString, LogRingBuffer> m_bufferMap;
 
     /**
-     * @brief Pointer to modcall writer. Handles QQueue delogging into area specific file.
+     * @brief Pointer to modcall writer. Handles writing area buffers into modcall reports.
      */
-    WriterModcall *writerModcall;
+    WriterModcall *writerModcall = nullptr;
 
     /**
      * @brief Pointer to full writer. Handles single messages in one file.
      */
-    WriterFull *writerFull;
+    WriterFull *writerFull = nullptr;
+
+    /**
+     * @brief The thread the full writer runs on.
+     */
+    QThread *m_writer_thread = nullptr;
 
     /**
      * @brief Table that contains template strings for text-based logger format.
@@ -17,47 +17,110 @@
 //////////////////////////////////////////////////////////////////////////////////////
 #include "logger/writer_full.h"
 
+#include <QFileInfo>
+
 WriterFull::WriterFull(QObject *parent) :
     QObject(parent)
 {
     l_dir.setPath("logs/");
     if (!l_dir.exists())
         l_dir.mkpath(".");
+
+    m_flush_timer = new QTimer(this);
+    m_flush_timer->setInterval(FLUSH_INTERVAL);
+    connect(m_flush_timer, &QTimer::timeout, this, &WriterFull::writePending);
+
+    m_rotation_timer = new QTimer(this);
+    m_rotation_timer->setInterval(ROTATION_CHECK_INTERVAL);
+    connect(m_rotation_timer, &QTimer::timeout, this, &WriterFull::checkRotation);
+}
+
+WriterFull::~WriterFull()
+{
+    writePending();
+    for (QFile *l_file : std::as_const(m_files))
+        l_file->close();
+}
+
+void WriterFull::start()
+{
+    checkRotation();
+    m_flush_timer->start();
+    m_rotation_timer->start();
+}
+
+void WriterFull::flush(const QString f_entry) { enqueue({"logs/server.log", f_entry}); }
+
+void WriterFull::flush(const QString f_entry, const QString f_area_name) { enqueue({QString("logs/%1.log").arg(f_area_name), f_entry}); }
+
+void WriterFull::enqueue(LogRecord f_record)
+{
+    const qsizetype l_size = f_record.entry.size();
+    m_records.push(std::move(f_record));
+
+    if (m_pending_size.fetch_add(l_size, std::memory_order_relaxed) + l_size >= FLUSH_THRESHOLD && !m_write_pending.exchange(true, std::memory_order_acq_rel))
+        QMetaObject::invokeMethod(this, &WriterFull::writePending, Qt::QueuedConnection);
 }
 
-void WriterFull::flush(const QString f_entry)
+void WriterFull::writePending()
 {
-    l_logfile.setFileName("logs/server.log");
+    m_write_pending.store(false, std::memory_order_release);
 
-    if (l_logfile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream file_stream(&l_logfile);
-        file_stream << f_entry;
-        l_logfile.close();
+    LogRecord l_record;
+    bool l_written = false;
+    while (m_records.pop(l_record)) {
+        m_pending_size.fetch_sub(l_record.entry.size(), std::memory_order_relaxed);
+
+        QFile *l_file = logFile(l_record.file_name);
+        if (l_file != nullptr) {
+            l_file->write(l_record.entry.toUtf8());
+            l_written = true;
+        }
     }
 
+    if (l_written)
+        for (QFile *l_file : std::as_const(m_files))
+            l_file->flush();
+}
+
+void WriterFull::checkRotation()
+{
     QFileInfo l_fileinfo("logs/server.log");
+    if (!l_fileinfo.exists() || !l_fileinfo.birthTime().isValid())
+        return;
+
     if (QDateTime::currentDateTime().toSecsSinceEpoch() - l_fileinfo.birthTime().toSecsSinceEpoch() > 7776000) { // rename log file every 90 days
+        // Everything logged so far still belongs into the old file.
+        writePending();
+        QFile *l_open_file = m_files.take("logs/server.log");
+        if (l_open_file != nullptr) {
+            l_open_file->close();
+            delete l_open_file;
+        }
+
         QString newFileName = "logs/server-" + l_fileinfo.birthTime().toString("yyyy.MM.dd-HH.mm.ss") + "-" + QDateTime::currentDateTime().toString("yyyy.MM.dd-HH.mm.ss") + ".log";
         bool renamed = QFile::rename("logs/server.log", newFileName);
 
         if (renamed) {
-            QFile file("logs/server.log");
-            if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-                file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileBirthTime);
-                file.close();
-            }
+            QFile *l_file = logFile("logs/server.log");
+            if (l_file != nullptr)
+                l_file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileBirthTime);
         }
     }
 }
 
-void WriterFull::flush(const QString f_entry, const QString f_area_name)
+QFile *WriterFull::logFile(const QString &f_file_name)
 {
-    l_logfile.setFileName(QString("logs/%1.log").arg(f_area_name));
+    QFile *l_file = m_files.value(f_file_name);
+    if (l_file != nullptr)
+        return l_file;
 
-    if (l_logfile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream file_stream(&l_logfile);
-        file_stream << f_entry;
+    l_file = new QFile(f_file_name, this);
+    if (!l_file->open(QIODevice::WriteOnly | QIODevice::Append)) {
+        delete l_file;
+        return nullptr;
     }
 
-    l_logfile.close();
-};
+    m_files.insert(f_file_name, l_file);
+    return l_file;
+}
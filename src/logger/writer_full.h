@@ -20,50 +20,135 @@
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QHash>
 #include <QObject>
-#include <QTextStream>
+#include <QTimer>
+
+#include <atomic>
+
+#include "network/mpsc_queue.h"
 
 /**
  * @brief A class to handle file interaction when writing in full log mode.
+ *
+ * @details The writer lives on its own thread. Log entries are handed to it through a lock-free queue and written in
+ * batches, either every #FLUSH_INTERVAL milliseconds or as soon as #FLUSH_THRESHOLD characters are pending.
+ * Log files are kept open between batches.
  */
 class WriterFull : public QObject
 {
     Q_OBJECT
 
   public:
+    /**
+     * @brief The time in milliseconds after which pending entries are written at the latest.
+     */
+    static constexpr int FLUSH_INTERVAL = 1000;
+
+    /**
+     * @brief The amount of pending characters that causes a batch to be written right away.
+     */
+    static constexpr qsizetype FLUSH_THRESHOLD = 65536;
+
+    /**
+     * @brief The time in milliseconds between checks whether server.log has to be rotated.
+     */
+    static constexpr int ROTATION_CHECK_INTERVAL = 60000;
+
     /**
      * @brief Constructor for full logwriter
      *
      * @param QObject pointer to the parent object.
      */
     WriterFull(QObject *parent = nullptr);
-    ;
 
     /**
      * @brief Deconstructor for full logwriter.
      *
-     * @details Doesn't really do anything, but its here for completeness sake.
+     * @details Writes all pending entries and closes the log files.
      */
-    virtual ~WriterFull() {}
+    virtual ~WriterFull();
 
     /**
-     * @brief Function to write log entry into a logfile.
+     * @brief Function to write log entry into a logfile. Safe to call from any thread.
      * @param Preformatted QString which will be written into the logfile.
      */
     void flush(const QString f_entry);
 
     /**
-     * @brief Writes log entry into area seperated logfiles.
+     * @brief Writes log entry into area seperated logfiles. Safe to call from any thread.
      * @param Preformatted QString which will be written into the logfile
      * @param Area name of the target logfile.
      */
     void flush(const QString f_entry, const QString f_area_name);
 
+  public slots:
+    /**
+     * @brief Starts the flush and rotation timers. Has to run on the writer thread.
+     */
+    void start();
+
   private:
     /**
-     * @brief Filename of the logfile used. This will always be the time the server starts up.
+     * @brief A log entry waiting to be written.
+     */
+    struct LogRecord
+    {
+        QString file_name; //!< The logfile the entry belongs to.
+        QString entry;     //!< The preformatted entry.
+    };
+
+    /**
+     * @brief Queues a record and wakes up the writer thread if enough data is pending.
+     */
+    void enqueue(LogRecord f_record);
+
+    /**
+     * @brief Writes all pending records to their logfiles.
+     */
+    void writePending();
+
+    /**
+     * @brief Renames server.log once it is older than 90 days.
+     */
+    void checkRotation();
+
+    /**
+     * @brief Returns the open handle of a logfile, opening it if needed.
+     *
+     * @return nullptr if the file could not be opened.
+     */
+    QFile *logFile(const QString &f_file_name);
+
+    /**
+     * @brief Records handed over by the logger.
+     */
+    MpscQueue<LogRecord> m_records;
+
+    /**
+     * @brief The combined size of the records in #m_records.
+     */
+    std::atomic<qsizetype> m_pending_size{0};
+
+    /**
+     * @brief If true, a call to writePending() is already queued on the writer thread.
+     */
+    std::atomic<bool> m_write_pending{false};
+
+    /**
+     * @brief Open logfiles, by their path.
+     */
+    QHash<QString, QFile *> m_files;
+
+    /**
+     * @brief Writes pending records every #FLUSH_INTERVAL milliseconds.
+     */
+    QTimer *m_flush_timer;
+
+    /**
+     * @brief Checks for log rotation every #ROTATION_CHECK_INTERVAL milliseconds.
      */
-    QFile l_logfile;
+    QTimer *m_rotation_timer;
 
     /**
      * @brief Directory where logfiles will be stored.
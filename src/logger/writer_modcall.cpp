@@ -29,13 +29,13 @@ WriterModcall::WriterModcall(QObject *parent) :
         l_dir.mkpath(".");
 }
 
-void WriterModcall::flush(const QString f_area_name, QQueue<QString> f_buffer)
+void WriterModcall::flush(const QString f_area_name, const LogRingBuffer::Snapshot &f_buffer)
 {
     l_logfile.setFileName(QString("logs/modcall/report_%1_%2.log").arg(f_area_name, (QDateTime::currentDateTime().toString("yyyy-MM-dd_hhmmss"))));
     if (l_logfile.open(QIODevice::WriteOnly | QIODevice::Append)) {
         QTextStream file_stream(&l_logfile);
-        while (!f_buffer.isEmpty())
-            file_stream << f_buffer.dequeue();
+        for (int i = 0; i < f_buffer.size(); i++)
+            file_stream << f_buffer.at(i);
     }
 
     l_logfile.close();
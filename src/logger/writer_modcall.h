@@ -21,10 +21,10 @@
 #include <QDir>
 #include <QFile>
 #include <QObject>
-#include <QQueue>
-
 #include <QTextStream>
 
+#include "logger/log_ring_buffer.h"
+
 /**
  * @brief A class to handle file interaction when writing the modcall buffer.
  */
@@ -50,10 +50,10 @@ class WriterModcall : public QObject
 
     /**
      * @brief Function to write area buffer into a logfile.
-     * @param QQueue of the area that will be written into the logfile.
+     * @param Snapshot of the area buffer that will be written into the logfile.
      * @param Name of the area for the filename.
      */
-    void flush(const QString f_area_name, QQueue<QString> f_buffer);
+    void flush(const QString f_area_name, const LogRingBuffer::Snapshot &f_buffer);
 
   private:
     /**
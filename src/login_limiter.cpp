@@ -0,0 +1,120 @@
+#include "login_limiter.h"
+
+#include <QDebug>
+#include <QPair>
+#include <QStringList>
+
+#include <algorithm>
+
+LoginLimiter::LoginLimiter() { m_clock.start(); }
+
+LoginLimiter::Verdict LoginLimiter::admit(const QString &f_ipid, const QString &f_hwid, qint64 *f_retry_after)
+{
+    const qint64 l_now = m_clock.elapsed();
+    if (l_now - m_last_prune > 60000)
+        prune(l_now);
+
+    const QStringList l_keys = keysOf(f_ipid, f_hwid);
+    qint64 l_locked_until = 0;
+    for (const QString &l_key : l_keys) {
+        auto l_it = m_records.find(l_key);
+        if (l_it == m_records.end())
+            continue;
+
+        if (l_now - l_it->last_attempt > RESET_INTERVAL)
+            m_records.erase(l_it);
+        else if (l_it->locked_until > l_now) {
+            l_it->rejected++;
+            l_locked_until = qMax(l_locked_until, l_it->locked_until);
+        }
+    }
+
+    if (l_locked_until > l_now) {
+        m_rejected++;
+        report(l_now);
+        if (f_retry_after != nullptr)
+            *f_retry_after = l_locked_until - l_now;
+        return Verdict::LockedOut;
+    }
+
+    if (m_in_flight.fetch_add(1) >= MAX_IN_FLIGHT) {
+        m_in_flight.fetch_sub(1);
+        m_rejected++;
+        report(l_now);
+        return Verdict::Busy;
+    }
+
+    for (const QString &l_key : l_keys) {
+        Record &l_record = m_records[l_key];
+        l_record.attempts++;
+        l_record.last_attempt = l_now;
+        if (l_record.attempts < FREE_ATTEMPTS)
+            continue;
+
+        const int l_doublings = qMin(l_record.attempts - FREE_ATTEMPTS, 20);
+        l_record.locked_until = l_now + qMin(MAX_BACKOFF, BASE_BACKOFF << l_doublings);
+        if (l_record.attempts == FREE_ATTEMPTS)
+            qWarning().noquote() << QString("Login attempt budget exhausted for %1.").arg(l_key);
+    }
+
+    return Verdict::Admitted;
+}
+
+void LoginLimiter::release() { m_in_flight.fetch_sub(1); }
+
+void LoginLimiter::succeeded(const QString &f_ipid, const QString &f_hwid)
+{
+    const QStringList l_keys = keysOf(f_ipid, f_hwid);
+    for (const QString &l_key : l_keys)
+        m_records.remove(l_key);
+}
+
+QStringList LoginLimiter::keysOf(const QString &f_ipid, const QString &f_hwid)
+{
+    QStringList l_keys{"ipid:" + f_ipid};
+    if (!f_hwid.isEmpty())
+        l_keys.append("hwid:" + f_hwid);
+
+    return l_keys;
+}
+
+void LoginLimiter::prune(qint64 f_now)
+{
+    m_last_prune = f_now;
+
+    for (auto l_it = m_records.begin(); l_it != m_records.end();) {
+        if (f_now - l_it->last_attempt > RESET_INTERVAL)
+            l_it = m_records.erase(l_it);
+        else
+            ++l_it;
+    }
+}
+
+void LoginLimiter::report(qint64 f_now)
+{
+    if (m_last_report != 0 && f_now - m_last_report < REPORT_INTERVAL)
+        return;
+
+    QList<QPair<int, QString>> l_keys;
+    for (auto l_it = m_records.begin(); l_it != m_records.end(); ++l_it) {
+        if (l_it->rejected == 0)
+            continue;
+
+        l_keys.append({l_it->rejected, l_it.key()});
+        l_it->rejected = 0;
+    }
+    std::sort(l_keys.begin(), l_keys.end(), [](const QPair<int, QString> &f_a, const QPair<int, QString> &f_b) { return f_a.first > f_b.first; });
+
+    QStringList l_summary;
+    for (int i = 0; i < qMin(l_keys.size(), REPORT_MAX_KEYS); i++)
+        l_summary.append(QString("%1 (%2)").arg(l_keys.at(i).second).arg(l_keys.at(i).first));
+    if (l_keys.size() > REPORT_MAX_KEYS)
+        l_summary.append(QString("and %1 more").arg(l_keys.size() - REPORT_MAX_KEYS));
+
+    qWarning().noquote() << QString("Rejected %1 login attempts since the last report, %2 since the server started. Locked out: %3")
+                                .arg(m_rejected - m_reported)
+                                .arg(m_rejected)
+                                .arg(l_summary.isEmpty() ? QString("none, the server was busy") : l_summary.join(", "));
+    m_reported = m_rejected;
+    m_last_report = f_now;
+}
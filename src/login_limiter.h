@@ -0,0 +1,159 @@
+#ifndef LOGIN_LIMITER_H
+#define LOGIN_LIMITER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+
+#include <atomic>
+
+/**
+ * @brief Budgets the password derivations clients can trigger through /login and /changepass.
+ *
+ * @details Attempts are counted per IPID and per hardware ID. The first #FREE_ATTEMPTS attempts within
+ * #RESET_INTERVAL are free; every attempt after that locks the IPID and hardware ID out for twice as long as the
+ * previous one, starting at #BASE_BACKOFF and capped at #MAX_BACKOFF. A successful login clears both records.
+ *
+ * On top of that, no more than #MAX_IN_FLIGHT derivations may run at once, no matter who asked for them.
+ *
+ * Rejected attempts are reported as a warning at most once every #REPORT_INTERVAL, with the running total and the
+ * keys that were rejected the most since the last report.
+ *
+ * admit() and succeeded() must be called from the thread owning the Server. release() may be called from any thread.
+ */
+class LoginLimiter
+{
+  public:
+    /**
+     * @brief The outcome of an attempt.
+     */
+    enum class Verdict
+    {
+        Admitted,  //!< The attempt may go ahead. release() must be called once its derivation has finished.
+        LockedOut, //!< The IPID or hardware ID has used up its budget.
+        Busy       //!< Too many derivations are already running.
+    };
+
+    /**
+     * @brief Creates a limiter with no recorded attempts.
+     */
+    LoginLimiter();
+
+    /**
+     * @brief Records an attempt by the given client, unless it is rejected.
+     *
+     * @param f_ipid The IPID of the client.
+     * @param f_hwid The hardware ID of the client. May be empty.
+     * @param f_retry_after If not null and the client is locked out, set to the milliseconds until it may try again.
+     */
+    Verdict admit(const QString &f_ipid, const QString &f_hwid, qint64 *f_retry_after = nullptr);
+
+    /**
+     * @brief Marks an admitted derivation as finished. Safe to call from any thread.
+     */
+    void release();
+
+    /**
+     * @brief Clears the attempts of a client that logged in successfully.
+     */
+    void succeeded(const QString &f_ipid, const QString &f_hwid);
+
+  private:
+    /**
+     * @brief Attempts that do not lead to a lockout.
+     */
+    static constexpr int FREE_ATTEMPTS = 5;
+
+    /**
+     * @brief The lockout, in milliseconds, after the first attempt over the budget.
+     */
+    static constexpr qint64 BASE_BACKOFF = 1000;
+
+    /**
+     * @brief The longest lockout, in milliseconds.
+     */
+    static constexpr qint64 MAX_BACKOFF = 300000;
+
+    /**
+     * @brief How long, in milliseconds, a record is kept after its last attempt.
+     */
+    static constexpr qint64 RESET_INTERVAL = 900000;
+
+    /**
+     * @brief The maximum amount of derivations running at the same time.
+     */
+    static constexpr int MAX_IN_FLIGHT = 4;
+
+    /**
+     * @brief The minimum time, in milliseconds, between two reports of rejected attempts.
+     */
+    static constexpr qint64 REPORT_INTERVAL = 60000;
+
+    /**
+     * @brief The maximum amount of keys listed in a report.
+     */
+    static constexpr int REPORT_MAX_KEYS = 10;
+
+    /**
+     * @brief The attempts of a single IPID or hardware ID.
+     */
+    struct Record
+    {
+        int attempts = 0;        //!< Admitted attempts since the record was created.
+        qint64 last_attempt = 0; //!< When the last attempt was admitted.
+        qint64 locked_until = 0; //!< Attempts before this time are rejected.
+        int rejected = 0;        //!< Attempts rejected during a lockout since the last report.
+    };
+
+    /**
+     * @brief Returns the record keys of a client. IPIDs and hardware IDs are prefixed so they cannot collide.
+     */
+    static QStringList keysOf(const QString &f_ipid, const QString &f_hwid);
+
+    /**
+     * @brief Removes records whose last attempt is older than #RESET_INTERVAL.
+     */
+    void prune(qint64 f_now);
+
+    /**
+     * @brief Logs the rejected attempts since the last report, unless that report is less than #REPORT_INTERVAL old.
+     */
+    void report(qint64 f_now);
+
+    /**
+     * @brief The monotonic clock all timestamps are relative to.
+     */
+    QElapsedTimer m_clock;
+
+    /**
+     * @brief Recent attempts, keyed by prefixed IPID or hardware ID.
+     */
+    QHash<QString, Record> m_records;
+
+    /**
+     * @brief Derivations that were admitted and have not been released yet.
+     */
+    std::atomic<int> m_in_flight{0};
+
+    /**
+     * @brief Attempts rejected since the server started.
+     */
+    quint64 m_rejected = 0;
+
+    /**
+     * @brief The value of #m_rejected at the last report.
+     */
+    quint64 m_reported = 0;
+
+    /**
+     * @brief When the records were last pruned.
+     */
+    qint64 m_last_prune = 0;
+
+    /**
+     * @brief When rejected attempts were last reported.
+     */
+    qint64 m_last_report = 0;
+};
+
+#endif // LOGIN_LIMITER_H
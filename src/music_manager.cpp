@@ -20,13 +20,36 @@ QStringList MusicManager::musiclist(int f_area_id)
 {
     if (m_global_enabled.value(f_area_id)) {
         QStringList l_combined_list = m_root_ordered;
-        l_combined_list.append(m_customs_ordered.value(f_area_id));
+        auto l_customs = m_customs_ordered.constFind(f_area_id);
+        if (l_customs != m_customs_ordered.constEnd())
+            l_combined_list.append(l_customs->entries());
         return l_combined_list;
     }
 
     return m_custom_lists->value(f_area_id);
 }
 
+std::shared_ptr<AOPacket> MusicManager::musiclistPacket(int f_area_id)
+{
+    CachedList &l_cached = m_cached_lists[f_area_id];
+    if (l_cached.packet)
+        return l_cached.packet;
+
+    auto l_customs = m_customs_ordered.constFind(f_area_id);
+    const bool l_root_only = m_global_enabled.value(f_area_id) && (l_customs == m_customs_ordered.constEnd() || l_customs->isEmpty());
+    if (l_root_only) {
+        if (!m_root_packet)
+            m_root_packet = PacketFactory::createPacket("FM", m_root_ordered);
+        l_cached.packet = m_root_packet;
+    }
+    else
+        l_cached.packet = PacketFactory::createPacket("FM", musiclist(f_area_id));
+
+    return l_cached.packet;
+}
+
+quint64 MusicManager::musiclistVersion(int f_area_id) const { return m_cached_lists.value(f_area_id).version; }
+
 QStringList MusicManager::rootMusiclist() { return m_root_ordered; }
 
 bool MusicManager::registerArea(int f_area_id)
@@ -37,6 +60,7 @@ bool MusicManager::registerArea(int f_area_id)
 
     m_custom_lists->insert(f_area_id, {});
     m_global_enabled.insert(f_area_id, true);
+    invalidate(f_area_id);
     return true;
 }
 
@@ -93,17 +117,19 @@ bool MusicManager::addCustomSong(QString f_song_name, int f_area_id, bool f_serv
     if (m_custom_lists->value(f_area_id).contains(f_song_name))
         return false;
 
-    if (m_customs_ordered.value(f_area_id).contains(l_song_name))
+    Catalog &l_customs_ordered = m_customs_ordered[f_area_id];
+    if (l_customs_ordered.contains(l_song_name))
         return false;
 
     // There should be a way to directly insert into the QMap. Too bad!
     QStringList l_custom_list = m_custom_lists->value(f_area_id);
     l_custom_list.append(l_song_name);
     m_custom_lists->insert(f_area_id, l_custom_list);
-    m_customs_ordered.insert(f_area_id, (QStringList{m_customs_ordered.value(f_area_id)} << l_song_name));
+    l_customs_ordered.append(l_song_name);
+    invalidate(f_area_id);
 
     if (!f_server_starting)
-        emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
+        emit sendAreaFMPacket(musiclistPacket(f_area_id), f_area_id);
 
     return true;
 }
@@ -127,10 +153,11 @@ bool MusicManager::addCustomCategory(QString f_category_name, int f_area_id, boo
     QStringList l_custom_list = m_custom_lists->value(f_area_id);
     l_custom_list.append(l_category_name);
     m_custom_lists->insert(f_area_id, l_custom_list);
-    m_customs_ordered.insert(f_area_id, (QStringList{m_customs_ordered.value(f_area_id)} << l_category_name));
+    m_customs_ordered[f_area_id].append(l_category_name);
+    invalidate(f_area_id);
 
     if (!f_server_starting)
-        emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
+        emit sendAreaFMPacket(musiclistPacket(f_area_id), f_area_id);
 
     return true;
 }
@@ -144,11 +171,10 @@ bool MusicManager::removeCategorySong(QString f_songcategory_name, int f_area_id
             m_custom_lists->insert(f_area_id, l_custom_list);
 
             // Updating the list alias too.
-            QStringList l_customs_ordered = m_customs_ordered.value(f_area_id);
-            l_customs_ordered.removeAll(f_songcategory_name);
-            m_customs_ordered.insert(f_area_id, l_customs_ordered);
+            m_customs_ordered[f_area_id].removeAll(f_songcategory_name);
+            invalidate(f_area_id);
 
-            emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
+            emit sendAreaFMPacket(musiclistPacket(f_area_id), f_area_id);
             return true;
         } // Fallthrough
     }
@@ -160,15 +186,16 @@ bool MusicManager::toggleRootEnabled(int f_area_id)
     m_global_enabled.insert(f_area_id, !m_global_enabled.value(f_area_id));
     if (m_global_enabled.value(f_area_id))
         sanitiseCustomList(f_area_id);
+    invalidate(f_area_id);
 
-    emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
+    emit sendAreaFMPacket(musiclistPacket(f_area_id), f_area_id);
     return m_global_enabled.value(f_area_id);
 }
 
 void MusicManager::sanitiseCustomList(int f_area_id)
 {
     QStringList l_sanitised_list;
-    QStringList l_sanitised_ordered = m_customs_ordered.value(f_area_id);
+    Catalog &l_sanitised_ordered = m_customs_ordered[f_area_id];
     const QStringList l_list = m_custom_lists->value(f_area_id);
     for (const QString &l_music : l_list)
         if (!m_root_list.contains(l_music))
@@ -177,24 +204,22 @@ void MusicManager::sanitiseCustomList(int f_area_id)
             l_sanitised_ordered.removeAll(l_music);
 
     m_custom_lists->insert(f_area_id, l_sanitised_list);
-    m_customs_ordered.insert(f_area_id, l_sanitised_ordered);
+    invalidate(f_area_id);
 }
 
 void MusicManager::clearCustomList(int f_area_id)
 {
     m_custom_lists->remove(f_area_id);
     m_custom_lists->insert(f_area_id, {});
-    m_customs_ordered.remove(f_area_id);
-    m_customs_ordered.insert(f_area_id, {});
-    emit sendAreaFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_id)), f_area_id);
+    m_customs_ordered.insert(f_area_id, Catalog());
+    invalidate(f_area_id);
+    emit sendAreaFMPacket(musiclistPacket(f_area_id), f_area_id);
 }
 
 bool MusicManager::isCustom(int f_area_id, QString f_song_name)
 {
-    if (m_customs_ordered.value(f_area_id).contains(f_song_name, Qt::CaseInsensitive))
-        return true;
-
-    return false;
+    auto l_customs = m_customs_ordered.constFind(f_area_id);
+    return l_customs != m_customs_ordered.constEnd() && l_customs->contains(f_song_name, Qt::CaseInsensitive);
 }
 
 void MusicManager::setCustomMusicList(QStringList f_music_list, int f_area)
@@ -208,11 +233,22 @@ void MusicManager::setCustomMusicList(QStringList f_music_list, int f_area)
 
 QStringList MusicManager::getCustomMusicList(int f_area) { return m_custom_lists->value(f_area); }
 
-void MusicManager::reloadRequest()
+void MusicManager::reloadRequest(QStringList f_root_ordered)
 {
-    m_root_list = ConfigManager::musiclist();
-    m_root_ordered = ConfigManager::ordered_songs();
     m_cdns = ConfigManager::cdnList();
+    if (f_root_ordered == m_root_ordered)
+        return;
+
+    m_root_ordered = f_root_ordered;
+    m_root_packet.reset();
+
+    // Areas with the root musiclist disabled only list their custom songs, their packet stays valid.
+    const QList<int> l_area_ids = m_cached_lists.keys();
+    for (int l_area_id : l_area_ids)
+        if (m_global_enabled.value(l_area_id))
+            invalidate(l_area_id);
 }
 
-void MusicManager::userJoinedArea(int f_area_index, int f_user_id) { emit sendFMPacket(PacketFactory::createPacket("FM", musiclist(f_area_index)), f_user_id); }
+void MusicManager::userJoinedArea(int f_area_index, int f_user_id) { emit sendFMPacket(musiclistPacket(f_area_index), f_user_id); }
+
+void MusicManager::invalidate(int f_area_id) { m_cached_lists.insert(f_area_id, CachedList{++m_last_version, nullptr}); }
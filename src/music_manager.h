@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QPair>
 
+#include "catalog.h"
 #include "network/aopacket.h"
 
 class ConfigManager;
@@ -51,6 +52,20 @@ class MusicManager : public QObject
      */
     QStringList musiclist(int f_area_id);
 
+    /**
+     * @brief Returns the FM packet of the musiclist of an area.
+     *
+     * @details The packet is built on first use and kept until the musiclist of the area changes, so joining an
+     * area or resending its list never encodes the list again. Areas listing just the root musiclist all share
+     * the same packet.
+     */
+    std::shared_ptr<AOPacket> musiclistPacket(int f_area_id);
+
+    /**
+     * @brief Returns the version of the musiclist of an area, which changes whenever the list does.
+     */
+    quint64 musiclistVersion(int f_area_id) const;
+
     /**
      * @brief Returns only the root musiclist with aliased names.
      *
@@ -152,8 +167,10 @@ class MusicManager : public QObject
 
     /**
      * @brief Updates the root musiclist and CDN list.
+     *
+     * @param f_root_ordered The new root musiclist, as returned by ConfigManager::loadMusicList().
      */
-    void reloadRequest();
+    void reloadRequest(QStringList f_root_ordered);
 
     /**
      * @brief Triggers sending of FM packet to client joining a new area.
@@ -181,6 +198,20 @@ class MusicManager : public QObject
     void sendAreaFMPacket(std::shared_ptr<AOPacket> f_packet, int f_area_index);
 
   private:
+    /**
+     * @brief The cached FM packet of an area.
+     */
+    struct CachedList
+    {
+        quint64 version = 0;
+        std::shared_ptr<AOPacket> packet; //!< Null until the list of this version is first requested.
+    };
+
+    /**
+     * @brief Drops the cached FM packet of an area and gives its musiclist a new version.
+     */
+    void invalidate(int f_area_id);
+
     /**
      * @brief Contains all custom lists of all areas in the server.
      */
@@ -189,7 +220,7 @@ class MusicManager : public QObject
     /**
      * @brief Server musiclist shared among all areas.
      */
-    QStringList m_root_list;
+    Catalog m_root_list;
 
     /**
      * @brief QList with the ordered musiclist.
@@ -199,13 +230,28 @@ class MusicManager : public QObject
     /**
      * @brief Contains all custom songs ordered in a per-area buffer.
      */
-    QMap<int, QStringList> m_customs_ordered;
+    QMap<int, Catalog> m_customs_ordered;
 
     /**
      * @brief whether the global musiclist is prepend and validation when adding custom music.
      */
     QHash<int, bool> m_global_enabled;
 
+    /**
+     * @brief The cached FM packet of every area, see musiclistPacket().
+     */
+    QHash<int, CachedList> m_cached_lists;
+
+    /**
+     * @brief The FM packet shared by all areas listing just the root musiclist.
+     */
+    std::shared_ptr<AOPacket> m_root_packet;
+
+    /**
+     * @brief The last version handed out to a musiclist.
+     */
+    quint64 m_last_version = 0;
+
     /**
      * @brief Contains all server approved content sources.
      */
@@ -16,6 +16,7 @@
 //    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
 //////////////////////////////////////////////////////////////////////////////////////
 #include "network/aopacket.h"
+#include "network/frame_tokenizer.h"
 
 #include "packet/packet_askchaa.h"
 #include "packet/packet_casea.h"
@@ -50,60 +51,142 @@ AOPacket::AOPacket(QStringList p_contents) :
 
 AOPacket::~AOPacket() {}
 
-const QStringList AOPacket::getContent() { return m_content; }
+const QStringList AOPacket::getContent() const
+{
+    loadRawContent();
+    return m_content;
+}
+
+QString AOPacket::field(int f_index) const
+{
+    if (f_index < 0 || f_index >= m_content.size())
+        return QString();
+
+    if (f_index < m_raw_fields.size() && !m_raw_fields.at(f_index).isNull()) {
+        m_content[f_index] = FrameTokenizer::unescape(m_raw_fields.at(f_index));
+        m_raw_fields[f_index] = QStringView();
+    }
+
+    return m_content.at(f_index);
+}
+
+int AOPacket::fieldCount() const { return m_content.size(); }
+
+void AOPacket::setRawContent(const QString &f_frame, const QList<QStringView> &f_fields)
+{
+    m_raw_frame = f_frame;
+    m_raw_fields = f_fields;
+    m_content = QStringList();
+    m_content.resize(f_fields.size());
+    setPacketEscaped(false);
+    invalidateFrame();
+}
+
+void AOPacket::loadRawContent() const
+{
+    for (int i = 0; i < m_raw_fields.size(); i++)
+        field(i);
 
-QString AOPacket::toString()
+    m_raw_fields.clear();
+    m_raw_frame.clear();
+}
+
+QString AOPacket::toString() const
 {
-    if (!isPacketEscaped() && !(getPacketInfo().header == "LE"))
-        // We will never send unescaped data to a client, unless its evidence.
-        this->escapeContent();
-    else
-        // Of course AO has SOME expection to the rule.
-        this->escapeEvidence();
-
-    return QString("%1#%2#%3").arg(getPacketInfo().header, m_content.join("#"), packetFinished);
+    if (!m_frame.isNull())
+        return m_frame;
+
+    loadRawContent();
+
+    // We will never send unescaped data to a client, unless its evidence.
+    // Of course AO has SOME expection to the rule.
+    const bool l_evidence = isPacketEscaped() || getPacketInfo().header == "LE";
+
+    QString l_frame = getPacketInfo().header;
+    l_frame.append('#');
+    for (int i = 0; i < m_content.size(); i++) {
+        if (i > 0)
+            l_frame.append('#');
+        l_frame.append(escapeField(m_content.at(i), l_evidence));
+    }
+    l_frame.append('#');
+    l_frame.append(packetFinished);
+
+    m_frame = l_frame;
+    return m_frame;
 }
 
-QByteArray AOPacket::toUtf8()
+QByteArray AOPacket::toUtf8() const
 {
-    QString l_packet = this->toString();
-    return l_packet.toUtf8();
+    if (m_frame_utf8.isNull())
+        m_frame_utf8 = toString().toUtf8();
+
+    return m_frame_utf8;
 }
 
-void AOPacket::setContentField(int f_content_index, QString f_content_data) { m_content[f_content_index] = f_content_data; }
+void AOPacket::setContentField(int f_content_index, QString f_content_data)
+{
+    loadRawContent();
+    m_content[f_content_index] = f_content_data;
+    invalidateFrame();
+}
+
+void AOPacket::invalidateFrame()
+{
+    m_frame = QString();
+    m_frame_utf8 = QByteArray();
+}
+
+QString AOPacket::escapeField(QString f_field, bool f_evidence)
+{
+    f_field.replace("#", "<num>")
+        .replace("%", "<percent>")
+        .replace("$", "<dollar>");
+
+    if (!f_evidence)
+        f_field.replace("&", "<and>");
+
+    return f_field;
+}
 
 void AOPacket::escapeContent()
 {
+    loadRawContent();
     m_content.replaceInStrings("#", "<num>")
         .replaceInStrings("%", "<percent>")
         .replaceInStrings("$", "<dollar>")
         .replaceInStrings("&", "<and>");
 
     this->setPacketEscaped(true);
+    invalidateFrame();
 }
 
 void AOPacket::unescapeContent()
 {
+    loadRawContent();
     m_content.replaceInStrings("<num>", "#")
         .replaceInStrings("<percent>", "%")
         .replaceInStrings("<dollar>", "$")
         .replaceInStrings("<and>", "&");
 
     this->setPacketEscaped(false);
+    invalidateFrame();
 }
 
 void AOPacket::escapeEvidence()
 {
+    loadRawContent();
     m_content.replaceInStrings("#", "<num>")
         .replaceInStrings("%", "<percent>")
         .replaceInStrings("$", "<dollar>");
 
     this->setPacketEscaped(true);
+    invalidateFrame();
 }
 
 void AOPacket::setPacketEscaped(bool f_packet_state) { m_escaped = f_packet_state; }
 
-bool AOPacket::isPacketEscaped() { return m_escaped; }
+bool AOPacket::isPacketEscaped() const { return m_escaped; }
 
 void AOPacket::registerPackets()
 {
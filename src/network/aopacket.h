@@ -22,6 +22,7 @@
 #include <QDebug>
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 
 #include "aoclient.h"
 #include "area_data.h"
@@ -48,26 +49,63 @@ class AOPacket
     /**
      * @brief Returns the current content of the packet
      *
+     * @details Unescapes every field that has not been read yet.
+     *
      * @return The content of the packet.
      */
-    const QStringList getContent();
+    const QStringList getContent() const;
+
+    /**
+     * @brief Returns a single field of the packet.
+     *
+     * @details Fields of packets received from a client are only unescaped the first time they are read.
+     *
+     * @param f_index The index of the field.
+     *
+     * @return The field, or an empty string if the packet has no such field.
+     */
+    QString field(int f_index) const;
+
+    /**
+     * @brief Returns the amount of fields in the packet.
+     */
+    int fieldCount() const;
+
+    /**
+     * @brief Replaces the content of the packet with the fields of a frame received from a client.
+     *
+     * @details The fields are kept as views into the frame and are unescaped lazily by field() and getContent().
+     *
+     * @param f_frame The frame the fields are located in. The packet keeps a reference to it.
+     * @param f_fields Views of the escaped fields, pointing into f_frame.
+     *
+     * @see FrameTokenizer
+     */
+    void setRawContent(const QString &f_frame, const QList<QStringView> &f_fields);
 
     /**
-     * @brief Converts the header and content into a single string.
+     * @brief Converts the header and content into a single, escaped wire frame.
+     *
+     * @details The frame is built the first time it is requested and then reused, so a packet broadcast
+     * to many clients is only joined and escaped once. The content of the packet itself is left untouched.
      *
      * @return String converted packet.
      */
-    QString toString();
+    QString toString() const;
 
     /**
      * @brief Converts the entire packet, header and content, to a UTF8 formatted ByteArray.
      *
+     * @details Like toString(), the encoded frame is cached after the first call.
+     *
      * @return A UTF-8 representation of the packet.
      */
-    QByteArray toUtf8();
+    QByteArray toUtf8() const;
 
     /**
      * @brief Allows editing of the content inside the packet on a per-field basis.
+     *
+     * @details Discards any frame that was already serialized from the previous content.
      */
     void setContentField(int f_content_index, QString f_content_data);
 
@@ -109,7 +147,7 @@ class AOPacket
      *
      * @return If true, the packet is escaped. If false, it is unescaped and plain text.
      */
-    bool isPacketEscaped();
+    bool isPacketEscaped() const;
 
     virtual PacketInfo getPacketInfo() const = 0;
     virtual void handlePacket(AreaData *area, AOClient &client) const = 0;
@@ -119,8 +157,16 @@ class AOPacket
   protected:
     /**
      * @brief The contents of the packet.
+     *
+     * @details For packets received from a client, fields are filled in on first access.
+     * Prefer field() and fieldCount() over accessing this directly.
+     */
+    mutable QStringList m_content;
+
+    /**
+     * @brief Drops the cached wire frame. Must be called whenever #m_content is modified.
      */
-    QStringList m_content;
+    void invalidateFrame();
 
     /**
      * @brief whether the packet is currently escaped or not. If false, the packet is unescaped.
@@ -133,6 +179,44 @@ class AOPacket
      * @details Note : This is due to AOs inability to determine the packet length, making it read forever otherwise.
      */
     const QString packetFinished = "%";
+
+  private:
+    /**
+     * @brief Unescapes every field that is still only available as a view into #m_raw_frame.
+     */
+    void loadRawContent() const;
+
+    /**
+     * @brief The frame received from the client, kept alive for #m_raw_fields.
+     */
+    mutable QString m_raw_frame;
+
+    /**
+     * @brief Escaped fields of #m_raw_frame that have not been unescaped into #m_content yet.
+     *
+     * @details A null view marks a field that has already been loaded.
+     */
+    mutable QList<QStringView> m_raw_fields;
+
+    /**
+     * @brief Escapes a single field for the wire without modifying the packet.
+     *
+     * @param f_field The field to escape.
+     * @param f_evidence If true, the `&` separator used by evidence is left as is.
+     *
+     * @return The escaped field.
+     */
+    static QString escapeField(QString f_field, bool f_evidence);
+
+    /**
+     * @brief The escaped wire frame, built on the first call to toString().
+     */
+    mutable QString m_frame;
+
+    /**
+     * @brief The UTF-8 encoded wire frame, built on the first call to toUtf8().
+     */
+    mutable QByteArray m_frame_utf8;
 };
 
 #endif // PACKET_MANAGER_H
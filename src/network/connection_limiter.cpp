@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "network/connection_limiter.h"
+
+ConnectionLimiter::ConnectionLimiter() { m_clock.start(); }
+
+void ConnectionLimiter::setLimits(int f_address_rate, int f_subnet_rate, int f_global_rate)
+{
+    m_address_rate = qMax(f_address_rate, 0);
+    m_subnet_rate = qMax(f_subnet_rate, 0);
+    m_global_rate = qMax(f_global_rate, 0);
+
+    // Start over with full buckets, the old ones were filled for different capacities.
+    m_address_buckets.clear();
+    m_subnet_buckets.clear();
+    m_global_bucket = Bucket{double(m_global_rate), m_clock.elapsed()};
+}
+
+bool ConnectionLimiter::admit(const QHostAddress &f_address)
+{
+    const qint64 l_now = m_clock.elapsed();
+    if (l_now - m_last_prune > 60000)
+        prune(l_now);
+
+    const bool l_is_local = f_address.isLoopback();
+    Bucket *l_address_bucket = nullptr;
+    Bucket *l_subnet_bucket = nullptr;
+
+    if (m_global_rate > 0) {
+        refill(m_global_bucket, m_global_rate, 1000, l_now);
+        if (m_global_bucket.tokens < 1)
+            return false;
+    }
+
+    if (m_address_rate > 0 && !l_is_local) {
+        auto l_it = m_address_buckets.find(f_address);
+        if (l_it == m_address_buckets.end())
+            l_it = m_address_buckets.insert(f_address, Bucket{double(m_address_rate), l_now});
+
+        l_address_bucket = &l_it.value();
+        refill(*l_address_bucket, m_address_rate, 60000, l_now);
+        if (l_address_bucket->tokens < 1)
+            return false;
+    }
+
+    if (m_subnet_rate > 0 && !l_is_local) {
+        const QHostAddress l_subnet = subnetOf(f_address);
+        auto l_it = m_subnet_buckets.find(l_subnet);
+        if (l_it == m_subnet_buckets.end())
+            l_it = m_subnet_buckets.insert(l_subnet, Bucket{double(m_subnet_rate), l_now});
+
+        l_subnet_bucket = &l_it.value();
+        refill(*l_subnet_bucket, m_subnet_rate, 60000, l_now);
+        if (l_subnet_bucket->tokens < 1)
+            return false;
+    }
+
+    // Tokens are only taken once every bucket agreed, so a rejected connection costs nothing.
+    if (m_global_rate > 0)
+        m_global_bucket.tokens -= 1;
+    if (l_address_bucket != nullptr)
+        l_address_bucket->tokens -= 1;
+    if (l_subnet_bucket != nullptr)
+        l_subnet_bucket->tokens -= 1;
+
+    return true;
+}
+
+QHostAddress ConnectionLimiter::subnetOf(const QHostAddress &f_address)
+{
+    bool l_ok;
+    const quint32 l_ipv4 = f_address.toIPv4Address(&l_ok);
+    if (l_ok)
+        return QHostAddress(l_ipv4 & 0xFFFFFF00);
+
+    Q_IPV6ADDR l_ipv6 = f_address.toIPv6Address();
+    for (int i = 6; i < 16; i++)
+        l_ipv6[i] = 0;
+
+    return QHostAddress(l_ipv6);
+}
+
+void ConnectionLimiter::refill(Bucket &f_bucket, int f_rate, qint64 f_period, qint64 f_now)
+{
+    f_bucket.tokens = qMin(double(f_rate), f_bucket.tokens + double(f_now - f_bucket.updated) * f_rate / f_period);
+    f_bucket.updated = f_now;
+}
+
+void ConnectionLimiter::prune(qint64 f_now)
+{
+    m_last_prune = f_now;
+
+    for (auto l_it = m_address_buckets.begin(); l_it != m_address_buckets.end();) {
+        refill(l_it.value(), m_address_rate, 60000, f_now);
+        if (l_it.value().tokens >= m_address_rate)
+            l_it = m_address_buckets.erase(l_it);
+        else
+            ++l_it;
+    }
+
+    for (auto l_it = m_subnet_buckets.begin(); l_it != m_subnet_buckets.end();) {
+        refill(l_it.value(), m_subnet_rate, 60000, f_now);
+        if (l_it.value().tokens >= m_subnet_rate)
+            l_it = m_subnet_buckets.erase(l_it);
+        else
+            ++l_it;
+    }
+}
@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef CONNECTION_LIMITER_H
+#define CONNECTION_LIMITER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+
+/**
+ * @brief Decides whether a new connection is admitted, before any client or database work is done for it.
+ *
+ * @details Every connection takes a token from three token buckets: one for its address, one for its /24 (IPv4) or
+ * /48 (IPv6) subnet and one shared by all connections. A connection is only admitted if all three buckets have a
+ * token left. Buckets refill continuously and are kept in memory only.
+ */
+class ConnectionLimiter
+{
+  public:
+    /**
+     * @brief Creates a limiter that admits every connection until setLimits() is called.
+     */
+    ConnectionLimiter();
+
+    /**
+     * @brief Sets the refill rates of the buckets. A rate of 0 disables the respective bucket.
+     *
+     * @details The capacity of each bucket equals its rate, so a full bucket allows a short burst of that many connections.
+     *
+     * @param f_address_rate Connections per minute from a single address.
+     * @param f_subnet_rate Connections per minute from a single /24 or /48 subnet.
+     * @param f_global_rate Connections per second from anywhere.
+     */
+    void setLimits(int f_address_rate, int f_subnet_rate, int f_global_rate);
+
+    /**
+     * @brief Takes a token for a connection from the given address.
+     *
+     * @details Loopback addresses are only subject to the global bucket.
+     *
+     * @return True if the connection should be accepted.
+     */
+    bool admit(const QHostAddress &f_address);
+
+  private:
+    /**
+     * @brief The state of a single token bucket.
+     */
+    struct Bucket
+    {
+        double tokens = 0;  //!< The amount of connections the bucket still allows.
+        qint64 updated = 0; //!< When #tokens was last refilled, in milliseconds since the limiter was created.
+    };
+
+    /**
+     * @brief Returns the /24 or /48 subnet the address belongs to.
+     */
+    static QHostAddress subnetOf(const QHostAddress &f_address);
+
+    /**
+     * @brief Refills a bucket up to its capacity.
+     *
+     * @param f_rate The capacity of the bucket, refilled once per f_period milliseconds.
+     */
+    static void refill(Bucket &f_bucket, int f_rate, qint64 f_period, qint64 f_now);
+
+    /**
+     * @brief Removes buckets that are full again and therefore indistinguishable from new ones.
+     */
+    void prune(qint64 f_now);
+
+    /**
+     * @brief The monotonic clock all bucket timestamps are relative to.
+     */
+    QElapsedTimer m_clock;
+
+    /**
+     * @brief The buckets of addresses that connected recently.
+     */
+    QHash<QHostAddress, Bucket> m_address_buckets;
+
+    /**
+     * @brief The buckets of subnets that connected recently, keyed by their network address.
+     */
+    QHash<QHostAddress, Bucket> m_subnet_buckets;
+
+    /**
+     * @brief The bucket shared by all connections.
+     */
+    Bucket m_global_bucket;
+
+    /**
+     * @brief Connections per minute allowed from a single address.
+     */
+    int m_address_rate = 0;
+
+    /**
+     * @brief Connections per minute allowed from a single subnet.
+     */
+    int m_subnet_rate = 0;
+
+    /**
+     * @brief Connections per second allowed in total.
+     */
+    int m_global_rate = 0;
+
+    /**
+     * @brief When the buckets were last pruned.
+     */
+    qint64 m_last_prune = 0;
+};
+
+#endif // CONNECTION_LIMITER_H
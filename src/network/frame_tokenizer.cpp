@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "network/frame_tokenizer.h"
+
+#include <QDebug>
+
+qsizetype FrameTokenizer::utf8Length(char16_t f_unit)
+{
+    if (f_unit < 0x80)
+        return 1;
+    if (f_unit < 0x800)
+        return 2;
+    if (QChar::isHighSurrogate(f_unit))
+        return 4;
+    if (QChar::isLowSurrogate(f_unit))
+        return 0;
+    return 3;
+}
+
+FrameTokenizer::Status FrameTokenizer::tokenize(QStringView f_frame, QList<RawPacket> &f_packets)
+{
+    qsizetype l_frame_bytes = 0;
+    qsizetype l_segment_start = 0;
+    qsizetype l_content_size = 0;
+    bool l_has_header = false;
+    bool l_first_packet = true;
+    RawPacket l_packet;
+
+    for (qsizetype i = 0; i < f_frame.size(); i++) {
+        const char16_t l_unit = f_frame[i].unicode();
+        l_frame_bytes += utf8Length(l_unit);
+        if (l_frame_bytes > MAX_FRAME_BYTES)
+            return Status::FRAME_TOO_LARGE;
+
+        if (l_unit == u'#') {
+            QStringView l_segment = f_frame.sliced(l_segment_start, i - l_segment_start);
+            if (l_has_header) {
+                l_packet.fields.append(l_segment);
+                l_content_size += l_segment.size();
+            }
+            else {
+                l_packet.header = l_segment;
+                l_has_header = true;
+            }
+            l_segment_start = i + 1;
+            continue;
+        }
+
+        if (l_unit != u'%')
+            continue;
+
+        // Anything between the last delimiter and the terminator is not part of the content.
+        if (!l_has_header)
+            l_packet.header = f_frame.sliced(l_segment_start, i - l_segment_start);
+        const bool l_is_empty = l_packet.header.isEmpty() && !l_has_header;
+
+        if (!l_is_empty) {
+            const bool l_is_music = l_first_packet && l_packet.header.startsWith(u"MC", Qt::CaseInsensitive);
+            l_first_packet = false;
+
+            if (l_packet.header.isEmpty())
+                qDebug() << "FantaCrypt or otherwise invalid packet received.";
+            else if (l_content_size > MAX_CONTENT_SIZE)
+                qDebug() << "Oversized packet received:" << l_packet.header;
+            else
+                f_packets.append(l_packet);
+
+            // Music changes are never batched with other packets.
+            if (l_is_music)
+                return Status::OK;
+        }
+
+        l_packet = RawPacket();
+        l_has_header = false;
+        l_content_size = 0;
+        l_segment_start = i + 1;
+    }
+
+    // Data after the last terminator is an incomplete packet and gets discarded.
+    return Status::OK;
+}
+
+QString FrameTokenizer::unescape(QStringView f_field)
+{
+    qsizetype l_escape = f_field.indexOf(u'<');
+    if (l_escape == -1)
+        return f_field.toString();
+
+    static const struct
+    {
+        QStringView code;
+        QChar character;
+    } l_codes[] = {
+        {u"<num>", u'#'},
+        {u"<percent>", u'%'},
+        {u"<dollar>", u'$'},
+        {u"<and>", u'&'},
+    };
+
+    QString l_result;
+    l_result.reserve(f_field.size());
+    qsizetype l_copied = 0;
+    while (l_escape != -1) {
+        QStringView l_rest = f_field.sliced(l_escape);
+        qsizetype l_next = l_escape + 1;
+        for (const auto &l_code : l_codes) {
+            if (l_rest.startsWith(l_code.code)) {
+                l_result.append(f_field.sliced(l_copied, l_escape - l_copied));
+                l_result.append(l_code.character);
+                l_copied = l_escape + l_code.code.size();
+                l_next = l_copied;
+                break;
+            }
+        }
+        l_escape = f_field.indexOf(u'<', l_next);
+    }
+    l_result.append(f_field.sliced(l_copied));
+
+    return l_result;
+}
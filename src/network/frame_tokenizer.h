@@ -0,0 +1,90 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef FRAME_TOKENIZER_H
+#define FRAME_TOKENIZER_H
+
+#include <QList>
+#include <QStringView>
+
+/**
+ * @brief Splits a websocket frame received from a client into AO packets.
+ *
+ * @details The frame is scanned exactly once. Instead of copying each packet and field into their own strings,
+ * the tokenizer only records views into the original frame, which means the frame has to outlive the result.
+ * Size limits are enforced during the same scan.
+ */
+class FrameTokenizer
+{
+  public:
+    /**
+     * @brief A single packet located inside a frame.
+     */
+    struct RawPacket
+    {
+        QStringView header;        //!< The header of the packet.
+        QList<QStringView> fields; //!< The escaped fields of the packet, without the trailing segment.
+    };
+
+    /**
+     * @brief The result of tokenizing a frame.
+     */
+    enum class Status
+    {
+        OK,             //!< The frame was tokenized. Oversized or malformed packets have been skipped.
+        FRAME_TOO_LARGE //!< The frame exceeds #MAX_FRAME_BYTES and the connection should be closed.
+    };
+
+    /**
+     * @brief The maximum size of a single frame, in UTF-8 encoded bytes.
+     */
+    static constexpr qsizetype MAX_FRAME_BYTES = 30720;
+
+    /**
+     * @brief The maximum combined size of the fields of a single packet. Larger packets are dropped.
+     */
+    static constexpr qsizetype MAX_CONTENT_SIZE = 16384;
+
+    /**
+     * @brief Tokenizes a frame into packets.
+     *
+     * @param f_frame The frame as received from the websocket.
+     * @param f_packets The list the found packets are appended to.
+     *
+     * @return Status::FRAME_TOO_LARGE if the frame is oversized, Status::OK otherwise.
+     */
+    static Status tokenize(QStringView f_frame, QList<RawPacket> &f_packets);
+
+    /**
+     * @brief Unescapes a single field using AO2's escape codes.
+     *
+     * @details All escape codes are replaced in one pass. Fields without any escape codes are copied as is.
+     *
+     * @see https://github.com/AttorneyOnline/docs/blob/master/AO%20Documentation/docs/development/network.md#escape-codes
+     */
+    static QString unescape(QStringView f_field);
+
+  private:
+    /**
+     * @brief Returns how many bytes the UTF-16 code unit takes up once encoded as UTF-8.
+     *
+     * @details Surrogate pairs are counted as four bytes on the high surrogate.
+     */
+    static qsizetype utf8Length(char16_t f_unit);
+};
+
+#endif // FRAME_TOKENIZER_H
@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief An unbounded, lock-free queue with any number of producers and a single consumer.
+ *
+ * @details Used to hand packets and frames between the game thread and the network threads.
+ * push() may be called from any thread, pop() only from the thread consuming the queue.
+ *
+ * @tparam T The item type. Must be default constructible and movable.
+ */
+template <typename T>
+class MpscQueue
+{
+  public:
+    MpscQueue() :
+        m_head(new Node),
+        m_tail(m_head.load(std::memory_order_relaxed))
+    {}
+
+    ~MpscQueue()
+    {
+        T l_item;
+        while (pop(l_item)) {
+        }
+        delete m_tail;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * @brief Appends an item to the queue. Safe to call from any thread.
+     */
+    void push(T f_item)
+    {
+        Node *l_node = new Node{std::move(f_item)};
+        Node *l_previous = m_head.exchange(l_node, std::memory_order_acq_rel);
+        l_previous->next.store(l_node, std::memory_order_release);
+    }
+
+    /**
+     * @brief Takes the oldest item out of the queue. Must only be called by the consumer.
+     *
+     * @return False if the queue is empty.
+     */
+    bool pop(T &f_item)
+    {
+        Node *l_next = m_tail->next.load(std::memory_order_acquire);
+        if (l_next == nullptr)
+            return false;
+
+        f_item = std::move(l_next->value);
+        delete m_tail;
+        m_tail = l_next;
+        return true;
+    }
+
+  private:
+    struct Node
+    {
+        T value;
+        std::atomic<Node *> next{nullptr};
+    };
+
+    /**
+     * @brief The most recently pushed node. Written by producers.
+     */
+    std::atomic<Node *> m_head;
+
+    /**
+     * @brief The node in front of the oldest item. Only touched by the consumer.
+     */
+    Node *m_tail;
+};
+
+#endif // MPSC_QUEUE_H
@@ -16,59 +16,257 @@
 //    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
 //////////////////////////////////////////////////////////////////////////////////////
 #include "network/network_socket.h"
+#include "config_manager.h"
+#include "network/frame_tokenizer.h"
+#include "network/network_thread_pool.h"
 #include "packet/packet_factory.h"
 
 NetworkSocket::NetworkSocket(QWebSocket *f_socket, QObject *parent) :
     QObject(parent)
 {
     m_client_socket = f_socket;
+    // The websocket has to follow this object when it is moved to a network thread.
+    m_client_socket->setParent(this);
     connect(m_client_socket, &QWebSocket::textMessageReceived, this, &NetworkSocket::handleMessage);
-    connect(m_client_socket, &QWebSocket::disconnected, this, &NetworkSocket::clientDisconnected);
+    connect(m_client_socket, &QWebSocket::disconnected, this, &NetworkSocket::onDisconnected);
+    connect(m_client_socket, &QWebSocket::bytesWritten, this, &NetworkSocket::onBytesWritten);
 
-    bool l_is_local = (m_client_socket->peerAddress() == QHostAddress::LocalHost) ||
-                      (m_client_socket->peerAddress() == QHostAddress::LocalHostIPv6) ||
-                      (m_client_socket->peerAddress() == QHostAddress("::ffff:127.0.0.1"));
+    m_outbound_limit = ConfigManager::outboundQueueLimit();
+    m_budget_timer = new QTimer(this);
+    m_budget_timer->setSingleShot(true);
+    m_budget_timer->setInterval(ConfigManager::outboundQueueGrace() * 1000);
+    connect(m_budget_timer, &QTimer::timeout, this, &NetworkSocket::onBudgetExpired);
+
+    m_socket_ip = remoteAddress(m_client_socket);
+}
+
+NetworkSocket::~NetworkSocket() { m_client_socket->disconnect(this); }
+
+void NetworkSocket::attach(NetworkThreadPool *f_pool, quint64 f_id)
+{
+    m_pool = f_pool;
+    m_id = f_id;
+}
+
+QHostAddress NetworkSocket::remoteAddress(QWebSocket *f_socket)
+{
+    bool l_is_local = (f_socket->peerAddress() == QHostAddress::LocalHost) ||
+                      (f_socket->peerAddress() == QHostAddress::LocalHostIPv6) ||
+                      (f_socket->peerAddress() == QHostAddress("::ffff:127.0.0.1"));
     // TLDR : We check if the header comes trough a proxy/tunnel running locally.
     // This is to ensure nobody can send those headers from the web.
-    QNetworkRequest l_request = m_client_socket->request();
+    QNetworkRequest l_request = f_socket->request();
     if (l_request.hasRawHeader("x-forwarded-for") && l_is_local) {
-        m_socket_ip = QHostAddress(QString::fromUtf8(l_request.rawHeader("x-forwarded-for")));
+        return QHostAddress(QString::fromUtf8(l_request.rawHeader("x-forwarded-for")));
     }
-    else {
-        m_socket_ip = f_socket->peerAddress();
-    }
-}
 
-NetworkSocket::~NetworkSocket() { m_client_socket->deleteLater(); }
+    return f_socket->peerAddress();
+}
 
 QHostAddress NetworkSocket::peerAddress() { return m_socket_ip; }
 
-void NetworkSocket::close(QWebSocketProtocol::CloseCode f_code) { m_client_socket->close(f_code); }
+void NetworkSocket::close(QWebSocketProtocol::CloseCode f_code)
+{
+    Command l_command;
+    l_command.type = Command::CLOSE;
+    l_command.close_code = f_code;
+    submit(l_command);
+}
 
-void NetworkSocket::handleMessage(QString f_data)
+void NetworkSocket::shutdown()
 {
-    QString l_data = f_data;
+    closeSocket(QWebSocketProtocol::CloseCodeGoingAway);
+    deleteLater();
+}
+
+void NetworkSocket::release()
+{
+    if (m_pool == nullptr) {
+        deleteLater();
+        return;
+    }
+
+    m_pool->forget(m_id);
+    Command l_command;
+    l_command.type = Command::RELEASE;
+    submit(l_command);
+}
 
-    if (l_data.toUtf8().size() > 30720) {
+void NetworkSocket::handleMessage(QString f_data)
+{
+    QList<FrameTokenizer::RawPacket> l_all_packets;
+    if (FrameTokenizer::tokenize(f_data, l_all_packets) == FrameTokenizer::Status::FRAME_TOO_LARGE) {
         m_client_socket->close(QWebSocketProtocol::CloseCodeTooMuchData);
+        return;
     }
 
-    QStringList l_all_packets = l_data.split("%");
-    l_all_packets.removeLast();  // Remove the entry after the last delimiter
-    l_all_packets.removeAll({}); // Remove empty or null strings.
+    for (const FrameTokenizer::RawPacket &l_single_packet : std::as_const(l_all_packets))
+        m_pool->post({m_id, PacketFactory::createPacket(f_data, l_single_packet)});
+}
+
+void NetworkSocket::onDisconnected() { m_pool->post({m_id, nullptr}); }
 
-    if (l_all_packets.value(0).startsWith("MC", Qt::CaseInsensitive))
-        l_all_packets = QStringList{l_all_packets.value(0)};
+void NetworkSocket::write(std::shared_ptr<AOPacket> f_packet, WriteMode f_mode)
+{
+    // Serialized here, as the packet may be shared with other clients on the game thread.
+    Command l_command;
+    l_command.type = Command::WRITE;
+    l_command.packet.frame = f_packet->toString();
+    l_command.packet.bytes = f_packet->toUtf8().size();
+    l_command.packet.type = classify(*f_packet, l_command.packet.key);
+    l_command.mode = f_mode;
+    submit(l_command);
+}
+
+void NetworkSocket::submit(Command f_command)
+{
+    m_commands.push(std::move(f_command));
+    if (!m_commands_pending.exchange(true, std::memory_order_acq_rel))
+        QMetaObject::invokeMethod(this, &NetworkSocket::processCommands, Qt::QueuedConnection);
+}
 
-    for (const QString &l_single_packet : std::as_const(l_all_packets)) {
-        std::shared_ptr<AOPacket> l_packet = PacketFactory::createPacket(l_single_packet);
-        if (!l_packet) {
-            qDebug() << "Unimplemented packet: " << l_single_packet;
-            continue;
+void NetworkSocket::processCommands()
+{
+    // Cleared before popping, so a command submitted meanwhile schedules another pass. Like in
+    // NetworkThreadPool::drain(), this must not be a plain store, or it could be ordered after the first pop.
+    m_commands_pending.exchange(false, std::memory_order_acq_rel);
+
+    Command l_command;
+    while (m_commands.pop(l_command)) {
+        switch (l_command.type) {
+        case Command::WRITE:
+            enqueue(l_command.packet);
+            if (l_command.mode == WriteMode::IMMEDIATE || m_outbound_size > MAX_COALESCED_FRAME_SIZE)
+                flush();
+            break;
+        case Command::CLOSE:
+            closeSocket(l_command.close_code);
+            break;
+        case Command::RELEASE:
+            deleteLater();
+            return;
         }
+    }
+
+    // Everything written since the last pass goes out as few frames as possible.
+    flush();
+}
+
+void NetworkSocket::enqueue(const OutboundPacket &f_packet)
+{
+    // Only the most recent state matters, so an older update that is still queued can be replaced.
+    if (f_packet.type == PacketClass::COALESCIBLE)
+        for (int i = m_outbound_queue.size() - 1; i >= 0; i--)
+            if (m_outbound_queue.at(i).type == PacketClass::COALESCIBLE && m_outbound_queue.at(i).key == f_packet.key)
+                dequeue(i);
+
+    m_outbound_size += f_packet.bytes;
+    m_outbound_queue.append(f_packet);
+    enforceBudget();
+}
 
-        emit handlePacket(l_packet);
+void NetworkSocket::flush()
+{
+    while (!m_outbound_queue.isEmpty() && m_client_socket->bytesToWrite() <= MAX_SOCKET_BACKLOG) {
+        // Fill one frame up to the size cap. A single oversized packet is sent on its own.
+        QString l_frame = m_outbound_queue.constFirst().frame;
+        qsizetype l_frame_bytes = m_outbound_queue.constFirst().bytes;
+        int l_count = 1;
+        while (l_count < m_outbound_queue.size() && l_frame_bytes + m_outbound_queue.at(l_count).bytes <= MAX_COALESCED_FRAME_SIZE) {
+            l_frame.append(m_outbound_queue.at(l_count).frame);
+            l_frame_bytes += m_outbound_queue.at(l_count).bytes;
+            l_count++;
+        }
+
+        m_client_socket->sendTextMessage(l_frame);
+        m_outbound_queue.remove(0, l_count);
+        m_outbound_size -= l_frame_bytes;
+    }
+
+    publishQueueState();
+}
+
+void NetworkSocket::closeSocket(QWebSocketProtocol::CloseCode f_code)
+{
+    // Whatever is still queued, like a BD or KK packet, has to reach the client before the socket goes away.
+    if (!m_outbound_queue.isEmpty()) {
+        QString l_frame;
+        for (const OutboundPacket &l_packet : std::as_const(m_outbound_queue))
+            l_frame.append(l_packet.frame);
+
+        m_client_socket->sendTextMessage(l_frame);
+        m_outbound_queue.clear();
+        m_outbound_size = 0;
     }
+
+    m_client_socket->close(f_code);
+    publishQueueState();
 }
 
-void NetworkSocket::write(std::shared_ptr<AOPacket> f_packet) { m_client_socket->sendTextMessage(f_packet->toString()); }
+qint64 NetworkSocket::queuedBytes() const { return m_published_queued_bytes.load(std::memory_order_relaxed); }
+
+bool NetworkSocket::isCongested() const { return m_published_congested.load(std::memory_order_relaxed); }
+
+void NetworkSocket::onBytesWritten()
+{
+    if (!m_outbound_queue.isEmpty() && m_client_socket->bytesToWrite() <= MAX_SOCKET_BACKLOG)
+        flush();
+
+    enforceBudget();
+    publishQueueState();
+}
+
+void NetworkSocket::onBudgetExpired()
+{
+    if (m_outbound_size + m_client_socket->bytesToWrite() <= m_outbound_limit)
+        return;
+
+    qInfo() << "Disconnecting" << m_socket_ip.toString() << "for exceeding the outbound budget with" << m_outbound_size + m_client_socket->bytesToWrite() << "bytes queued.";
+    m_outbound_queue.clear();
+    m_outbound_size = 0;
+    m_client_socket->abort();
+}
+
+NetworkSocket::PacketClass NetworkSocket::classify(const AOPacket &f_packet, QString &f_key)
+{
+    const QString l_header = f_packet.getPacketInfo().header;
+    if (l_header == "TT")
+        return PacketClass::DROPPABLE;
+
+    if (l_header == "ARUP") {
+        f_key = l_header + "#" + f_packet.field(0);
+        return PacketClass::COALESCIBLE;
+    }
+
+    if (l_header == "PU") {
+        f_key = l_header + "#" + f_packet.field(0) + "#" + f_packet.field(1);
+        return PacketClass::COALESCIBLE;
+    }
+
+    return PacketClass::MUST_DELIVER;
+}
+
+void NetworkSocket::enforceBudget()
+{
+    if (m_outbound_size + m_client_socket->bytesToWrite() > m_outbound_limit)
+        for (int i = m_outbound_queue.size() - 1; i >= 0; i--)
+            if (m_outbound_queue.at(i).type == PacketClass::DROPPABLE)
+                dequeue(i);
+
+    if (m_outbound_size + m_client_socket->bytesToWrite() <= m_outbound_limit)
+        m_budget_timer->stop();
+    else if (!m_budget_timer->isActive())
+        m_budget_timer->start();
+}
+
+void NetworkSocket::dequeue(int f_index)
+{
+    m_outbound_size -= m_outbound_queue.at(f_index).bytes;
+    m_outbound_queue.removeAt(f_index);
+}
+
+void NetworkSocket::publishQueueState()
+{
+    m_published_queued_bytes.store(m_outbound_size + m_client_socket->bytesToWrite(), std::memory_order_relaxed);
+    m_published_congested.store(m_client_socket->bytesToWrite() > MAX_SOCKET_BACKLOG, std::memory_order_relaxed);
+}
@@ -19,20 +19,67 @@
 #define NETWORK_SOCKET_H
 
 #include <QHostAddress>
+#include <QList>
 #include <QObject>
+#include <QTimer>
 #include <QWebSocket>
 
+#include <atomic>
+
 #include "network/aopacket.h"
+#include "network/mpsc_queue.h"
 
 class AOPacket;
+class NetworkThreadPool;
 
+/**
+ * @brief The connection to a single client.
+ *
+ * @details Once adopted by a NetworkThreadPool, the socket and its QWebSocket live on a network thread.
+ * The public methods are meant to be called from the game thread and only queue work for the network thread,
+ * while the signals are emitted on the game thread by the pool.
+ */
 class NetworkSocket : public QObject
 {
     Q_OBJECT
 
   public:
+    /**
+     * @brief Describes when a written packet is handed to the websocket.
+     */
+    enum class WriteMode
+    {
+        COALESCE, //!< The packet is buffered and sent together with every other packet queued before the next flush.
+        IMMEDIATE //!< The buffer, including this packet, is sent right away.
+    };
+
+    /**
+     * @brief Describes how a packet may be treated while the client is not keeping up with the server.
+     */
+    enum class PacketClass
+    {
+        MUST_DELIVER, //!< The packet is always delivered.
+        COALESCIBLE,  //!< A queued packet is superseded by a newer packet carrying the same state, e.g. ARUP or PU.
+        DROPPABLE     //!< The packet may be discarded once the outbound budget is exceeded, e.g. TT.
+    };
+
+    /**
+     * @brief The maximum size, in UTF-8 bytes, of a frame that packets are coalesced into.
+     *
+     * @details A single packet larger than this is still sent, but on its own.
+     */
+    static constexpr qsizetype MAX_COALESCED_FRAME_SIZE = 16384;
+
+    /**
+     * @brief The amount of unsent bytes in the websocket after which packets are held back in the outbound queue.
+     */
+    static constexpr qint64 MAX_SOCKET_BACKLOG = 65536;
+
     /**
      * @brief Constructor for the network socket class.
+     *
+     * @details Takes ownership of the websocket.
+     *
      * @param QWebSocket for communication with external AO2-Client or WebAO clients.
      * @param Pointer to the server object.
      */
@@ -43,6 +90,13 @@ class NetworkSocket : public QObject
      */
     ~NetworkSocket();
 
+    /**
+     * @brief Returns the address a websocket connection originates from.
+     *
+     * @details If the connection comes through a proxy running on the same machine, the address it forwarded is used instead.
+     */
+    static QHostAddress remoteAddress(QWebSocket *f_socket);
+
     /**
      * @brief Returns the Address of the remote socket.
      *
@@ -53,6 +107,8 @@ class NetworkSocket : public QObject
     /**
      * @brief Closes the socket by request of the child AOClient object or the server.
      *
+     * @details Any buffered packets are sent before the socket is closed, even if the client is congested.
+     *
      * @param The close code to the send to the client.
      */
     void close(QWebSocketProtocol::CloseCode f_code = QWebSocketProtocol::CloseCodeNormal);
@@ -60,9 +116,46 @@ class NetworkSocket : public QObject
     /**
      * @brief Writes data to the network socket.
      *
+     * @details The packet is serialized on the calling thread and handed to the network thread, which buffers it
+     * and sends it together with every other packet queued in the meantime as a single frame. The AO protocol allows
+     * this as every packet is terminated by a `%`.
+     *
      * @param Packet to be written to the socket.
+     * @param f_mode Whether the packet may be coalesced with others or has to be sent right away.
+     */
+    void write(std::shared_ptr<AOPacket> f_packet, WriteMode f_mode = WriteMode::COALESCE);
+
+    /**
+     * @brief Destroys the socket on its network thread once all previously queued work is done.
+     *
+     * @details No signals are emitted afterwards and the pointer must not be used anymore.
+     */
+    void release();
+
+    /**
+     * @brief Sends everything that is still queued, closes the websocket and schedules the socket for deletion.
+     *
+     * @details Used by the NetworkThreadPool when the server shuts down. Must be called on the socket's network thread.
+     */
+    void shutdown();
+
+    /**
+     * @brief Returns the approximate amount of data waiting to be sent to the client.
+     *
+     * @details Includes both the outbound queue and the data already handed to the websocket.
+     * The value is published by the network thread and may lag behind slightly.
+     */
+    qint64 queuedBytes() const;
+
+    /**
+     * @brief Returns true if the client is not receiving data as fast as the server is sending it.
      */
-    void write(std::shared_ptr<AOPacket> f_packet);
+    bool isCongested() const;
+
+    /**
+     * @brief Connects the socket to the pool that delivers its events. Called by NetworkThreadPool::adopt().
+     */
+    void attach(NetworkThreadPool *f_pool, quint64 f_id);
 
   signals:
 
@@ -85,7 +178,101 @@ class NetworkSocket : public QObject
      */
     void handleMessage(QString f_data);
 
+    /**
+     * @brief Reports the disconnect to the game thread.
+     */
+    void onDisconnected();
+
+    /**
+     * @brief Resumes sending held back packets once the websocket has drained.
+     */
+    void onBytesWritten();
+
+    /**
+     * @brief Disconnects the client if it is still over its outbound budget after the grace period.
+     */
+    void onBudgetExpired();
+
   private:
+    /**
+     * @brief A serialized packet waiting in the outbound queue.
+     */
+    struct OutboundPacket
+    {
+        QString frame;       //!< The escaped wire frame of the packet.
+        qsizetype bytes = 0; //!< The UTF-8 encoded size of #frame, which is what goes on the wire.
+        QString key;         //!< Identifies the state a COALESCIBLE packet carries. Empty for other classes.
+        PacketClass type;    //!< How the packet may be treated under backpressure.
+    };
+
+    /**
+     * @brief Work queued by the game thread for the network thread.
+     */
+    struct Command
+    {
+        enum Type
+        {
+            WRITE,
+            CLOSE,
+            RELEASE
+        };
+
+        Type type = WRITE;
+        OutboundPacket packet;
+        WriteMode mode = WriteMode::COALESCE;
+        QWebSocketProtocol::CloseCode close_code = QWebSocketProtocol::CloseCodeNormal;
+    };
+
+    /**
+     * @brief Queues a command and wakes up the network thread if needed.
+     */
+    void submit(Command f_command);
+
+    /**
+     * @brief Runs all queued commands on the network thread and flushes the result.
+     */
+    void processCommands();
+
+    /**
+     * @brief Adds a packet to the outbound queue, superseding older packets with the same state.
+     */
+    void enqueue(const OutboundPacket &f_packet);
+
+    /**
+     * @brief Sends buffered packets to the client.
+     *
+     * @details Packets are held back as long as the websocket still has more than #MAX_SOCKET_BACKLOG bytes to write.
+     */
+    void flush();
+
+    /**
+     * @brief Sends everything that is still queued and closes the websocket.
+     */
+    void closeSocket(QWebSocketProtocol::CloseCode f_code);
+
+    /**
+     * @brief Determines the class of an outbound packet.
+     *
+     * @param f_packet The packet to classify.
+     * @param f_key Set to the supersede key of COALESCIBLE packets.
+     */
+    static PacketClass classify(const AOPacket &f_packet, QString &f_key);
+
+    /**
+     * @brief Drops DROPPABLE packets from the queue and starts or stops the disconnect grace timer.
+     */
+    void enforceBudget();
+
+    /**
+     * @brief Removes a queued packet from the bookkeeping of the outbound queue.
+     */
+    void dequeue(int f_index);
+
+    /**
+     * @brief Publishes the current queue depth for queuedBytes() and isCongested().
+     */
+    void publishQueueState();
+
     QWebSocket *m_client_socket;
     /**
      * @brief Remote IP of the client.
@@ -93,6 +280,56 @@ class NetworkSocket : public QObject
      * @details In the case of the WebSocket we also check if this has been proxy forwarded.
      */
     QHostAddress m_socket_ip;
+
+    /**
+     * @brief The pool delivering the events of this socket to the game thread.
+     */
+    NetworkThreadPool *m_pool = nullptr;
+
+    /**
+     * @brief The ID the pool knows this socket by.
+     */
+    quint64 m_id = 0;
+
+    /**
+     * @brief Commands queued by the game thread.
+     */
+    MpscQueue<Command> m_commands;
+
+    /**
+     * @brief If true, a call to processCommands() is already queued on the network thread.
+     */
+    std::atomic<bool> m_commands_pending{false};
+
+    /**
+     * @brief Serialized packets waiting to be sent on the next flush.
+     */
+    QList<OutboundPacket> m_outbound_queue;
+
+    /**
+     * @brief The combined size of all packets in #m_outbound_queue, in UTF-8 bytes.
+     */
+    qsizetype m_outbound_size = 0;
+
+    /**
+     * @brief The last value of queuedBytes() published by the network thread.
+     */
+    std::atomic<qint64> m_published_queued_bytes{0};
+
+    /**
+     * @brief The last value of isCongested() published by the network thread.
+     */
+    std::atomic<bool> m_published_congested{false};
+
+    /**
+     * @brief The maximum value of queuedBytes() before packets are dropped and the grace timer starts.
+     */
+    qint64 m_outbound_limit;
+
+    /**
+     * @brief Runs while the client is over its outbound budget.
+     */
+    QTimer *m_budget_timer;
 };
 
 #endif
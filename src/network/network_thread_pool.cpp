@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#include "network/network_thread_pool.h"
+#include "network/network_socket.h"
+
+NetworkThreadPool::NetworkThreadPool(int f_thread_count, QObject *parent) :
+    QObject(parent)
+{
+    for (int i = 0; i < qMax(f_thread_count, 1); i++) {
+        QThread *l_thread = new QThread(this);
+        l_thread->setObjectName("network-" + QString::number(i));
+        l_thread->start();
+
+        QObject *l_context = new QObject;
+        l_context->moveToThread(l_thread);
+        connect(l_thread, &QThread::finished, l_context, &QObject::deleteLater);
+
+        m_threads.append(l_thread);
+        m_thread_contexts.append(l_context);
+        m_thread_load.append(0);
+    }
+}
+
+NetworkThreadPool::~NetworkThreadPool()
+{
+    // Sockets still registered belong to clients that are being torn down with the server. They are closed on their
+    // own threads, and the threads delete them while finishing.
+    for (NetworkSocket *l_socket : std::as_const(m_sockets))
+        QMetaObject::invokeMethod(l_socket, &NetworkSocket::shutdown, Qt::BlockingQueuedConnection);
+    m_sockets.clear();
+    m_socket_threads.clear();
+
+    // Sockets released just before, like those of clients destroyed with the server, only delete themselves once their
+    // thread got to the release. Commands are handled in order, so waiting for a no-op on each thread is enough.
+    for (QObject *l_context : std::as_const(m_thread_contexts))
+        QMetaObject::invokeMethod(l_context, [] {}, Qt::BlockingQueuedConnection);
+
+    for (QThread *l_thread : std::as_const(m_threads)) {
+        l_thread->quit();
+        l_thread->wait();
+    }
+}
+
+void NetworkThreadPool::adopt(NetworkSocket *f_socket)
+{
+    int l_thread = 0;
+    for (int i = 1; i < m_thread_load.size(); i++)
+        if (m_thread_load.at(i) < m_thread_load.at(l_thread))
+            l_thread = i;
+
+    const quint64 l_id = m_next_id++;
+    m_sockets.insert(l_id, f_socket);
+    m_socket_threads.insert(l_id, l_thread);
+    m_thread_load[l_thread]++;
+
+    f_socket->attach(this, l_id);
+    f_socket->moveToThread(m_threads.at(l_thread));
+}
+
+void NetworkThreadPool::forget(quint64 f_socket_id)
+{
+    if (!m_sockets.remove(f_socket_id))
+        return;
+
+    m_thread_load[m_socket_threads.take(f_socket_id)]--;
+}
+
+void NetworkThreadPool::post(InboundEvent f_event)
+{
+    m_inbound.push(std::move(f_event));
+    if (!m_drain_pending.exchange(true, std::memory_order_acq_rel))
+        QMetaObject::invokeMethod(this, &NetworkThreadPool::drain, Qt::QueuedConnection);
+}
+
+void NetworkThreadPool::drain()
+{
+    // Cleared before popping, so an event posted while draining schedules another pass. This has to be a read-modify-write:
+    // a plain store could still sit in the store buffer while the queue is read as empty, and a producer that pushed
+    // meanwhile would then see the flag set and schedule nothing.
+    m_drain_pending.exchange(false, std::memory_order_acq_rel);
+
+    InboundEvent l_event;
+    while (m_inbound.pop(l_event)) {
+        // The socket may have been released while the event was queued.
+        NetworkSocket *l_socket = m_sockets.value(l_event.socket_id);
+        if (l_socket == nullptr)
+            continue;
+
+        if (l_event.packet)
+            emit l_socket->handlePacket(l_event.packet);
+        else
+            emit l_socket->clientDisconnected();
+    }
+}
@@ -0,0 +1,133 @@
+//////////////////////////////////////////////////////////////////////////////////////
+//    akashi - a server for Attorney Online 2                                       //
+//    Copyright (C) 2020  scatterflower                                             //
+//                                                                                  //
+//    This program is free software: you can redistribute it and/or modify          //
+//    it under the terms of the GNU Affero General Public License as                //
+//    published by the Free Software Foundation, either version 3 of the            //
+//    License, or (at your option) any later version.                               //
+//                                                                                  //
+//    This program is distributed in the hope that it will be useful,               //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of                //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                 //
+//    GNU Affero General Public License for more details.                           //
+//                                                                                  //
+//    You should have received a copy of the GNU Affero General Public License      //
+//    along with this program.  If not, see <https://www.gnu.org/licenses/>.        //
+//////////////////////////////////////////////////////////////////////////////////////
+#ifndef NETWORK_THREAD_POOL_H
+#define NETWORK_THREAD_POOL_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+
+#include "network/mpsc_queue.h"
+
+class AOPacket;
+class NetworkSocket;
+
+/**
+ * @brief Runs the websocket I/O of all clients on a pool of network threads.
+ *
+ * @details Each NetworkSocket is moved to one of the threads when it is adopted. Framing, masking, UTF-8 conversion and
+ * packet parsing happen on that thread. Parsed packets and disconnects are handed back to the game thread through a
+ * lock-free queue and delivered there as the NetworkSocket's signals, so the server state itself never has to be locked.
+ */
+class NetworkThreadPool : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Something that happened on a network thread and has to be handled by the game thread.
+     */
+    struct InboundEvent
+    {
+        quint64 socket_id = 0;            //!< The socket the event belongs to.
+        std::shared_ptr<AOPacket> packet; //!< The received packet, or nullptr if the client disconnected.
+    };
+
+    /**
+     * @brief Creates the pool and starts its threads.
+     *
+     * @param f_thread_count The amount of network threads. Must be at least one.
+     * @param parent Qt-based parent, passed along to inherited constructor from QObject.
+     */
+    NetworkThreadPool(int f_thread_count, QObject *parent = nullptr);
+
+    /**
+     * @brief Closes and deletes all sockets that are still registered, waits for released sockets to be deleted, then
+     * stops and joins all network threads.
+     */
+    ~NetworkThreadPool();
+
+    /**
+     * @brief Registers a socket and moves it to the network thread with the fewest sockets assigned so far.
+     *
+     * @details Must be called from the game thread, before anything is written to the socket.
+     */
+    void adopt(NetworkSocket *f_socket);
+
+    /**
+     * @brief Stops delivering events of a socket. Called by NetworkSocket::release() on the game thread.
+     */
+    void forget(quint64 f_socket_id);
+
+    /**
+     * @brief Queues an event for the game thread. Safe to call from any thread.
+     */
+    void post(InboundEvent f_event);
+
+  private:
+    /**
+     * @brief Delivers all queued events on the game thread.
+     */
+    void drain();
+
+    /**
+     * @brief The network threads.
+     */
+    QList<QThread *> m_threads;
+
+    /**
+     * @brief One object living on each network thread, in the same order as #m_threads. Used to run code on that thread.
+     */
+    QList<QObject *> m_thread_contexts;
+
+    /**
+     * @brief The amount of sockets assigned to each thread, in the same order as #m_threads.
+     */
+    QList<int> m_thread_load;
+
+    /**
+     * @brief All sockets whose events are still delivered, by their ID.
+     */
+    QHash<quint64, NetworkSocket *> m_sockets;
+
+    /**
+     * @brief The thread each registered socket was assigned to, as an index into #m_threads.
+     */
+    QHash<quint64, int> m_socket_threads;
+
+    /**
+     * @brief The ID given to the next adopted socket.
+     */
+    quint64 m_next_id = 1;
+
+    /**
+     * @brief Events waiting to be delivered on the game thread.
+     */
+    MpscQueue<InboundEvent> m_inbound;
+
+    /**
+     * @brief If true, a call to drain() is already queued on the game thread.
+     */
+    std::atomic<bool> m_drain_pending{false};
+};
+
+#endif // NETWORK_THREAD_POOL_H
@@ -0,0 +1,176 @@
+#include "packet/ic_message.h"
+#include "packet/packet_factory.h"
+
+#include <algorithm>
+
+namespace {
+/**
+ * @brief Returns the longest layout clients reading the given format understand.
+ */
+ICMessage::Layout maxLayout(ICMessage::Format f_format)
+{
+    switch (f_format) {
+    case ICMessage::Format::Legacy:
+        return ICMessage::Layout::AO2;
+    case ICMessage::Format::AO26:
+        return ICMessage::Layout::AO26;
+    case ICMessage::Format::AO28:
+        return ICMessage::Layout::AO28;
+    case ICMessage::Format::Current:
+    default:
+        return ICMessage::Layout::Slide;
+    }
+}
+
+/**
+ * @brief Returns true if clients reading the given format only understand the x component of offsets.
+ */
+bool xOffsetOnly(ICMessage::Format f_format)
+{
+    return f_format == ICMessage::Format::AO26 || f_format == ICMessage::Format::AO28;
+}
+}
+
+ICMessage ICMessage::fromFields(const QStringList &f_fields)
+{
+    ICMessage l_message;
+    const int l_count = f_fields.size();
+    auto l_field = [&f_fields, l_count](int f_index) { return f_index < l_count ? f_fields.at(f_index) : QString(); };
+
+    l_message.desk_mod = l_field(0).toInt();
+    l_message.preanim = l_field(1);
+    l_message.char_name = l_field(2);
+    l_message.emote = l_field(3);
+    l_message.message = l_field(4);
+    l_message.side = l_field(5);
+    l_message.sfx_name = l_field(6);
+    l_message.emote_mod = l_field(7).toInt();
+    l_message.char_id = l_field(8).toInt();
+    l_message.sfx_delay = l_field(9);
+    l_message.objection_mod = l_field(10);
+    l_message.evidence = l_field(11).toInt();
+    l_message.flip = l_field(12).toInt();
+    l_message.realization = l_field(13).toInt();
+    l_message.text_color = l_field(14).toInt();
+
+    if (l_count >= int(Layout::AO26)) {
+        l_message.layout = Layout::AO26;
+        l_message.showname = l_field(15);
+        const QString l_pair = l_field(16);
+        const int l_caret = l_pair.indexOf('^');
+        l_message.other_charid = l_pair.left(l_caret).toInt();
+        if (l_caret != -1)
+            l_message.pair_order = l_pair.mid(l_caret);
+        l_message.other_name = l_field(17);
+        l_message.other_emote = l_field(18);
+        l_message.self_offset = l_field(19);
+        l_message.other_offset = l_field(20);
+        l_message.other_flip = l_field(21);
+        l_message.immediate = l_field(22).toInt();
+    }
+
+    if (l_count >= int(Layout::AO28)) {
+        l_message.layout = Layout::AO28;
+        l_message.sfx_loop = l_field(23).toInt();
+        l_message.screenshake = l_field(24).toInt();
+        l_message.frames_shake = l_field(25);
+        l_message.frames_realization = l_field(26);
+        l_message.frames_sfx = l_field(27);
+        l_message.additive = l_field(28).toInt();
+        l_message.effect = l_field(29);
+    }
+
+    if (l_count >= int(Layout::Blips)) {
+        l_message.layout = Layout::Blips;
+        l_message.blips = l_field(30);
+    }
+
+    if (l_count >= int(Layout::Slide)) {
+        l_message.layout = Layout::Slide;
+        l_message.slide = l_field(31);
+    }
+
+    return l_message;
+}
+
+ICMessage::Format ICMessage::formatFor(int f_release, int f_major)
+{
+    if (f_release != 2)
+        return Format::Current;
+    if (f_major < 6)
+        return Format::Legacy;
+    if (f_major < 8)
+        return Format::AO26;
+    if (f_major == 8)
+        return Format::AO28;
+    return Format::Current;
+}
+
+ICMessage::Format ICMessage::canonical(Format f_format) const
+{
+    const Layout l_layout = std::min(layout, maxLayout(f_format));
+    if (l_layout < Layout::AO26)
+        return Format::Legacy;
+    if (!xOffsetOnly(f_format))
+        return Format::Current;
+    return l_layout == Layout::AO26 ? Format::AO26 : Format::AO28;
+}
+
+QStringList ICMessage::toFields(Format f_format) const
+{
+    const Layout l_layout = std::min(layout, maxLayout(f_format));
+    const bool l_x_only = xOffsetOnly(f_format);
+
+    QStringList l_fields;
+    l_fields.reserve(int(l_layout));
+
+    l_fields << QString::number(desk_mod)
+             << preanim
+             << char_name
+             << emote
+             << message
+             << side
+             << sfx_name
+             << QString::number(emote_mod)
+             << QString::number(char_id)
+             << sfx_delay
+             << objection_mod
+             << QString::number(evidence)
+             << QString::number(flip)
+             << QString::number(realization)
+             << QString::number(text_color);
+
+    if (l_layout >= Layout::AO26) {
+        l_fields << showname
+                 << QString::number(other_charid) + pair_order
+                 << other_name
+                 << other_emote
+                 << (l_x_only ? self_offset.section('&', 0, 0) : self_offset)
+                 << (l_x_only ? other_offset.section('&', 0, 0) : other_offset)
+                 << other_flip
+                 << QString::number(immediate);
+    }
+
+    if (l_layout >= Layout::AO28) {
+        l_fields << QString::number(sfx_loop)
+                 << QString::number(screenshake)
+                 << frames_shake
+                 << frames_realization
+                 << frames_sfx
+                 << QString::number(additive)
+                 << effect;
+    }
+
+    if (l_layout >= Layout::Blips)
+        l_fields << blips;
+
+    if (l_layout >= Layout::Slide)
+        l_fields << slide;
+
+    return l_fields;
+}
+
+std::shared_ptr<AOPacket> ICMessage::toPacket(Format f_format) const
+{
+    return PacketFactory::createPacket("MS", toFields(f_format));
+}
@@ -0,0 +1,123 @@
+#ifndef IC_MESSAGE_H
+#define IC_MESSAGE_H
+
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+class AOPacket;
+
+/**
+ * @brief An in-character message, as broadcast to clients in an MS packet.
+ *
+ * @details Every field of the outgoing 2.x layout has its own typed member. Older clients send fewer fields, so
+ * #layout remembers how many of them the message carries; members past that point keep their defaults and are
+ * not serialized.
+ *
+ * Testimony statements and the last message of an area are still stored as field lists, fromFields() and
+ * toFields() convert between the two.
+ */
+struct ICMessage
+{
+    /**
+     * @brief The amount of fields a message carries, by the client version that introduced them.
+     */
+    enum class Layout
+    {
+        AO2 = 15,   //!< Fields up to the text color.
+        AO26 = 23,  //!< 2.6 added shownames, pairing, offsets and immediate text.
+        AO28 = 30,  //!< 2.8 added looping sfx, screenshake, frame effects, additive text and effects.
+        Blips = 31, //!< Custom blips.
+        Slide = 32  //!< Slide toggle.
+    };
+
+    /**
+     * @brief The variants of the MS packet, by the client versions able to read them.
+     */
+    enum class Format
+    {
+        Legacy,  //!< Clients before 2.6 only read the base fields.
+        AO26,    //!< 2.6 and 2.7 read up to immediate text, with x-only offsets.
+        AO28,    //!< 2.8 reads up to effects, with x-only offsets.
+        Current  //!< Newer and unidentified clients read every field, with x&y offsets.
+    };
+
+    Layout layout = Layout::AO2;
+
+    int desk_mod = 1;
+    QString preanim;
+    QString char_name;
+    QString emote;
+    QString message;
+    QString side;
+    QString sfx_name;
+    int emote_mod = 0;
+    int char_id = -1;
+    QString sfx_delay;
+    QString objection_mod; //!< A number, or 4 followed by the name of a custom shout.
+    int evidence = 0;
+    int flip = 0;
+    int realization = 0;
+    int text_color = 0;
+
+    QString showname;
+    int other_charid = -1;
+    QString pair_order; //!< The ^front/back suffix of the pair, if any.
+    QString other_name = "0";
+    QString other_emote = "0";
+    QString self_offset;        //!< x&y, in percent of the viewport.
+    QString other_offset = "0"; //!< x&y, in percent of the viewport.
+    QString other_flip = "0";
+    int immediate = 0;
+
+    int sfx_loop = 0;
+    int screenshake = 0;
+    QString frames_shake;
+    QString frames_realization;
+    QString frames_sfx;
+    int additive = 0;
+    QString effect;
+
+    QString blips;
+    QString slide;
+
+    /**
+     * @brief Reads a message from the fields of an outgoing MS packet.
+     *
+     * @details Members past the last layout the fields fully cover keep their defaults, extra fields are ignored.
+     */
+    static ICMessage fromFields(const QStringList &f_fields);
+
+    /**
+     * @brief Returns the format a client of the given version reads.
+     *
+     * @param f_release The release number of the client, or -1 if it did not identify itself.
+     * @param f_major The major version of the client.
+     */
+    static Format formatFor(int f_release, int f_major);
+
+    /**
+     * @brief Returns the lowest format this message serializes to exactly like it does to the given one.
+     *
+     * @details Lets a broadcast encode every distinct frame only once, e.g. a message without 2.6 fields is the
+     * same for every client.
+     */
+    Format canonical(Format f_format) const;
+
+    /**
+     * @brief Writes the message as the fields of an outgoing MS packet.
+     *
+     * @param f_format The variant to write. Fields the format does not know are left out.
+     */
+    QStringList toFields(Format f_format = Format::Current) const;
+
+    /**
+     * @brief Builds the MS packet of the message. Its wire frame is encoded once, no matter how many clients it is sent to.
+     *
+     * @param f_format The variant to build.
+     */
+    std::shared_ptr<AOPacket> toPacket(Format f_format = Format::Current) const;
+};
+
+#endif // IC_MESSAGE_H
@@ -21,12 +21,12 @@ void PacketCasea::handlePacket(AreaData *area, AOClient &client) const
 {
     Q_UNUSED(area)
 
-    QString l_case_title = m_content[0];
+    QString l_case_title = field(0);
     QStringList l_needed_roles;
     QList<bool> l_needs_list;
     for (int i = 1; i <= 5; i++) {
         bool is_int = false;
-        bool need = m_content[i].toInt(&is_int);
+        bool need = field(i).toInt(&is_int);
         if (!is_int)
             return;
 
@@ -54,7 +54,7 @@ void PacketCasea::handlePacket(AreaData *area, AOClient &client) const
     }
 
     for (AOClient *l_client : l_clients_to_alert)
-        l_client->sendPacket(PacketFactory::createPacket("CASEA", {l_message, m_content[1], m_content[2], m_content[3], m_content[4], m_content[5], "1"}));
+        l_client->sendPacket(PacketFactory::createPacket("CASEA", {l_message, field(1), field(2), field(3), field(4), field(5), "1"}));
     // you may be thinking, "hey wait a minute the network protocol documentation doesn't mention that last argument!"
     // if you are in fact thinking that, you are correct! it is not in the documentation!
     // however for some inscrutable reason Attorney Online 2 will outright reject a CASEA packet that does not have
@@ -21,11 +21,11 @@ void PacketCC::handlePacket(AreaData *area, AOClient &client) const
     Q_UNUSED(area)
 
     bool argument_ok;
-    int l_selected_char_id = m_content[1].toInt(&argument_ok);
+    int l_selected_char_id = field(1).toInt(&argument_ok);
     if (!argument_ok)
         l_selected_char_id = client.SPECTATOR_ID;
 
-    if (l_selected_char_id < -1 || l_selected_char_id > client.getServer()->getCharacters().size() - 1) {
+    if (l_selected_char_id < -1 || l_selected_char_id > client.getServer()->getCharacterCount() - 1) {
         client.sendPacket("KK", {"A protocol error has been encountered.Packet : CC\nCharacter ID out of range."});
         client.m_socket->close();
     }
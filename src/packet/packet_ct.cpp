@@ -20,7 +20,7 @@ PacketInfo PacketCT::getPacketInfo() const
 
 void PacketCT::handlePacket(AreaData *area, AOClient &client) const
 {
-    if (client.m_is_ooc_muted && !m_content[1].startsWith("/")) {
+    if (client.m_is_ooc_muted && !field(1).startsWith("/")) {
         client.sendServerMessage("You are OOC muted, and cannot speak.");
         return;
     }
@@ -30,13 +30,13 @@ void PacketCT::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    if (((area->oocType() == AreaData::OocType::INVITED && !area->invited().contains(client.clientId()) && !client.checkPermission(ACLRole::GM)) || (area->oocType() == AreaData::OocType::CM && !client.checkPermission(ACLRole::CM))) && !m_content[1].startsWith("/")) {
+    if (((area->oocType() == AreaData::OocType::INVITED && !area->invited().contains(client.clientId()) && !client.checkPermission(ACLRole::GM)) || (area->oocType() == AreaData::OocType::CM && !client.checkPermission(ACLRole::CM))) && !field(1).startsWith("/")) {
         client.sendServerMessage("Only invited players or CMs can speak in this area.");
         return;
     }
 
     static QRegularExpression re("\\[|\\]|\\{|\\}|\\#|\\$|\\%|\\&");
-    client.setName(client.dezalgo(m_content[0]).replace(re, ""));                // no fucky wucky shit here
+    client.setName(client.dezalgo(field(0)).replace(re, ""));                    // no fucky wucky shit here
     if (client.name().isEmpty() || client.name() == ConfigManager::serverName()) // impersonation & empty name protection
         return;
 
@@ -45,7 +45,7 @@ void PacketCT::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    QString l_message = client.dezalgo(m_content[1]);
+    QString l_message = client.dezalgo(field(1));
     QString l_ooc_name = client.name();
     if (l_message.length() == 0 || l_message.length() > ConfigManager::maxCharacters())
         return;
@@ -21,5 +21,5 @@ void PacketCU::handlePacket(AreaData *area, AOClient &client) const
 {
     Q_UNUSED(area);
 
-    client.sendPacket("CU", m_content);
+    client.sendPacket("CU", getContent());
 }
@@ -22,7 +22,7 @@ void PacketDE::handlePacket(AreaData *area, AOClient &client) const
         return;
 
     bool is_int = false;
-    int l_idx = m_content[0].toInt(&is_int);
+    int l_idx = field(0).toInt(&is_int);
     if (is_int && l_idx < area->evidence().size() && l_idx >= 0)
         area->deleteEvidence(l_idx);
 
@@ -22,8 +22,8 @@ void PacketEE::handlePacket(AreaData *area, AOClient &client) const
         return;
 
     bool is_int = false;
-    int l_idx = m_content[0].toInt(&is_int);
-    AreaData::Evidence l_evi = {m_content[1], m_content[2], m_content[3]};
+    int l_idx = field(0).toInt(&is_int);
+    AreaData::Evidence l_evi = {field(1), field(2), field(3)};
     if (is_int && l_idx < area->evidence().size() && l_idx >= 0)
         area->replaceEvidence(l_idx, l_evi);
 
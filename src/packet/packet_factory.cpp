@@ -8,30 +8,9 @@ std::shared_ptr<AOPacket> PacketFactory::createPacket(QString header, QStringLis
     return class_map[header](contents);
 }
 
-std::shared_ptr<AOPacket> PacketFactory::createPacket(QString raw_packet)
+std::shared_ptr<AOPacket> PacketFactory::createPacket(const QString &frame, const FrameTokenizer::RawPacket &raw_packet)
 {
-    QString header;
-    QStringList contents;
-
-    if (raw_packet.isEmpty()) {
-        qDebug() << "Empty packet received.";
-        return PacketFactory::createPacket("Unknown", {"Unknown"});
-    }
-
-    if (raw_packet.at(0) == '#' || raw_packet.contains("%")) {
-        qDebug() << "FantaCrypt or otherwise invalid packet received:" << raw_packet;
-        return PacketFactory::createPacket("Unknown", {"Unknown"});
-    }
-
-    QStringList packet_contents = raw_packet.split("#");
-    header = packet_contents[0];
-    packet_contents.removeFirst(); // Remove header
-
-    if (!packet_contents.isEmpty())
-        packet_contents.removeLast(); // Remove anything trailing after delimiter
-
-    contents = packet_contents;
-    std::shared_ptr<AOPacket> packet = PacketFactory::createPacket(header, contents);
-    packet->unescapeContent();
+    std::shared_ptr<AOPacket> packet = PacketFactory::createPacket(raw_packet.header.toString(), {});
+    packet->setRawContent(frame, raw_packet.fields);
     return packet;
 }
@@ -1,11 +1,12 @@
 #include "network/aopacket.h"
+#include "network/frame_tokenizer.h"
 #include <memory>
 
 class PacketFactory
 {
   public:
     static std::shared_ptr<AOPacket> createPacket(QString header, QStringList contents);
-    static std::shared_ptr<AOPacket> createPacket(QString raw_packet);
+    static std::shared_ptr<AOPacket> createPacket(const QString &frame, const FrameTokenizer::RawPacket &raw_packet);
     template <typename T>
     static void registerClass(QString header) { class_map[header] = &createInstance<T>; };
 
@@ -1,4 +1,5 @@
 #include "packet/packet_hi.h"
+#include "ban_index.h"
 #include "db_manager.h"
 #include "server.h"
 
@@ -21,7 +22,7 @@ void PacketHI::handlePacket(AreaData *area, AOClient &client) const
 {
     Q_UNUSED(area)
 
-    QString incoming_hwid = m_content[0];
+    QString incoming_hwid = field(0);
     if (incoming_hwid.isEmpty() || !client.m_hwid.isEmpty()) {
         // No double sending or empty HWIDs!
         client.sendPacket("BD", {"A protocol error has been encountered. Packet : HI"});
@@ -32,7 +33,8 @@ void PacketHI::handlePacket(AreaData *area, AOClient &client) const
     client.m_hwid = incoming_hwid;
     emit client.getServer()->logConnectionAttempt(client.m_ipid, client.m_hwid);
     client.clientConnected();
-    auto ban = client.getServer()->getDatabaseManager()->isHDIDBanned(client.m_hwid);
+
+    auto ban = client.getServer()->getBanIndex()->findByHDID(client.m_hwid);
     if (ban.first) {
         QString ban_duration;
         if (!(ban.second.duration == -2))
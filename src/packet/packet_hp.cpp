@@ -24,10 +24,10 @@ void PacketHP::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    int l_newValue = m_content.at(1).toInt();
-    if (m_content[0] == "1")
+    int l_newValue = field(1).toInt();
+    if (field(0) == "1")
         area->changeHP(AreaData::Side::DEFENCE, l_newValue);
-    else if (m_content[0] == "2")
+    else if (field(0) == "2")
         area->changeHP(AreaData::Side::PROSECUTOR, l_newValue);
 
     client.getServer()->broadcast(PacketFactory::createPacket("HP", {"1", QString::number(area->defHP())}), area->index());
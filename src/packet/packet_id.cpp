@@ -27,7 +27,7 @@ void PacketID::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    if (m_content[0] == "webAO") {
+    if (field(0) == "webAO") {
         if (!ConfigManager::webaoEnabled()) {
             client.sendPacket("BD", {"WebAO is disabled on this server."});
             client.m_socket->close();
@@ -39,7 +39,7 @@ void PacketID::handlePacket(AreaData *area, AOClient &client) const
     }
 
     static QRegularExpression rx("\\b(\\d+)\\.(\\d+)\\.(\\d+)\\b"); // matches X.X.X (e.g. 2.9.0, 2.4.10, etc.)
-    QRegularExpressionMatch l_match = rx.match(m_content[1]);
+    QRegularExpressionMatch l_match = rx.match(field(1));
     if (l_match.hasMatch()) {
         client.m_version.release = l_match.captured(1).toInt();
         client.m_version.major = l_match.captured(2).toInt();
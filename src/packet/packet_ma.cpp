@@ -27,9 +27,9 @@ void PacketMA::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    int client_id = m_content.at(0).toInt();
-    int duration = qMax(m_content.at(1).toInt(), -1);
-    QString reason = m_content.at(2);
+    int client_id = field(0).toInt();
+    int duration = qMax(field(1).toInt(), -1);
+    QString reason = field(2);
 
     bool is_kick = duration == 0;
     if (is_kick) {
@@ -92,7 +92,7 @@ void PacketMA::handlePacket(AreaData *area, AOClient &client) const
         for (AOClient *subclient : clients) {
             ban.hdid = subclient->m_hwid;
 
-            client.getServer()->getDatabaseManager()->addBan(ban);
+            client.getServer()->getDatabaseManager()->execute([ban](DBManager *f_db) { f_db->addBan(ban); });
 
             subclient->sendPacket("KB", {reason});
             subclient->m_socket->close();
@@ -109,7 +109,7 @@ void PacketMA::handlePacket(AreaData *area, AOClient &client) const
 
         client.sendServerMessage("Banned " + QString::number(clients.size()) + " client(s) with ipid " + target->m_ipid + " for reason: " + reason);
 
-        int ban_id = client.getServer()->getDatabaseManager()->getBanID(ban.ip);
+        int ban_id = client.getServer()->getDatabaseManager()->wait([&](DBManager *f_db) { return f_db->getBanID(ban.ip); });
         if (ConfigManager::discordBanWebhookEnabled()) {
             Q_EMIT client.getServer()->banWebhookRequest(ban.ipid, ban.moderator, timestamp, ban.reason, ban_id);
         }
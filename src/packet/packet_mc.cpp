@@ -26,8 +26,8 @@ void PacketMC::handlePacket(AreaData *area, AOClient &client) const
 
     // First, we check if the provided
     // argument is a valid song
-    QString l_argument = m_content[0];
-    if (client.getServer()->getMusicList().contains(l_argument) || client.m_music_manager->isCustom(client.areaId(), l_argument) || l_argument == "~stop.mp3") { // ~stop.mp3 is a dummy track used by 2.9+
+    QString l_argument = field(0);
+    if (client.getServer()->getMusicCatalog().contains(l_argument) || client.m_music_manager->isCustom(client.areaId(), l_argument) || l_argument == "~stop.mp3") { // ~stop.mp3 is a dummy track used by 2.9+
         // We have a song here
         if (client.m_is_spectator) {
             client.sendServerMessage("Spectator are blocked from changing the music.");
@@ -51,8 +51,8 @@ void PacketMC::handlePacket(AreaData *area, AOClient &client) const
 
         client.m_last_music_change_time = QDateTime::currentDateTime().toSecsSinceEpoch();
         QString l_effects;
-        if (m_content.length() >= 4)
-            l_effects = m_content[3];
+        if (fieldCount() >= 4)
+            l_effects = field(3);
         else
             l_effects = "0";
 
@@ -63,7 +63,7 @@ void PacketMC::handlePacket(AreaData *area, AOClient &client) const
         else
             l_final_song = l_argument;
 
-        std::shared_ptr<AOPacket> l_music_change = PacketFactory::createPacket("MC", {l_final_song, m_content[1], client.characterName(), "1", "0", l_effects});
+        std::shared_ptr<AOPacket> l_music_change = PacketFactory::createPacket("MC", {l_final_song, field(1), client.characterName(), "1", "0", l_effects});
         client.getServer()->broadcast(l_music_change, client.areaId());
 
         // Since we can't ensure a user has their showname set, we check if its empty to prevent
@@ -73,11 +73,7 @@ void PacketMC::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    for (int i = 0; i < client.getServer()->getAreaCount(); i++) {
-        QString l_area = client.getServer()->getAreaName(i);
-        if (l_area == l_argument) {
-            client.changeArea(i);
-            break;
-        }
-    }
+    const int l_area_id = client.getServer()->getAreaCatalog().indexOf(l_argument);
+    if (l_area_id != -1)
+        client.changeArea(l_area_id);
 }
@@ -4,7 +4,53 @@
 #include "packet/packet_factory.h"
 #include "server.h"
 
-#include <QDebug>
+namespace {
+/**
+ * @brief Replaces the message with a random line of the gimp list.
+ */
+void gimp(ICMessage &f_message, AOClient &f_client)
+{
+    f_message.message = ConfigManager::gimpList().at(f_client.genRand(1, ConfigManager::gimpList().size() - 1));
+}
+
+/**
+ * @brief Shuffles the words of the message.
+ */
+void shake(ICMessage &f_message)
+{
+    QStringList l_parts = f_message.message.split(" ");
+
+    std::random_device rng;
+    std::mt19937 urng(rng());
+    std::shuffle(l_parts.begin(), l_parts.end(), urng);
+
+    f_message.message = l_parts.join(" ");
+}
+
+/**
+ * @brief Removes all vowels from the message.
+ */
+void disemvowel(ICMessage &f_message)
+{
+    static QRegularExpression re("[AEIOUaeioЁУЕЫАОЭЯёуеыаоэя]");
+    f_message.message.remove(re);
+}
+
+/**
+ * @brief Capitalizes the first letter of the message and ends it with a period if it has no punctuation.
+ */
+void autoCap(ICMessage &f_message)
+{
+    QString &l_text = f_message.message;
+    if (l_text.isEmpty())
+        return;
+
+    l_text[0] = l_text.at(0).toUpper();
+    const QChar l_last = l_text.back();
+    if (l_last != '.' && l_last != '?' && l_last != '!')
+        l_text.append('.');
+}
+}
 
 PacketMS::PacketMS(QStringList &contents) :
     AOPacket(contents)
@@ -34,77 +80,54 @@ void PacketMS::handlePacket(AreaData *area, AOClient &client) const
     if (!area->isMessageAllowed() || !client.getServer()->isMessageAllowed())
         return;
 
-    std::shared_ptr<AOPacket> validated_packet = validateIcPacket(client);
-    if (validated_packet->getPacketInfo().header == "INVALID")
+    std::optional<ICMessage> l_message = validateIcPacket(client);
+    if (!l_message)
         return;
 
     if (client.m_pos != "" && client.m_pos.toLower() != "hidden")
-        validated_packet->setContentField(5, client.m_pos);
+        l_message->side = client.m_pos;
 
-    QList<std::shared_ptr<AOPacket>> l_packets;
+    // Every ¨<emote>¨ in the message starts a new, additive message played with that emote.
+    QList<ICMessage> l_parts;
     static QRegularExpression re("¨<(.*?)>¨");
-    QRegularExpressionMatchIterator l_iter = re.globalMatch(validated_packet->toString().split("#")[5]);
-    int l_capcon = 0;
-    QString l_mes = validated_packet->toString().split("#")[5];
-    QString l_lastpos;
-    bool l_firstmes = true;
-    while (l_iter.hasNext()) {
-        QRegularExpressionMatch l_match = l_iter.next();
-        if (l_match.hasMatch()) {
-            QString l_part = l_mes.mid(l_capcon, l_match.capturedStart() - l_capcon);
-            QString l_cap = l_match.captured(1);
-            QStringList l_temp = validated_packet->toString().split("#");
+    QRegularExpressionMatchIterator l_iter = re.globalMatch(l_message->message);
+    if (l_iter.hasNext()) {
+        ICMessage l_part = *l_message;
+        qsizetype l_capcon = 0;
+        while (l_iter.hasNext()) {
+            QRegularExpressionMatch l_match = l_iter.next();
+            l_part.message = l_message->message.mid(l_capcon, l_match.capturedStart() - l_capcon);
+            l_parts.append(l_part);
+
             l_capcon = l_match.capturedEnd();
-            l_temp[5] = l_part;
-            if (!l_lastpos.isEmpty())
-                l_temp[4] = l_lastpos;
-            l_lastpos = l_cap;
-            if (l_firstmes)
-                l_firstmes = false;
-            else
-                l_temp[29] = "1";
-            l_temp.removeFirst();
-            l_packets.append(PacketFactory::createPacket("MS", l_temp));
-            qDebug() << l_temp;
+            l_part.emote = l_match.captured(1);
+            l_part.additive = 1;
         }
-    }
 
-    if (!l_packets.isEmpty()) {
-        QString l_part = l_mes.mid(l_capcon);
-        QStringList l_temp = validated_packet->toString().split("#");
-        l_temp[5] = l_part;
-        l_temp[4] = l_lastpos;
-        l_temp[29] = "1";
-        l_temp.removeFirst();
-        l_packets.append(PacketFactory::createPacket("MS", l_temp));
+        l_part.message = l_message->message.mid(l_capcon);
+        l_parts.append(l_part);
     }
+    else
+        l_parts.append(*l_message);
 
-    bool evipresent = client.evidencePresent(validated_packet->getContent()[11]);
+    bool evipresent = client.evidencePresent(QString::number(l_message->evidence));
     if (evipresent)
         client.sendEvidenceListHidCmNoCm(area);
 
-    if (!client.m_blinded) {
-        if (!l_packets.isEmpty())
-            for (const std::shared_ptr<AOPacket> &l_packet : l_packets)
-                client.getServer()->broadcast(l_packet, client.areaId());
+    for (const ICMessage &l_part : std::as_const(l_parts)) {
+        if (!client.m_blinded)
+            client.getServer()->broadcast(l_part, client.areaId());
         else
-            client.getServer()->broadcast(validated_packet, client.areaId());
-    }
-    else {
-        if (!l_packets.isEmpty())
-            for (const std::shared_ptr<AOPacket> &l_packet : l_packets)
-                client.sendPacket(l_packet);
-        else
-            client.sendPacket(validated_packet);
+            client.sendPacket(l_part.toPacket(ICMessage::formatFor(client.m_version.release, client.m_version.major)));
     }
 
-    client.getServer()->hubListen(m_content[4], client.areaId(), client.getSenderName(client.clientId()), client.clientId());
+    client.getServer()->hubListen(field(4), client.areaId(), client.getSenderName(client.clientId()), client.clientId());
 
     if (evipresent)
         client.sendEvidenceList(area);
 
     emit client.logIC((client.character() + " " + client.characterName()), client.name(), client.m_ipid, area->name(), client.m_last_message, QString::number(client.clientId()), client.m_hwid, client.getServer()->getHubName(client.hubId()));
-    area->updateLastICMessage(validated_packet->getContent());
+    area->updateLastICMessage(l_message->toFields());
     area->updateLastICMessageOwner(client.m_ipid);
 
     bool floodguard = area->floodguardActive();
@@ -112,132 +135,107 @@ void PacketMS::handlePacket(AreaData *area, AOClient &client) const
         area->startMessageFloodguard(ConfigManager::messageFloodguard());
 }
 
-std::shared_ptr<AOPacket> PacketMS::validateIcPacket(AOClient &client) const
+std::optional<ICMessage> PacketMS::validateIcPacket(AOClient &client) const
 {
     // Welcome to the super cursed server-side IC chat validation hell
 
-    // I wanted to use enums or #defines here to make the
-    // indicies of the args arrays more readable. But,
-    // in typical AO fasion, the indicies for the incoming
+    // The incoming fields are read straight into the typed message.
+    // In typical AO fasion, the indicies for the incoming
     // and outgoing packets are different. Just RTFM.
 
     // This packet can be sent with a minimum required args of 15.
     // 2.6+ extensions raise this to 19, and 2.8 further raises this to 26.
 
-    std::shared_ptr<AOPacket> l_invalid = PacketFactory::createPacket("INVALID", {});
-    QStringList l_args;
     if (client.isSpectator() || client.character().isEmpty() || !client.m_joined)
         // Spectators cannot use IC
-        return l_invalid;
+        return std::nullopt;
     AreaData *area = client.getServer()->getAreaById(client.areaId());
     HubData *hub = client.getServer()->getHubById(client.hubId());
 
     if (((area->lockStatus() == AreaData::LockStatus::SPECTATABLE && !area->invited().contains(client.clientId())) || (hub->hubLockStatus() == HubData::HubLockStatus::SPECTATABLE && !hub->hubInvited().contains(client.clientId()))) && !client.checkPermission(ACLRole::BYPASS_LOCKS))
         // Non-invited players cannot speak in spectatable areas
-        return l_invalid;
+        return std::nullopt;
 
-    QList<QVariant> l_incoming_args;
-    for (const QString &l_arg : m_content)
-        l_incoming_args.append(QVariant(l_arg));
+    const int l_incoming_count = fieldCount();
+    ICMessage l_message;
 
     // desk modifier
-    QStringList allowed_desk_mods;
-    allowed_desk_mods << "chat"
-                      << "0"
-                      << "1"
-                      << "2"
-                      << "3"
-                      << "4"
-                      << "5";
-    QString l_incoming_deskmod = l_incoming_args[0].toString();
-    if (allowed_desk_mods.contains(l_incoming_deskmod))
-        // **WARNING : THIS IS A HACK!**
-        // A proper solution would be to deprecate chat as an argument on the clientside
-        // instead of overwriting correct netcode behaviour on the serverside.
-        if (l_incoming_deskmod == "chat")
-            l_args.append("1");
-        else
-            l_args.append(l_incoming_args[0].toString());
-    else
-        return l_invalid;
+    static const QStringList allowed_desk_mods{"chat", "0", "1", "2", "3", "4", "5"};
+    const QString l_incoming_deskmod = field(0);
+    if (!allowed_desk_mods.contains(l_incoming_deskmod))
+        return std::nullopt;
+    // **WARNING : THIS IS A HACK!**
+    // A proper solution would be to deprecate chat as an argument on the clientside
+    // instead of overwriting correct netcode behaviour on the serverside.
+    l_message.desk_mod = l_incoming_deskmod == "chat" ? 1 : l_incoming_deskmod.toInt();
 
     // preanim
-    l_args.append(l_incoming_args[1].toString());
+    l_message.preanim = field(1);
 
     // char name
-    if (client.character().toLower() != l_incoming_args[2].toString().toLower())
+    const QString l_incoming_charname = field(2);
+    if (client.character().toLower() != l_incoming_charname.toLower())
         // Selected char is different from supplied folder name
         // This means the user is INI-swapped
         if (!area->iniswapAllowed())
-            if (!client.getServer()->getCharacters().contains(l_incoming_args[2].toString(), Qt::CaseInsensitive))
-                return l_invalid;
+            if (client.getServer()->getCharID(l_incoming_charname) == -1)
+                return std::nullopt;
 
-    client.m_current_iniswap = l_incoming_args[2].toString();
-    l_args.append(l_incoming_args[2].toString());
+    client.m_current_iniswap = l_incoming_charname;
+    l_message.char_name = l_incoming_charname;
 
     // emote
-    client.m_emote = l_incoming_args[3].toString();
+    client.m_emote = field(3);
 
     if (client.m_first_person)
         client.m_emote = "";
 
-    l_args.append(client.m_emote);
+    l_message.emote = client.m_emote;
 
     bool l_chillmod = area->chillMod();
     // message text
-    if (l_incoming_args[4].toString().size() > ConfigManager::maxCharacters() || (l_chillmod && l_incoming_args[4].toString().size() > ConfigManager::maxCharactersChillMod())) {
+    const QString l_raw_message = field(4);
+    if (l_raw_message.size() > ConfigManager::maxCharacters() || (l_chillmod && l_raw_message.size() > ConfigManager::maxCharactersChillMod())) {
         client.sendServerMessage("Your message is too long!");
-        return l_invalid;
+        return std::nullopt;
     }
 
-    QString l_incoming_msg = client.dezalgo(l_incoming_args[4].toString().trimmed());
-    if (!area->lastICMessage().isEmpty() && l_incoming_msg == area->lastICMessage()[4] && client.m_ipid == area->lastICMessageOwner() && l_incoming_msg != "")
-        return l_invalid;
+    l_message.message = client.dezalgo(l_raw_message.trimmed());
+    if (!area->lastICMessage().isEmpty() && l_message.message == area->lastICMessage()[4] && client.m_ipid == area->lastICMessageOwner() && l_message.message != "")
+        return std::nullopt;
 
-    if (l_incoming_msg == "" && area->blankpostingAllowed() == false) {
+    if (l_message.message == "" && area->blankpostingAllowed() == false) {
         client.sendServerMessage("Blankposting has been forbidden in this area.");
-        return l_invalid;
+        return std::nullopt;
     }
 
-    if (client.m_is_gimped) {
-        QString l_gimp_message = ConfigManager::gimpList().at((client.genRand(1, ConfigManager::gimpList().size() - 1)));
-        l_incoming_msg = l_gimp_message;
-    }
-
-    if (client.m_is_shaken) {
-        QStringList l_parts = l_incoming_msg.split(" ");
+    if (client.m_is_gimped)
+        gimp(l_message, client);
 
-        std::random_device rng;
-        std::mt19937 urng(rng());
-        std::shuffle(l_parts.begin(), l_parts.end(), urng);
-
-        l_incoming_msg = l_parts.join(" ");
-    }
+    if (client.m_is_shaken)
+        shake(l_message);
 
-    if (client.m_is_disemvoweled) {
-        static QRegularExpression re("[AEIOUaeioЁУЕЫАОЭЯёуеыаоэя]");
-        QString l_disemvoweled_message = l_incoming_msg.remove(re);
-        l_incoming_msg = l_disemvoweled_message;
-    }
+    if (client.m_is_disemvoweled)
+        disemvowel(l_message);
 
+    const QString l_incoming_msg = l_message.message;
     client.m_last_message = l_incoming_msg;
-    l_args.append(l_incoming_msg);
 
     // side
     // this is validated clientside so w/e
-    l_args.append(l_incoming_args[5].toString());
-    if (client.m_pos != l_incoming_args[5].toString()) {
-        if (l_incoming_args[5].toString() == "hidden") {
+    l_message.side = field(5);
+    if (client.m_pos != l_message.side) {
+        if (l_message.side == "hidden") {
             client.sendServerMessage("This position cannot be used.");
-            return l_invalid;
+            return std::nullopt;
         }
 
-        client.m_pos = l_incoming_args[5].toString();
+        client.m_pos = l_message.side;
         client.updateEvidenceList(client.getServer()->getAreaById(client.areaId()));
     }
 
     // sfx name
-    l_args.append(l_incoming_args[6].toString());
+    l_message.sfx_name = field(6);
 
     // emote modifier
     // Now, gather round, y'all. Here is a story that is truly a microcosm of the AO dev experience.
@@ -247,95 +245,103 @@ std::shared_ptr<AOPacket> PacketMS::validateIcPacket(AOClient &client) const
     // This would crash everyone else's client, and the feature had to be disabled
     // But, for some reason, nobody traced the cause of this issue for many many years.
     // The serverside fix is needed to ensure invalid values are not sent, because the client sucks
-    int emote_mod = l_incoming_args[7].toInt();
+    int emote_mod = field(7).toInt();
 
     if (emote_mod == 4)
         emote_mod = 6;
     if (emote_mod != 0 && emote_mod != 1 && emote_mod != 2 && emote_mod != 5 && emote_mod != 6)
-        return l_invalid;
-    l_args.append(QString::number(emote_mod));
+        return std::nullopt;
+    l_message.emote_mod = emote_mod;
 
     // char id
-    if (l_incoming_args[8].toInt() != client.m_char_id)
-        return l_invalid;
-    l_args.append(l_incoming_args[8].toString());
+    l_message.char_id = field(8).toInt();
+    if (l_message.char_id != client.m_char_id)
+        return std::nullopt;
 
     // sfx delay
-    l_args.append(l_incoming_args[9].toString());
+    l_message.sfx_delay = field(9);
 
     // objection modifier
+    const QString l_incoming_objection = field(10);
     if (area->isShoutAllowed())
-        if (l_incoming_args[10].toString().contains("4"))
+        if (l_incoming_objection.contains("4"))
             // custom shout includes text metadata
-            l_args.append(l_incoming_args[10].toString());
+            l_message.objection_mod = l_incoming_objection;
         else {
-            int l_obj_mod = l_incoming_args[10].toInt();
+            int l_obj_mod = l_incoming_objection.toInt();
             if ((l_obj_mod < 0) || (l_obj_mod > 4))
-                return l_invalid;
+                return std::nullopt;
 
-            l_args.append(QString::number(l_obj_mod));
+            l_message.objection_mod = QString::number(l_obj_mod);
         }
     else {
-        if (l_incoming_args[10].toString() != "0")
+        if (l_incoming_objection != "0")
             client.sendServerMessage("Shouts have been disabled in this area.");
 
-        l_args.append("0");
+        l_message.objection_mod = "0";
     }
 
     // evidence
-    int evi_idx = client.m_evi_list[l_incoming_args[11].toInt()];
+    const int l_evi_field = field(11).toInt();
+    if (l_evi_field < 0 || l_evi_field >= client.m_evi_list.size())
+        return std::nullopt;
+
+    int evi_idx = client.m_evi_list[l_evi_field];
     if (evi_idx > area->evidence().length())
-        return l_invalid;
+        return std::nullopt;
 
-    l_args.append(QString::number(evi_idx));
+    l_message.evidence = evi_idx;
 
     // flipping
-    int l_flip = l_incoming_args[12].toInt();
+    int l_flip = field(12).toInt();
     if (l_flip != 0 && l_flip != 1)
-        return l_invalid;
+        return std::nullopt;
 
     client.m_flipping = QString::number(l_flip);
-    l_args.append(client.m_flipping);
+    l_message.flip = l_flip;
 
     // realization
-    int realization = l_incoming_args[13].toInt();
+    int realization = field(13).toInt();
     if (realization != 0 && realization != 1)
-        return l_invalid;
+        return std::nullopt;
 
-    l_args.append(QString::number(realization));
+    l_message.realization = realization;
 
     // text color
-    int text_color = l_incoming_args[14].toInt();
+    int text_color = field(14).toInt();
     if (text_color < 0 || text_color > 11)
-        return l_invalid;
+        return std::nullopt;
 
-    l_args.append(QString::number(text_color));
+    l_message.text_color = text_color;
 
     // 2.6 packet extensions
-    if (l_incoming_args.length() >= 19) {
+    if (l_incoming_count >= 19) {
+        l_message.layout = ICMessage::Layout::AO26;
+
         // showname
-        QString l_incoming_showname = client.dezalgo(l_incoming_args[15].toString().trimmed());
+        const QString l_raw_showname = field(15);
+        QString l_incoming_showname = client.dezalgo(l_raw_showname.trimmed());
         if (!(l_incoming_showname == client.character() || l_incoming_showname.isEmpty()) && !area->shownameAllowed()) {
             client.sendServerMessage("Shownames are not allowed in this area!");
-            return l_invalid;
+            return std::nullopt;
         }
 
         if (l_incoming_showname.length() > 30) {
             client.sendServerMessage("Your showname is too long! Please limit it to under 30 characters");
-            return l_invalid;
+            return std::nullopt;
         }
 
         // if the raw input is not empty but the trimmed input is, use a single space
-        if (l_incoming_showname.isEmpty() && !l_incoming_args[15].toString().isEmpty())
+        if (l_incoming_showname.isEmpty() && !l_raw_showname.isEmpty())
             l_incoming_showname = " ";
 
-        l_args.append(l_incoming_showname);
+        l_message.showname = l_incoming_showname;
         client.setCharacterName(l_incoming_showname);
 
         // other char id
         // things get a bit hairy here
         // don't ask me how this works, because i don't know either
-        QStringList l_pair_data = l_incoming_args[16].toString().split("^");
+        QStringList l_pair_data = field(16).split("^");
         client.m_pairing_with = l_pair_data[0].toInt();
         QString l_front_back = "";
         if (l_pair_data.length() > 1)
@@ -347,9 +353,10 @@ std::shared_ptr<AOPacket> PacketMS::validateIcPacket(AOClient &client) const
         QString l_other_emote = "0";
         QString l_other_offset = "0";
         QString l_other_flip = "0";
-        for (int l_client_id : area->joinedIDs()) {
+        const QList<int> l_partner_ids = area->clientsWithCharacter(client.m_pairing_with);
+        for (int l_client_id : l_partner_ids) {
             AOClient *l_client = client.getServer()->getClientByID(l_client_id);
-            if (l_client->m_pairing_with == client.m_char_id && l_other_charid != client.m_char_id && l_client->m_char_id == client.m_pairing_with && l_client->m_pos == client.m_pos) {
+            if (l_client != nullptr && l_client->m_pairing_with == client.m_char_id && l_other_charid != client.m_char_id && l_client->m_char_id == client.m_pairing_with && l_client->m_pos == client.m_pos) {
                 l_other_name = l_client->m_current_iniswap;
                 l_other_emote = l_client->m_emote;
                 l_other_offset = l_client->m_offset;
@@ -363,74 +370,69 @@ std::shared_ptr<AOPacket> PacketMS::validateIcPacket(AOClient &client) const
             l_front_back = "";
         }
 
-        l_args.append(QString::number(l_other_charid) + l_front_back);
-        l_args.append(l_other_name);
-        l_args.append(l_other_emote);
+        l_message.other_charid = l_other_charid;
+        l_message.pair_order = l_front_back;
+        l_message.other_name = l_other_name;
+        l_message.other_emote = l_other_emote;
 
         // self offset
-        client.m_offset = l_incoming_args[17].toString();
-        // versions 2.6-2.8 cannot validate y-offset so we send them just the x-offset
-        if ((client.m_version.release == 2) && (client.m_version.major == 6 || client.m_version.major == 7 || client.m_version.major == 8)) {
-            QString l_x_offset = client.m_offset.split("&")[0];
-            l_args.append(l_x_offset);
-            QString l_other_x_offset = l_other_offset.split("&")[0];
-            l_args.append(l_other_x_offset);
-        }
-        else {
-            l_args.append(client.m_offset);
-            l_args.append(l_other_offset);
-        }
+        // versions 2.6-2.8 cannot validate y-offset, the x-only variant is picked per recipient when sending
+        client.m_offset = field(17);
+        l_message.self_offset = client.m_offset;
+        l_message.other_offset = l_other_offset;
 
-        l_args.append(l_other_flip);
+        l_message.other_flip = l_other_flip;
 
         // immediate text processing
-        int l_immediate = l_incoming_args[18].toInt();
+        int l_immediate = field(18).toInt();
         if (area->forceImmediate()) {
-            if (l_args[7] == "1" || l_args[7] == "2") {
-                l_args[7] = "0";
+            if (l_message.emote_mod == 1 || l_message.emote_mod == 2) {
+                l_message.emote_mod = 0;
                 l_immediate = 1;
             }
-            else if (l_args[7] == "6") {
-                l_args[7] = "5";
+            else if (l_message.emote_mod == 6) {
+                l_message.emote_mod = 5;
                 l_immediate = 1;
             }
         }
 
         if (l_immediate != 1 && l_immediate != 0)
-            return l_invalid;
+            return std::nullopt;
 
-        l_args.append(QString::number(l_immediate));
+        l_message.immediate = l_immediate;
     }
 
     // 2.8 packet extensions
-    if (l_incoming_args.length() >= 26) {
+    if (l_incoming_count >= 26) {
+        l_message.layout = ICMessage::Layout::AO28;
+
         // sfx looping
-        int l_sfx_loop = l_incoming_args[19].toInt();
+        int l_sfx_loop = field(19).toInt();
         if (l_sfx_loop != 0 && l_sfx_loop != 1)
-            return l_invalid;
+            return std::nullopt;
 
-        l_args.append(QString::number(l_sfx_loop));
+        l_message.sfx_loop = l_sfx_loop;
 
         // screenshake
-        int l_screenshake = l_incoming_args[20].toInt();
+        int l_screenshake = field(20).toInt();
         if (l_screenshake != 0 && l_screenshake != 1)
-            return l_invalid;
+            return std::nullopt;
 
-        l_args.append(QString::number(l_screenshake));
+        l_message.screenshake = l_screenshake;
 
         // frames shake
-        l_args.append(l_incoming_args[21].toString());
+        l_message.frames_shake = field(21);
 
         // frames realization
-        l_args.append(l_incoming_args[22].toString());
+        l_message.frames_realization = field(22);
 
         // frames sfx
-        l_args.append(l_incoming_args[23].toString());
+        l_message.frames_sfx = field(23);
 
         // additive
-        int l_additive = l_incoming_args[24].toInt();
+        int l_additive = field(24).toInt();
         if (l_additive != 0 && l_additive != 1)
-            return l_invalid;
+            return std::nullopt;
 
         else if (area->lastICMessage().isEmpty())
             l_additive = 0;
@@ -439,68 +441,70 @@ std::shared_ptr<AOPacket> PacketMS::validateIcPacket(AOClient &client) const
             l_additive = 0;
 
         else if (l_additive == 1)
-            l_args[4].insert(0, " ");
+            l_message.message.prepend(" ");
 
-        l_args.append(QString::number(l_additive));
+        l_message.additive = l_additive;
 
         // effect
-        l_args.append(l_incoming_args[25].toString());
+        l_message.effect = field(25);
     }
 
-    if (l_incoming_args.size() >= 27) {
+    if (l_incoming_count >= 27) {
         // blips
-        l_args.append(l_incoming_args[26].toString());
+        l_message.layout = ICMessage::Layout::Blips;
+        l_message.blips = field(26);
     }
-    if (l_incoming_args.size() >= 28) {
+    if (l_incoming_count >= 28) {
         // slide toggle
-        l_args.append(l_incoming_args[27].toString());
+        l_message.layout = ICMessage::Layout::Slide;
+        l_message.slide = field(27);
     }
 
     // Testimony playback
     if (area->testimonyRecording() == AreaData::TestimonyRecording::RECORDING || area->testimonyRecording() == AreaData::TestimonyRecording::ADD) {
-        if (!l_args[5].startsWith("wit"))
-            return PacketFactory::createPacket("MS", l_args);
+        if (!l_message.side.startsWith("wit"))
+            return l_message;
 
         if (area->statement() == -1) {
-            l_args[4] = "~~-- " + l_args[4] + " --";
-            l_args[14] = "3";
+            l_message.message = "~~-- " + l_message.message + " --";
+            l_message.text_color = 3;
             client.getServer()->broadcast(PacketFactory::createPacket("RT", {"testimony1"}), client.areaId());
         }
 
-        client.addStatement(l_args);
+        client.addStatement(l_message.toFields());
     }
     else if (area->testimonyRecording() == AreaData::TestimonyRecording::UPDATE)
-        l_args = client.updateStatement(l_args);
+        l_message = ICMessage::fromFields(client.updateStatement(l_message.toFields()));
 
     else if (area->testimonyRecording() == AreaData::TestimonyRecording::PLAYBACK) {
         AreaData::TestimonyProgress l_progress;
-        if (l_args[4] == ">") {
+        if (l_message.message == ">") {
             auto l_statement = area->jumpToStatement(area->statement() + 1);
-            l_args = l_statement.first;
+            l_message = ICMessage::fromFields(l_statement.first);
             l_progress = l_statement.second;
-            client.m_pos = l_args[5];
+            client.m_pos = l_message.side;
             client.sendServerMessageArea(client.getSenderName(client.clientId()) + " moved to the next statement.");
             if (l_progress == AreaData::TestimonyProgress::LOOPED)
                 client.sendServerMessageArea("Last statement reached. Looping to first statement.");
         }
-        if (l_args[4] == "<") {
+        if (l_message.message == "<") {
             auto l_statement = area->jumpToStatement(area->statement() - 1);
-            l_args = l_statement.first;
+            l_message = ICMessage::fromFields(l_statement.first);
             l_progress = l_statement.second;
-            client.m_pos = l_args[5];
+            client.m_pos = l_message.side;
             client.sendServerMessageArea(client.getSenderName(client.clientId()) + " moved to the previous statement.");
             if (l_progress == AreaData::TestimonyProgress::STAYED_AT_FIRST)
                 client.sendServerMessage("First statement reached.");
         }
 
-        QString l_decoded_message = client.decodeMessage(l_args[4]); // Get rid of that pesky encoding first.
+        QString l_decoded_message = client.decodeMessage(l_message.message); // Get rid of that pesky encoding first.
         static QRegularExpression jump("(?<arrow>>)(?<int>[0,1,2,3,4,5,6,7,8,9]+)");
         QRegularExpressionMatch match = jump.match(l_decoded_message);
         if (match.hasMatch()) {
             client.m_pos = "wit";
             int jump_idx = match.captured("int").toInt();
             auto l_statement = area->jumpToStatement(jump_idx);
-            l_args = l_statement.first;
+            l_message = ICMessage::fromFields(l_statement.first);
             l_progress = l_statement.second;
             client.sendServerMessageArea(client.getSenderName(client.clientId()) + " jumped to statement number " + QString::number(jump_idx) + ".");
 
@@ -527,21 +531,15 @@ std::shared_ptr<AOPacket> PacketMS::validateIcPacket(AOClient &client) const
         if (l_incoming_msg.isEmpty() && client.m_blankposts_row < 3)
             client.m_blankposts_row++;
         else if (!l_incoming_msg.isEmpty()) {
-            client.autoMod(true, l_incoming_args[4].toString().size());
+            client.autoMod(true, l_raw_message.size());
             client.m_blankposts_row = 0;
         }
         else
             client.autoMod(true);
     }
 
-    if (area->autoCap() && !l_args[4].isEmpty()) {
-        QStringList temp = l_args[4].split("");
-        temp[1] = temp[1].toUpper();
-        if (temp[temp.count() - 2] != "." && temp[temp.count() - 2] != "?" && temp[temp.count() - 2] != "!")
-            temp.append(".");
-
-        l_args[4] = temp.join("");
-    }
+    if (area->autoCap())
+        autoCap(l_message);
 
-    return PacketFactory::createPacket("MS", l_args);
+    return l_message;
 }
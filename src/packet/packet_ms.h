@@ -2,6 +2,9 @@
 #define PACKET_MS_H
 
 #include "network/aopacket.h"
+#include "packet/ic_message.h"
+
+#include <optional>
 
 class PacketMS : public AOPacket
 {
@@ -11,7 +14,7 @@ class PacketMS : public AOPacket
     virtual void handlePacket(AreaData *area, AOClient &client) const;
 
   private:
-    std::shared_ptr<AOPacket> validateIcPacket(AOClient &client) const;
+    std::optional<ICMessage> validateIcPacket(AOClient &client) const;
     QRegularExpressionMatch isTestimonyJumpCommand(QString message) const;
 };
 #endif
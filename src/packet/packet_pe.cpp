@@ -22,10 +22,10 @@ void PacketPE::handlePacket(AreaData *area, AOClient &client) const
         return;
 
     AreaData::Evidence l_evi;
-    if (area->eviMod() == AreaData::EvidenceMod::HIDDEN_CM && !m_content[1].startsWith("<owner="))
-        l_evi = {m_content[0], "<owner=hidden>\n" + m_content[1], m_content[2]};
+    if (area->eviMod() == AreaData::EvidenceMod::HIDDEN_CM && !field(1).startsWith("<owner="))
+        l_evi = {field(0), "<owner=hidden>\n" + field(1), field(2)};
     else
-        l_evi = {m_content[0], m_content[1], m_content[2]};
+        l_evi = {field(0), field(1), field(2)};
 
     area->appendEvidence(l_evi);
     client.sendEvidenceList(area);
@@ -20,5 +20,5 @@ void PacketPW::handlePacket(AreaData *area, AOClient &client) const
 {
     Q_UNUSED(area)
 
-    client.m_password = m_content[0];
+    client.m_password = field(0);
 }
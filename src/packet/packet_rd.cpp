@@ -31,7 +31,8 @@ void PacketRD::handlePacket(AreaData *area, AOClient &client) const
 
     client.m_joined = true;
     client.getServer()->updateCharsTaken(area);
-    client.sendEvidenceList(area);
+    // Not in the area's joined clients until further down, so it has to get its evidence list directly.
+    client.updateEvidenceList(area);
     client.getAreaList();
     client.sendPacket("HP", {"1", QString::number(area->defHP())});
     client.sendPacket("HP", {"2", QString::number(area->proHP())});
@@ -33,6 +33,6 @@ void PacketRT::handlePacket(AreaData *area, AOClient &client) const
         return;
 
     client.m_last_wtce_time = QDateTime::currentDateTime().toSecsSinceEpoch();
-    client.getServer()->broadcast(PacketFactory::createPacket("RT", m_content), client.areaId());
+    client.getServer()->broadcast(PacketFactory::createPacket("RT", getContent()), client.areaId());
     client.updateJudgeLog(area, &client, "WT/CE");
 }
@@ -23,7 +23,7 @@ void PacketSetcase::handlePacket(AreaData *area, AOClient &client) const
     QList<bool> l_prefs_list;
     for (int i = 2; i <= 6; i++) {
         bool is_int = false;
-        bool pref = m_content[i].toInt(&is_int);
+        bool pref = field(i).toInt(&is_int);
         if (!is_int)
             return;
 
@@ -17,4 +17,4 @@ PacketInfo PacketTT::getPacketInfo() const
     return info;
 }
 
-void PacketTT::handlePacket(AreaData *area, AOClient &client) const { client.getServer()->broadcast(PacketFactory::createPacket("TT", {m_content}), area->index()); }
+void PacketTT::handlePacket(AreaData *area, AOClient &client) const { client.getServer()->broadcast(PacketFactory::createPacket("TT", getContent()), area->index()); }
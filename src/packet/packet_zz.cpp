@@ -30,21 +30,21 @@ void PacketZZ::handlePacket(AreaData *area, AOClient &client) const
         return;
     }
 
-    int target_id = m_content.at(1).toInt();
+    int target_id = field(1).toInt();
     if (target_id != -1) {
         AOClient *target = client.getServer()->getClientByID(target_id);
         if (target) {
             l_modcallNotice.append("Regarding: " + target->name() + "\n");
         }
     }
-    l_modcallNotice.append("Reason: " + m_content[0]);
+    l_modcallNotice.append("Reason: " + field(0));
 
     const QVector<AOClient *> l_clients = client.getServer()->getClients();
     for (AOClient *l_client : l_clients)
         if (l_client->m_authenticated)
             l_client->sendPacket(PacketFactory::createPacket("ZZ", {l_modcallNotice}));
 
-    QString webhook_reason = m_content.value(0);
+    QString webhook_reason = field(0);
     if (target_id != -1) {
         AOClient *target = client.getServer()->getClientByID(target_id);
         if (target) {
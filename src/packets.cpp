@@ -25,73 +25,26 @@
 
 void AOClient::sendEvidenceList(AreaData *area) const
 {
-    const QVector<AOClient *> l_clients = server->getClients();
-    for (AOClient *l_client : l_clients)
-        if (l_client->areaId() == areaId())
-            l_client->updateEvidenceList(area);
+    const QVector<int> l_client_ids = area->joinedIDs();
+    for (const int l_client_id : l_client_ids)
+        server->getClientByID(l_client_id)->updateEvidenceList(area);
 }
 
 void AOClient::sendEvidenceListHidCmNoCm(AreaData *area) const
 {
-    const QVector<AOClient *> l_clients = server->getClients();
-    for (AOClient *l_client : l_clients)
-        if (l_client->areaId() == areaId())
-            l_client->updateEvidenceListHidCmNoCm(area);
+    const QVector<int> l_client_ids = area->joinedIDs();
+    for (const int l_client_id : l_client_ids)
+        server->getClientByID(l_client_id)->updateEvidenceListHidCmNoCm(area);
 }
 
 void AOClient::updateEvidenceList(AreaData *area)
 {
-    QStringList l_evidence_list;
-    QString l_evidence_format("%1&%2&%3");
-    int l_evidence_id = 0;
-    m_evi_list = {0};
-    const QList<AreaData::Evidence> l_area_evidence = area->evidence();
-    for (const AreaData::Evidence &evidence : l_area_evidence) {
-        if (!checkPermission(ACLRole::CM) && area->eviMod() == AreaData::EvidenceMod::HIDDEN_CM) {
-            static QRegularExpression l_regex("<owner=(.*?)>");
-            QRegularExpressionMatch l_match = l_regex.match(evidence.description);
-            if (l_match.hasMatch()) {
-                QStringList owners = l_match.captured(1).split(",");
-                if (!owners.contains("all", Qt::CaseSensitivity::CaseInsensitive) && !owners.contains(m_pos, Qt::CaseSensitivity::CaseInsensitive)) {
-                    l_evidence_id++;
-                    continue;
-                }
-            }
-            // no match = show it to all
-        }
-
-        l_evidence_list.append(l_evidence_format.arg(evidence.name, evidence.description, evidence.image));
-        l_evidence_id++;
-        m_evi_list.append(l_evidence_id);
-    }
-
-    sendPacket(PacketFactory::createPacket("LE", l_evidence_list));
+    const AreaData::EvidenceView l_view = area->evidenceView(m_pos, checkPermission(ACLRole::CM));
+    m_evi_list = l_view.ids;
+    sendPacket(l_view.packet);
 }
 
-void AOClient::updateEvidenceListHidCmNoCm(AreaData *area)
-{
-    QStringList l_evidence_list;
-    QString l_evidence_format("%1&%2&%3");
-    const QList<AreaData::Evidence> l_area_evidence = area->evidence();
-    for (const AreaData::Evidence &evidence : l_area_evidence) {
-        if (!checkPermission(ACLRole::CM) && area->eviMod() == AreaData::EvidenceMod::HIDDEN_CM) {
-            static QRegularExpression l_regex("<owner=(.*?)>");
-            QRegularExpressionMatch l_match = l_regex.match(evidence.description);
-            if (l_match.hasMatch()) {
-                QStringList owners = l_match.captured(1).split(",");
-                if (!owners.contains("all", Qt::CaseSensitivity::CaseInsensitive) && !owners.contains(m_pos, Qt::CaseSensitivity::CaseInsensitive)) {
-                    l_evidence_list.append(l_evidence_format.arg("", "", ""));
-                    continue;
-                }
-            }
-            // no match = show it to all
-        }
-
-        l_evidence_list.append(l_evidence_format.arg(evidence.name, evidence.description, evidence.image));
-    }
-
-    sendPacket(PacketFactory::createPacket("LE", l_evidence_list));
-}
+void AOClient::updateEvidenceListHidCmNoCm(AreaData *area) { sendPacket(area->maskedEvidencePacket(m_pos, checkPermission(ACLRole::CM))); }
 
 bool AOClient::evidencePresent(QString id)
 {
@@ -19,17 +19,26 @@
 #include "acl_roles_handler.h"
 #include "aoclient.h"
 #include "area_data.h"
+#include "automod_state.h"
+#include "ban_index.h"
 #include "command_extension.h"
 #include "config_manager.h"
 #include "db_manager.h"
 #include "discord.h"
+#include "http_service.h"
 #include "hub_data.h"
 #include "logger/u_logger.h"
 #include "music_manager.h"
 #include "network/network_socket.h"
+#include "network/network_thread_pool.h"
+#include "packet/ic_message.h"
 #include "packet/packet_factory.h"
 #include "serverpublisher.h"
 
+#include <QtConcurrent/QtConcurrent>
+
+#include <array>
+
 Server::Server(int p_ws_port, QObject *parent) :
     QObject(parent),
     m_port(p_ws_port),
@@ -37,6 +46,12 @@ Server::Server(int p_ws_port, QObject *parent) :
 {
     timer = new QTimer(this);
     db_manager = new DBManager;
+    m_ban_index = new BanIndex;
+    m_ban_index->load(db_manager->wait([](DBManager *f_db) { return f_db->getActiveBans(); }));
+    connect(db_manager, &DBManager::banChanged, this, [this](const DBManager::BanInfo &f_ban) { m_ban_index->insert(f_ban); });
+    m_automod_state = new AutomodState(db_manager);
+
+    connect(&reload_watcher, &QFutureWatcher<ReloadedConfig>::finished, this, &Server::applyReload);
 
     acl_roles_handler = new ACLRolesHandler(this);
     acl_roles_handler->loadFile("config/acl_roles.ini");
@@ -45,14 +60,14 @@ Server::Server(int p_ws_port, QObject *parent) :
     command_extension_collection->setCommandNameWhitelist(AOClient::COMMANDS.keys());
     command_extension_collection->loadFile("config/command_extensions.ini");
 
+    m_http_service = new HttpService(this);
+
     // We create it, even if its not used later on.
-    discord = new Discord(this);
+    discord = new Discord(m_http_service, this);
     logger = new ULogger(this);
     connect(this, &Server::logConnectionAttempt,
             logger, &ULogger::logConnectionAttempt);
 
-    http = new QNetworkAccessManager(this);
-
     AOPacket::registerPackets();
 }
 
@@ -69,6 +84,8 @@ void Server::start()
     if (bind_addr.protocol() != QAbstractSocket::IPv4Protocol && bind_addr.protocol() != QAbstractSocket::IPv6Protocol && bind_addr != QHostAddress::Any)
         qDebug() << bind_ip << "is an invalid IP address to listen on! Server not starting, check your config.";
 
+    m_network_pool = new NetworkThreadPool(ConfigManager::networkThreads(), this);
+
     server = new QWebSocketServer("Akashi", QWebSocketServer::NonSecureMode, this);
     if (!server->listen(bind_addr, m_port))
         qDebug() << "Server error:" << server->errorString();
@@ -82,13 +99,13 @@ void Server::start()
     handleDiscordIntegration();
 
     // Construct modern advertiser if enabled in config
-    server_publisher = new ServerPublisher(server->serverPort(), &m_player_count, this);
+    server_publisher = new ServerPublisher(server->serverPort(), &m_player_count, m_http_service, this);
 
     // Get characters from config file
-    m_characters = ConfigManager::charlist();
+    m_characters = Catalog(ConfigManager::charlist());
 
     // Get backgrounds from config file
-    m_backgrounds = ConfigManager::backgrounds();
+    m_backgrounds = Catalog(ConfigManager::backgrounds());
 
     // Build our music manager.
     QStringList l_musiclist = ConfigManager::musiclist();
@@ -97,10 +114,10 @@ void Server::start()
     connect(music_manager, &MusicManager::sendAreaFMPacket, this, QOverload<std::shared_ptr<AOPacket>, int>::of(&Server::broadcast));
 
     // Get musiclist from config file
-    m_music_list = music_manager->rootMusiclist();
+    m_music_list = Catalog(music_manager->rootMusiclist());
 
     // Assembles the area list
-    m_area_names = ConfigManager::sanitizedAreaNames();
+    m_area_names = Catalog(ConfigManager::sanitizedAreaNames());
     QStringList raw_area_names = ConfigManager::rawAreaNames();
     for (int i = 0; i < raw_area_names.length(); i++) {
         QString area_name = raw_area_names[i];
@@ -129,8 +146,9 @@ void Server::start()
     }
 
     // Get IP bans
-    m_ipban_list = ConfigManager::iprangeBans();
-    m_ipignore_list = ConfigManager::ipignoreBans();
+    m_ipban_list.load(ConfigManager::iprangeBans());
+    m_ipignore_list = parseIPIgnoreList(ConfigManager::ipignoreBans());
+    m_connection_limiter.setLimits(ConfigManager::connectionRateIP(), ConfigManager::connectionRateSubnet(), ConfigManager::connectionRateGlobal());
 
     // Rate-Limiter for IC-Chat
     m_message_floodguard_timer = new QTimer(this);
@@ -147,7 +165,7 @@ void Server::start()
 
 QVector<AOClient *> Server::getClients() { return m_clients; }
 
-void Server::renameArea(QString f_areaNewName, int f_areaIndex) { m_area_names[f_areaIndex] = f_areaNewName; }
+void Server::renameArea(QString f_areaNewName, int f_areaIndex) { m_area_names.replace(f_areaIndex, f_areaNewName); }
 
 void Server::addArea(QString f_areaName, int f_areaIndex, QString f_hubIndex)
 {
@@ -166,7 +184,7 @@ void Server::removeArea(int f_areaNumber)
     delete m_areas[f_areaNumber];
     m_areas[f_areaNumber] = nullptr;
     m_areas.removeAll(m_areas[f_areaNumber]);
-    m_area_names.removeAll(m_area_names[f_areaNumber]);
+    m_area_names.removeAll(m_area_names.at(f_areaNumber));
 }
 
 void Server::swapAreas(int f_area1, int f_area2)
@@ -180,19 +198,26 @@ void Server::renameHub(QString f_hubNewName, int f_hubIndex) { m_hub_names[f_hub
 void Server::clientConnected()
 {
     QWebSocket *socket = server->nextPendingConnection();
-    NetworkSocket *l_socket = new NetworkSocket(socket, socket);
+    if (!m_connection_limiter.admit(parseToIPv4(NetworkSocket::remoteAddress(socket)))) {
+        socket->close(QWebSocketProtocol::CloseCodePolicyViolated, "Too many connection attempts.");
+        socket->deleteLater();
+        return;
+    }
+
+    NetworkSocket *l_socket = new NetworkSocket(socket);
+    m_network_pool->adopt(l_socket);
     // Too many players. Reject connection!
     // This also enforces the maximum playercount.
     if (m_available_ids.empty()) {
         std::shared_ptr<AOPacket> disconnect_reason = PacketFactory::createPacket("BD", {"Maximum playercount has been reached."});
         l_socket->write(disconnect_reason);
         l_socket->close();
-        l_socket->deleteLater();
+        l_socket->release();
         return;
     }
 
     int user_id = m_available_ids.pop();
-    AOClient *client = new AOClient(this, l_socket, l_socket, user_id, music_manager);
+    AOClient *client = new AOClient(this, l_socket, this, user_id, music_manager);
     m_clients_ids.insert(user_id, client);
     m_player_state_observer.registerClient(client);
     client->calculateIpid();
@@ -207,7 +232,7 @@ void Server::clientConnected()
     if (multiclient_count > ConfigManager::multiClientLimit() && !client->m_remote_ip.isLoopback())
         is_at_multiclient_limit = true;
 
-    auto ban = db_manager->isIPBanned(client->getIpid());
+    auto ban = m_ban_index->findByIPID(client->getIpid());
     bool is_banned = ban.first;
     if (is_banned) {
         QString ban_duration;
@@ -217,7 +242,7 @@ void Server::clientConnected()
             ban_duration = "Permanently.";
 
         std::shared_ptr<AOPacket> ban_reason = PacketFactory::createPacket("BD", {"Reason: " + ban.second.reason + "\nBan ID: " + QString::number(ban.second.id) + "\nUntil: " + ban_duration});
-        socket->sendTextMessage(ban_reason->toUtf8());
+        l_socket->write(ban_reason);
     }
 
     if (is_banned || is_at_multiclient_limit) {
@@ -247,7 +272,7 @@ void Server::clientConnected()
             decreasePlayerCount();
 
         m_clients.removeAll(client);
-        l_socket->deleteLater();
+        client->deleteLater();
     });
 
     connect(l_socket, &NetworkSocket::handlePacket, client, &AOClient::handlePacket);
@@ -262,33 +287,26 @@ void Server::clientConnected()
 
 void Server::updateCharsTaken(AreaData *area)
 {
-    QStringList chars_taken;
-    for (const QString &cur_char : std::as_const(m_characters))
-        chars_taken.append(area->charactersTaken().contains(getCharID(cur_char))
-                               ? QStringLiteral("-1")
-                               : QStringLiteral("0"));
-
-    std::shared_ptr<AOPacket> response_cc = PacketFactory::createPacket("CharsCheck", chars_taken);
+    std::shared_ptr<AOPacket> response_cc = area->charsCheckPacket(m_characters.size());
     for (AOClient *client : std::as_const(m_clients))
         if (client->areaId() == area->index()) {
             if (!client->m_is_charcursed)
                 client->sendPacket(response_cc);
             else {
-                QStringList chars_taken_cursed = getCursedCharsTaken(client, chars_taken);
+                QStringList chars_taken_cursed = getCursedCharsTaken(client, area->charsCheck(m_characters.size()));
                 std::shared_ptr<AOPacket> response_cc_cursed = PacketFactory::createPacket("CharsCheck", chars_taken_cursed);
                 client->sendPacket(response_cc_cursed);
             }
         }
 }
 
-QStringList Server::getCursedCharsTaken(AOClient *client, QStringList chars_taken)
+QStringList Server::getCursedCharsTaken(AOClient *client, const QStringList &chars_taken)
 {
-    QStringList chars_taken_cursed;
-    for (int i = 0; i < chars_taken.length(); i++)
-        if (!client->m_charcurse_list.contains(i))
-            chars_taken_cursed.append("-1");
-        else
-            chars_taken_cursed.append(chars_taken.value(i));
+    // Everything is taken for a cursed client, except the characters it may still switch to.
+    QStringList chars_taken_cursed(chars_taken.size(), QStringLiteral("-1"));
+    for (const int l_char_id : std::as_const(client->m_charcurse_list))
+        if (l_char_id >= 0 && l_char_id < chars_taken.size())
+            chars_taken_cursed[l_char_id] = chars_taken.at(l_char_id);
 
     return chars_taken_cursed;
 }
@@ -308,36 +326,79 @@ QHostAddress Server::parseToIPv4(QHostAddress f_remote_ip)
 
 void Server::reloadSettings(int f_uid)
 {
+    m_reload_requester = f_uid;
+    reload_watcher.setFuture(QtConcurrent::run(&Server::parseConfigFiles));
+}
+
+Server::ReloadedConfig Server::parseConfigFiles()
+{
+    ReloadedConfig l_config;
+    l_config.characters = ConfigManager::charlist();
+    l_config.backgrounds = ConfigManager::backgrounds();
+    l_config.music = ConfigManager::loadMusicList();
+    l_config.ipban_list.load(ConfigManager::iprangeBans());
+    l_config.ipignore_list = parseIPIgnoreList(ConfigManager::ipignoreBans());
+    return l_config;
+}
+
+void Server::applyReload()
+{
+    const ReloadedConfig l_config = reload_watcher.result();
+
     ConfigManager::reloadSettings();
     emit reloadRequest(ConfigManager::serverName(), ConfigManager::serverDescription());
     emit updateHTTPConfiguration();
+    handleDiscordIntegration();
     logger->loadLogtext();
-    m_ipban_list = ConfigManager::iprangeBans();
-    m_ipignore_list = ConfigManager::ipignoreBans();
+    m_ipban_list = l_config.ipban_list;
+    m_ipignore_list = l_config.ipignore_list;
+    m_connection_limiter.setLimits(ConfigManager::connectionRateIP(), ConfigManager::connectionRateSubnet(), ConfigManager::connectionRateGlobal());
     acl_roles_handler->loadFile("config/acl_roles.ini");
     command_extension_collection->loadFile("config/command_extensions.ini");
-    m_backgrounds = ConfigManager::backgrounds();
-    music_manager->reloadRequest();
-    m_music_list = music_manager->rootMusiclist();
-    QStringList l_characters = m_characters;
-    m_characters = ConfigManager::charlist();
+    // There is no packet for the background list, clients see the new one on their next lookup.
+    m_backgrounds = Catalog(l_config.backgrounds);
 
+    // Remember the musiclist version of each occupied area, so only the clients whose musiclist changed get a new FM.
     const QVector<AOClient *> l_clients = getClients();
+    QHash<int, quint64> l_old_versions;
+    for (AOClient *l_client : l_clients)
+        if (!l_old_versions.contains(l_client->areaId()))
+            l_old_versions.insert(l_client->areaId(), music_manager->musiclistVersion(l_client->areaId()));
+
+    music_manager->reloadRequest(l_config.music);
+    m_music_list = Catalog(music_manager->rootMusiclist());
+
+    QHash<int, std::shared_ptr<AOPacket>> l_music_packets;
+    for (auto l_it = l_old_versions.cbegin(); l_it != l_old_versions.cend(); ++l_it)
+        if (music_manager->musiclistVersion(l_it.key()) != l_it.value())
+            l_music_packets.insert(l_it.key(), music_manager->musiclistPacket(l_it.key()));
+
+    const bool l_characters_changed = m_characters.entries() != l_config.characters;
+    std::shared_ptr<AOPacket> l_characters_packet;
+    if (l_characters_changed) {
+        m_characters = Catalog(l_config.characters);
+        l_characters_packet = PacketFactory::createPacket("SC", m_characters.entries());
+    }
+
     for (AOClient *l_client : l_clients) {
-        l_client->sendPacket("FM", music_manager->musiclist(l_client->areaId()));
+        std::shared_ptr<AOPacket> l_music_packet = l_music_packets.value(l_client->areaId());
+        if (l_music_packet)
+            l_client->sendPacket(l_music_packet);
 
-        if (m_characters != l_characters) {
-            l_client->sendPacket("SC", getCharacters());
+        if (l_characters_changed) {
+            l_client->sendPacket(l_characters_packet);
             l_client->changeCharacter(l_client->SPECTATOR_ID);
             l_client->sendPacket("DONE");
         }
     }
 
-    for (int i = 0; i < getAreaCount(); i++)
-        updateCharsTaken(getAreaById(i));
+    if (l_characters_changed)
+        for (int i = 0; i < getAreaCount(); i++)
+            updateCharsTaken(getAreaById(i));
 
-    AOClient *l_client = getClientByID(f_uid);
-    l_client->sendServerMessage("Configurations is reloaded.");
+    AOClient *l_client = getClientByID(m_reload_requester);
+    if (l_client != nullptr)
+        l_client->sendServerMessage("Configurations is reloaded.");
 }
 
 void Server::hubListen(QString message, int area_index, QString sender_name, int sender_id)
@@ -355,6 +416,23 @@ void Server::broadcast(std::shared_ptr<AOPacket> packet, int area_index)
             getClientByID(l_client_id)->sendPacket(packet);
 }
 
+void Server::broadcast(const ICMessage &f_message, int area_index)
+{
+    std::array<std::shared_ptr<AOPacket>, 4> l_variants;
+    QVector<int> l_client_ids = m_areas.value(area_index)->joinedIDs();
+    for (const int l_client_id : std::as_const(l_client_ids)) {
+        AOClient *l_client = getClientByID(l_client_id);
+        if (l_client->m_blinded)
+            continue;
+
+        const ICMessage::Format l_format = f_message.canonical(ICMessage::formatFor(l_client->m_version.release, l_client->m_version.major));
+        std::shared_ptr<AOPacket> &l_packet = l_variants[int(l_format)];
+        if (!l_packet)
+            l_packet = f_message.toPacket(l_format);
+        l_client->sendPacket(l_packet);
+    }
+}
+
 void Server::broadcast(std::shared_ptr<AOPacket> packet)
 {
     for (AOClient *client : std::as_const(m_clients))
@@ -434,29 +512,22 @@ AOClient *Server::getClientByID(int id) { return m_clients_ids.value(id); }
 
 int Server::getPlayerCount() { return m_player_count; }
 
-QStringList Server::getCharacters() { return m_characters; }
+QStringList Server::getCharacters() { return m_characters.entries(); }
 
-int Server::getCharacterCount() { return m_characters.length(); }
+int Server::getCharacterCount() { return m_characters.size(); }
 
 QString Server::getCharacterById(int f_chr_id)
 {
     QString l_chr;
-    if (f_chr_id >= 0 && f_chr_id < m_characters.length())
+    if (f_chr_id >= 0 && f_chr_id < m_characters.size())
         l_chr = m_characters.at(f_chr_id);
 
     return l_chr;
 }
 
-int Server::getCharID(QString char_name)
-{
-    for (const QString &character : std::as_const(m_characters))
-        if (character.toLower() == char_name.toLower()) {
-            QString escaped_character = QRegularExpression::escape(character);
-            return m_characters.indexOf(QRegularExpression(escaped_character, QRegularExpression::CaseInsensitiveOption));
-        }
+int Server::getCharID(QString char_name) { return m_characters.indexOf(char_name, Qt::CaseInsensitive); }
 
-    return -1; // character does not exist
-}
+const Catalog &Server::getCharacterCatalog() const { return m_characters; }
 
 QVector<AreaData *> Server::getAreas() { return m_areas; }
 
@@ -487,9 +558,11 @@ AreaData *Server::getAreaById(int f_area_id)
     return l_area;
 }
 
-QQueue<QString> Server::getAreaBuffer(const QString &f_areaName) { return logger->buffer(f_areaName); }
+LogRingBuffer::Snapshot Server::getAreaBuffer(const QString &f_areaName) { return logger->buffer(f_areaName); }
+
+QStringList Server::getAreaNames() { return m_area_names.entries(); }
 
-QStringList Server::getAreaNames() { return m_area_names; }
+const Catalog &Server::getAreaCatalog() const { return m_area_names; }
 
 QStringList Server::getClientAreaNames(int f_hub)
 {
@@ -506,7 +579,7 @@ QStringList Server::getClientAreaNames(int f_hub)
 QString Server::getAreaName(int f_area_id)
 {
     QString l_name;
-    if (f_area_id >= 0 && f_area_id < m_area_names.length())
+    if (f_area_id >= 0 && f_area_id < m_area_names.size())
         l_name = m_area_names.at(f_area_id);
 
     return l_name;
@@ -530,14 +603,26 @@ QString Server::getHubName(int f_hub_id)
     return l_name;
 }
 
-QStringList Server::getMusicList() { return m_music_list; }
+QStringList Server::getMusicList() { return m_music_list.entries(); }
+
+const Catalog &Server::getMusicCatalog() const { return m_music_list; }
 
-QStringList Server::getBackgrounds() { return m_backgrounds; }
+QStringList Server::getBackgrounds() { return m_backgrounds.entries(); }
+
+const Catalog &Server::getBackgroundCatalog() const { return m_backgrounds; }
 
 DBManager *Server::getDatabaseManager() { return db_manager; }
 
+BanIndex *Server::getBanIndex() { return m_ban_index; }
+
+AutomodState *Server::getAutomodState() { return m_automod_state; }
+
 ACLRolesHandler *Server::getACLRolesHandler() { return acl_roles_handler; }
 
+LoginLimiter *Server::getLoginLimiter() { return &m_login_limiter; }
+
+HttpService *Server::getHttpService() { return m_http_service; }
+
 CommandExtensionCollection *Server::getCommandExtensionCollection() { return command_extension_collection; }
 
 void Server::allowMessage() { m_can_send_ic_messages = true; }
@@ -600,45 +685,31 @@ void Server::decreasePlayerCount()
     emit playerCountUpdated(m_player_count);
 }
 
-bool Server::isIPBanned(QHostAddress f_remote_IP)
-{
-    bool l_match_found = false;
-    for (const QString &l_ipban : std::as_const(m_ipban_list))
-        if (f_remote_IP.isInSubnet(QHostAddress::parseSubnet(l_ipban)))
-            if (!isIPignored(f_remote_IP.toString().replace(":ffff:", ""))) {
-                l_match_found = true;
-                break;
-            }
+bool Server::isIPBanned(QHostAddress f_remote_IP) { return m_ipban_list.contains(f_remote_IP) && !isIPignored(f_remote_IP); }
 
-    return l_match_found;
-}
+bool Server::isIPignored(const QHostAddress &f_remote_IP) { return m_ipignore_list.contains(IPRangeMatcher::normalize(f_remote_IP)); }
 
-bool Server::isIPignored(QString ip)
+QSet<QHostAddress> Server::parseIPIgnoreList(const QStringList &f_ignored)
 {
-    bool l_match_found = false;
-    for (const QString &l_ip : std::as_const(m_ipignore_list))
-        if (l_ip == ip) {
-            l_match_found = true;
-            break;
-        }
+    QSet<QHostAddress> l_ignore_list;
+    for (const QString &l_ip : f_ignored) {
+        QHostAddress l_address(l_ip);
+        if (!l_address.isNull())
+            l_ignore_list.insert(IPRangeMatcher::normalize(l_address));
+    }
 
-    return l_match_found;
+    return l_ignore_list;
 }
 
 void Server::request_version(const std::function<void(QString)> &cb)
 {
-    QString version_url = "https://sshapeshifter.ru/kakashiversion";
-    QNetworkRequest req(version_url);
-    QNetworkReply *reply = http->get(req);
-    connect(reply, &QNetworkReply::finished, this, [cb, reply] {
-        QString content = QString::fromUtf8(reply->readAll()).replace("\n", "");
-        int http_status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        if (content.isEmpty() || http_status != 200)
-            content = QString();
-
-        cb(content);
-        reply->deleteLater();
-    });
+    QNetworkRequest req(QUrl("https://sshapeshifter.ru/kakashiversion"));
+    m_http_service->get(
+        req, this, [cb](const HttpService::Response &f_response) {
+            QString content = f_response.ok() ? QString::fromUtf8(f_response.body).remove('\n') : QString();
+            cb(content);
+        },
+        VERSION_CHECK_INTERVAL);
 }
 
 void Server::check_version()
@@ -648,11 +719,18 @@ void Server::check_version()
 
 Server::~Server()
 {
-    for (AOClient *client : std::as_const(m_clients))
-        client->deleteLater();
+    // Clients still write to their sockets and release them while being destroyed, so they have to go before the
+    // network pool does. Each one is taken out of the list first, so the others no longer send anything to it.
+    while (!m_clients.isEmpty())
+        delete m_clients.takeLast();
+    // Clients that disconnected or were refused, but whose deletion is still pending.
+    qDeleteAll(findChildren<AOClient *>(Qt::FindDirectChildrenOnly));
+    delete m_network_pool;
 
     server->deleteLater();
     discord->deleteLater();
     acl_roles_handler->deleteLater();
+    delete m_automod_state;
     delete db_manager;
+    delete m_ban_index;
 }
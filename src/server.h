@@ -27,6 +27,7 @@
 #include <QJsonDocument>
 #include <QMap>
 #include <QNetworkReply>
+#include <QSet>
 #include <QSettings>
 #include <QStack>
 #include <QString>
@@ -34,19 +35,29 @@
 #include <QWebSocket>
 #include <QWebSocketServer>
 
+#include "catalog.h"
+#include "ip_range_matcher.h"
+#include "logger/log_ring_buffer.h"
+#include "login_limiter.h"
 #include "network/aopacket.h"
+#include "network/connection_limiter.h"
 #include "playerstateobserver.h"
 
 class ACLRolesHandler;
 class ServerPublisher;
 class AOClient;
 class AreaData;
+class AutomodState;
+class BanIndex;
+class HttpService;
 class HubData;
+struct ICMessage;
 class CommandExtensionCollection;
 class ConfigManager;
 class DBManager;
 class Discord;
 class MusicManager;
+class NetworkThreadPool;
 class ULogger;
 
 /**
@@ -204,6 +215,17 @@ class Server : public QObject
      */
     void broadcast(std::shared_ptr<AOPacket> packet, int area_index);
 
+    /**
+     * @brief Sends an in-character message to all clients in a given area.
+     *
+     * @details Clients are grouped by the MS format their version reads. Every distinct variant of the message
+     * is serialized once and shared by all clients reading it.
+     *
+     * @param f_message The message to send.
+     * @param area_index The index of the area to look for clients in.
+     */
+    void broadcast(const ICMessage &f_message, int area_index);
+
     /**
      * @brief Sends a packet to all clients in the server.
      *
@@ -252,15 +274,31 @@ class Server : public QObject
      */
     int getCharID(QString char_name);
 
+    /**
+     * @brief Returns the characters available on the server, indexed for lookups by name.
+     */
+    const Catalog &getCharacterCatalog() const;
+
     /**
      * @brief Checks if an IP is in a subnet of the IPBanlist.
      **/
     bool isIPBanned(QHostAddress f_remote_IP);
 
-    bool isIPignored(QString ip);
+    /**
+     * @brief Checks if an IP is exempt from the IP range bans.
+     **/
+    bool isIPignored(const QHostAddress &f_remote_IP);
 
+    /**
+     * @brief Fetches the latest released version. The answer is cached for #VERSION_CHECK_INTERVAL.
+     *
+     * @param cb Receives the version, or an empty string if it could not be fetched.
+     */
     void request_version(const std::function<void(QString)> &cb);
 
+    /**
+     * @brief Refreshes #m_latest_version, hitting the network at most once per #VERSION_CHECK_INTERVAL.
+     */
     void check_version();
 
     QString m_latest_version;
@@ -268,7 +306,7 @@ class Server : public QObject
     /**
      * @brief Getter for an area specific buffer from the logger.
      */
-    QQueue<QString> getAreaBuffer(const QString &f_areaName);
+    LogRingBuffer::Snapshot getAreaBuffer(const QString &f_areaName);
 
     /**
      * @brief The names of the areas on the server.
@@ -278,6 +316,13 @@ class Server : public QObject
      */
     QStringList getAreaNames();
 
+    /**
+     * @brief Returns the names of the areas on the server, indexed for lookups by name.
+     *
+     * @details The index of a name is the area ID.
+     */
+    const Catalog &getAreaCatalog() const;
+
     QStringList getClientAreaNames(int f_hub);
 
     /**
@@ -328,6 +373,11 @@ class Server : public QObject
      */
     QStringList getMusicList();
 
+    /**
+     * @brief Returns the available songs on the server, indexed for lookups by name.
+     */
+    const Catalog &getMusicCatalog() const;
+
     /**
      * @brief Returns the available backgrounds on the server.
      *
@@ -335,6 +385,11 @@ class Server : public QObject
      */
     QStringList getBackgrounds();
 
+    /**
+     * @brief Returns the available backgrounds on the server, indexed for lookups by name.
+     */
+    const Catalog &getBackgroundCatalog() const;
+
     /**
      * @brief Returns a pointer to a database manager.
      *
@@ -342,11 +397,31 @@ class Server : public QObject
      */
     DBManager *getDatabaseManager();
 
+    /**
+     * @brief Returns the in-memory index of active bans, used for connect-time ban checks.
+     */
+    BanIndex *getBanIndex();
+
+    /**
+     * @brief Returns the automoderator's in-memory warn and hazard records.
+     */
+    AutomodState *getAutomodState();
+
     /**
      * @brief Returns a pointer to ACL role handler.
      */
     ACLRolesHandler *getACLRolesHandler();
 
+    /**
+     * @brief Returns the budget for password derivations requested by clients.
+     */
+    LoginLimiter *getLoginLimiter();
+
+    /**
+     * @brief Returns the service all outbound HTTP requests go through.
+     */
+    HttpService *getHttpService();
+
     /**
      * @brief Returns a pointer to a command extension collection.
      */
@@ -357,7 +432,12 @@ class Server : public QObject
      */
     QTimer *timer;
 
-    QStringList getCursedCharsTaken(AOClient *client, QStringList chars_taken);
+    /**
+     * @brief Masks the CharsCheck fields of an area for a charcursed client.
+     *
+     * @return The fields, with every character the client may not switch to marked as taken.
+     */
+    QStringList getCursedCharsTaken(AOClient *client, const QStringList &chars_taken);
 
     /**
      * @brief Returns whatever a game message may be broadcasted or not.
@@ -372,13 +452,33 @@ class Server : public QObject
     QHostAddress parseToIPv4(QHostAddress f_remote_ip);
 
     /**
-     * @brief Convenience class to call a reload of available configuraiton elements.
+     * @brief The configuration files that are parsed in the background during a reload.
+     */
+    struct ReloadedConfig
+    {
+        QStringList characters;           //!< The new character list.
+        QStringList backgrounds;          //!< The new background list.
+        QStringList music;                //!< The new root musiclist.
+        IPRangeMatcher ipban_list;        //!< The compiled IP range bans.
+        QSet<QHostAddress> ipignore_list; //!< The normalized IPs exempt from the IP range bans.
+    };
+
+    /**
+     * @brief Reloads the configuration.
+     *
+     * @details The configuration files are parsed on a worker thread. The result is applied on the main thread by
+     * applyReload(), which only sends new lists to clients whose view of them changed.
+     *
+     * @param f_uid The ID of the client that requested the reload. Notified once the reload is done.
      */
     void reloadSettings(int f_uid);
 
     void hubListen(QString message, int area_index, QString sender_name, int sender_id);
 
-    QFutureWatcher<void> reload_watcher;
+    /**
+     * @brief Watches the configuration files being parsed during a reload.
+     */
+    QFutureWatcher<ReloadedConfig> reload_watcher;
 
   public slots:
     /**
@@ -444,7 +544,7 @@ class Server : public QObject
      * @param f_reason The reason the client specified for the modcall.
      * @param f_buffer The area's log buffer.
      */
-    void modcallWebhookRequest(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason, const QQueue<QString> &f_buffer);
+    void modcallWebhookRequest(const QString &f_name, const QString &f_hub, const QString &f_area, const QString &f_reason, const LogRingBuffer::Snapshot &f_buffer);
 
     /**
      * @brief Sends a ban webhook request, emitted by AOClient::cmdBan
@@ -464,11 +564,31 @@ class Server : public QObject
     void logConnectionAttempt(const QString &f_ipid, const QString &f_hwid);
 
   private:
+    /**
+     * @brief How long, in milliseconds, a fetched latest version is trusted before it is fetched again.
+     */
+    static constexpr qint64 VERSION_CHECK_INTERVAL = 600000;
+
     /**
      * @brief Listens for incoming websocket connections.
      */
     QWebSocketServer *server;
 
+    /**
+     * @brief Runs the websocket I/O of all clients off the game thread.
+     */
+    NetworkThreadPool *m_network_pool = nullptr;
+
+    /**
+     * @brief Rate limits incoming connections before any client is created for them.
+     */
+    ConnectionLimiter m_connection_limiter;
+
+    /**
+     * @brief Limits how many password derivations clients can trigger.
+     */
+    LoginLimiter m_login_limiter;
+
     /**
      * @brief Handles Discord webhooks.
      */
@@ -494,7 +614,10 @@ class Server : public QObject
      */
     int m_port;
 
-    QNetworkAccessManager *http;
+    /**
+     * @brief Performs the outbound HTTP requests of the server.
+     */
+    HttpService *m_http_service;
 
     /**
      * @brief The collection of all currently connected clients.
@@ -521,7 +644,7 @@ class Server : public QObject
     /**
      * @brief The characters available on the server to use.
      */
-    QStringList m_characters;
+    Catalog m_characters;
 
     /**
      * @brief The areas on the server.
@@ -534,7 +657,7 @@ class Server : public QObject
      * @details Equivalent to iterating over #areas and getting the area names individually, but grouped together
      * here for faster access.
      */
-    QStringList m_area_names;
+    Catalog m_area_names;
 
     QVector<HubData *> m_hubs;
 
@@ -546,22 +669,22 @@ class Server : public QObject
      * @details Does **not** include the area names, the actual music list packet should be constructed from
      * #area_names and this combined.
      */
-    QStringList m_music_list;
+    Catalog m_music_list;
 
     /**
      * @brief The backgrounds on the server that may be used in areas.
      */
-    QStringList m_backgrounds;
+    Catalog m_backgrounds;
 
     /**
-     * @brief Collection of all IPs that are banned.
+     * @brief Compiled collection of all IP ranges that are banned.
      */
-    QStringList m_ipban_list;
+    IPRangeMatcher m_ipban_list;
 
     /**
-     * @brief Collection of all IPs that are ignored.
+     * @brief Collection of all IPs that are ignored, normalized with IPRangeMatcher::normalize().
      */
-    QStringList m_ipignore_list;
+    QSet<QHostAddress> m_ipignore_list;
 
     /**
      * @brief Timer until the next IC message can be sent.
@@ -578,6 +701,16 @@ class Server : public QObject
      */
     DBManager *db_manager;
 
+    /**
+     * @brief Every active ban, kept in sync with the database through DBManager::banChanged().
+     */
+    BanIndex *m_ban_index;
+
+    /**
+     * @brief The automoderator's warn and hazard records, written back to the database in batches.
+     */
+    AutomodState *m_automod_state;
+
     /**
      * @see ACLRolesHandler
      */
@@ -593,7 +726,26 @@ class Server : public QObject
      **/
     void hookupAOClient(AOClient *client);
 
+    /**
+     * @brief Parses the configuration files that can be reloaded. Runs on a worker thread.
+     */
+    static ReloadedConfig parseConfigFiles();
+
+    /**
+     * @brief Normalizes the entries of iprange_ignore.txt into a set of addresses.
+     */
+    static QSet<QHostAddress> parseIPIgnoreList(const QStringList &f_ignored);
+
+    /**
+     * @brief The ID of the client that requested the running reload.
+     */
+    int m_reload_requester = -1;
+
   private slots:
+    /**
+     * @brief Applies a parsed reload on the main thread.
+     */
+    void applyReload();
 
     /**
      * @brief Allow game messages to be broadcasted.
@@ -22,22 +22,19 @@
 #include <QJsonObject>
 #include <qnamespace.h>
 
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QTimer>
 
 const int HTTP_OK = 200;
 const int WS_REVERSE_PROXY = 80;
 const int TIMEOUT = 1000 * 60 * 5;
 
-ServerPublisher::ServerPublisher(int port, int *player_count, QObject *parent) :
+ServerPublisher::ServerPublisher(int port, int *player_count, HttpService *http, QObject *parent) :
     QObject(parent),
-    m_manager{new QNetworkAccessManager(this)},
+    m_http{http},
     timeout_timer(new QTimer(this)),
     m_players(player_count),
     m_port{port}
 {
-    connect(m_manager, &QNetworkAccessManager::finished, this, &ServerPublisher::finished);
     connect(timeout_timer, &QTimer::timeout, this, &ServerPublisher::publishServer);
 
     timeout_timer->setTimerType(Qt::PreciseTimer);
@@ -67,28 +64,23 @@ void ServerPublisher::publishServer()
         serverinfo["name"] = ConfigManager::serverName();
         serverinfo["description"] = ConfigManager::serverDescription();
 
-        m_manager->post(request, QJsonDocument(serverinfo).toJson());
+        m_http->post(request, QJsonDocument(serverinfo).toJson(), this, [this](const HttpService::Response &f_response) { finished(f_response); });
     }
     else {
         qWarning() << "Failed to advertise server. Serverlist URL is not valid. URL:" << serverlist.toString();
     }
 }
 
-void ServerPublisher::finished(QNetworkReply *f_reply)
+void ServerPublisher::finished(const HttpService::Response &f_response)
 {
-    QNetworkReply *reply(f_reply);
-    QString remote_url = reply->url().toString();
-
-    if (reply->error() != QNetworkReply::NoError) {
-        qWarning() << "Unable to connect to serverlist due to the following error:" << reply->errorString();
-        qWarning() << "Remote URL:" << remote_url;
+    if (f_response.error != QNetworkReply::NoError) {
+        qWarning() << "Unable to connect to serverlist due to the following error:" << f_response.error_string;
+        qWarning() << "Remote URL:" << ConfigManager::serverlistURL();
     }
 
-    QByteArray data = reply->isReadable() ? reply->readAll() : QByteArray();
-    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    if (status != HTTP_OK) {
+    if (f_response.status != HTTP_OK) {
         QJsonParseError error;
-        QJsonDocument document = QJsonDocument::fromJson(data, &error);
+        QJsonDocument document = QJsonDocument::fromJson(f_response.body, &error);
 
         if (error.error != QJsonParseError::NoError || !document.isObject()) {
             qWarning() << "Received malformed response from masterserver. Error:" << error.errorString();
@@ -19,8 +19,8 @@
 
 #include <QObject>
 
-class QNetworkAccessManager;
-class QNetworkReply;
+#include "http_service.h"
+
 class QTimer;
 
 /**
@@ -31,7 +31,7 @@ class ServerPublisher : public QObject
     Q_OBJECT
 
   public:
-    explicit ServerPublisher(int port, int *player_count, QObject *parent = nullptr);
+    explicit ServerPublisher(int port, int *player_count, HttpService *http, QObject *parent = nullptr);
     virtual ~ServerPublisher(){};
 
   public slots:
@@ -44,13 +44,13 @@ class ServerPublisher : public QObject
     /**
      * @brief Reads the response from the serverlist.
      */
-    void finished(QNetworkReply *f_reply);
+    void finished(const HttpService::Response &f_response);
 
   private:
     /**
-     * @brief Pointer to the network manager, necessary to execute POST requests to the masterserver.
+     * @brief Pointer to the server's HTTP service, necessary to execute POST requests to the masterserver.
      */
-    QNetworkAccessManager *m_manager;
+    HttpService *m_http;
 
     /**
      * @brief Advertisers when it expires.
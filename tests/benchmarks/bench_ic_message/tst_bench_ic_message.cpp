@@ -0,0 +1,144 @@
+#include <QTest>
+
+#include "network/aopacket.h"
+#include "network/frame_tokenizer.h"
+#include "packet/ic_message.h"
+#include "packet/packet_factory.h"
+
+namespace tests {
+namespace benchmarks {
+
+/**
+ * @brief Measures encoding and decoding of a full 2.8 MS packet.
+ *
+ * @details A current client sends MS with 28 fields: the pairing partner's name, emote, offset and flip are filled in
+ * by the server, which turns it into the 30 fields of the 2.8 layout (plus blips and slide) it sends out again. The
+ * client frame is what gets decoded, the server layout what gets encoded and broadcast.
+ *
+ * Run with `bin/tests/bench_ic_message`. QTest picks the iteration count, pass `-iterations N` to fix it.
+ */
+class tst_BenchICMessage : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The amount of clients a message is broadcast to in the broadcast benchmarks.
+     */
+    static constexpr int RECEIVERS = 50;
+
+  private slots:
+    /**
+     * @brief Builds the message and frame every benchmark uses.
+     */
+    void initTestCase();
+
+    /**
+     * @brief Tokenizes a 28-field MS frame as a client sends it and reads every field, as validation does.
+     */
+    void decodeClientFrame();
+
+    /**
+     * @brief Tokenizes a 2.8 layout frame and reads the message from its fields.
+     */
+    void decode();
+
+    /**
+     * @brief Converts the message back into fields.
+     */
+    void toFields();
+
+    /**
+     * @brief Builds and encodes one packet per receiver, like broadcasts did before messages were typed.
+     */
+    void broadcastPerReceiver();
+
+    /**
+     * @brief Builds and encodes the packet once and shares it between all receivers.
+     */
+    void broadcastShared();
+
+  private:
+    QString m_client_frame;
+    QStringList m_fields;
+    QString m_frame;
+};
+
+void tst_BenchICMessage::initTestCase()
+{
+    AOPacket::registerPackets();
+
+    m_fields = {"chat", "-", "Phoenix", "normal", "Hold it! The witness is lying & I can prove it.", "def",
+                "sfx-deskslam", "1", "0", "0", "1", "0", "0", "0", "0",
+                "Nick", "5^0", "Miles", "normal", "-10&0", "10&0", "0", "0",
+                "0", "1", "-", "-", "-", "0", "||"};
+    QCOMPARE(m_fields.size(), int(ICMessage::Layout::AO28));
+
+    m_frame = PacketFactory::createPacket("MS", m_fields)->toString();
+
+    const QStringList l_client_fields = {"chat", "-", "Phoenix", "normal", "Hold it! The witness is lying & I can prove it.", "def",
+                                         "sfx-deskslam", "1", "0", "0", "1", "0", "0", "0", "0",
+                                         "Nick", "5^0", "-10&0", "0",
+                                         "0", "1", "-", "-", "-", "0", "||",
+                                         "", "0"};
+    QCOMPARE(l_client_fields.size(), 28);
+    m_client_frame = PacketFactory::createPacket("MS", l_client_fields)->toString();
+}
+
+void tst_BenchICMessage::decodeClientFrame()
+{
+    QBENCHMARK {
+        QList<FrameTokenizer::RawPacket> l_packets;
+        FrameTokenizer::tokenize(m_client_frame, l_packets);
+        std::shared_ptr<AOPacket> l_packet = PacketFactory::createPacket(m_client_frame, l_packets.constFirst());
+        QCOMPARE(l_packet->fieldCount(), 28);
+        for (int i = 0; i < l_packet->fieldCount(); i++)
+            l_packet->field(i);
+    }
+}
+
+void tst_BenchICMessage::decode()
+{
+    QBENCHMARK {
+        QList<FrameTokenizer::RawPacket> l_packets;
+        FrameTokenizer::tokenize(m_frame, l_packets);
+        const ICMessage l_message = ICMessage::fromFields(PacketFactory::createPacket(m_frame, l_packets.constFirst())->getContent());
+        QVERIFY(l_message.layout == ICMessage::Layout::AO28);
+    }
+}
+
+void tst_BenchICMessage::toFields()
+{
+    const ICMessage l_message = ICMessage::fromFields(m_fields);
+    QBENCHMARK {
+        const QStringList l_fields = l_message.toFields();
+        QCOMPARE(l_fields.size(), m_fields.size());
+    }
+}
+
+void tst_BenchICMessage::broadcastPerReceiver()
+{
+    QBENCHMARK {
+        for (int i = 0; i < RECEIVERS; i++) {
+            QStringList l_fields = m_fields;
+            PacketFactory::createPacket("MS", l_fields)->toUtf8();
+        }
+    }
+}
+
+void tst_BenchICMessage::broadcastShared()
+{
+    const ICMessage l_message = ICMessage::fromFields(m_fields);
+    QBENCHMARK {
+        std::shared_ptr<AOPacket> l_packet = l_message.toPacket();
+        for (int i = 0; i < RECEIVERS; i++)
+            l_packet->toUtf8();
+    }
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::benchmarks::tst_BenchICMessage)
+
+#include "tst_bench_ic_message.moc"
@@ -0,0 +1,3 @@
+include(../../tests_common.pri)
+
+SOURCES += tst_bench_pbkdf2.cpp
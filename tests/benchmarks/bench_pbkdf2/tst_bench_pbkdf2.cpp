@@ -0,0 +1,99 @@
+#include <QMessageAuthenticationCode>
+#include <QTest>
+
+#include "crypto_helper.h"
+
+namespace tests {
+namespace benchmarks {
+
+/**
+ * @brief Measures the cost of one PBKDF2 password derivation, which every advanced /login pays once.
+ *
+ * @details Compares the kernel CryptoHelper used before, which builds a QMessageAuthenticationCode and rehashes the key
+ * pads on every iteration, with the current one that hashes the pads once per derivation.
+ *
+ * Each derivation takes a noticeable fraction of a second, so run with `bin/tests/bench_pbkdf2 -iterations 10`.
+ */
+class tst_BenchPbkdf2 : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The iteration count of CryptoHelper's PBKDF2.
+     */
+    static constexpr quint32 COST = 100000;
+
+  private slots:
+    /**
+     * @brief Checks that both kernels derive the same hash.
+     */
+    void initTestCase();
+
+    /**
+     * @brief One derivation with a QMessageAuthenticationCode per iteration.
+     */
+    void perIterationHmac();
+
+    /**
+     * @brief One derivation with the key pads hashed once, through CryptoHelper.
+     */
+    void precomputedPads();
+
+  private:
+    /**
+     * @brief PBKDF2-HMAC-SHA256 with a single output block, as CryptoHelper computed it before.
+     */
+    static QString perIterationPbkdf2(QByteArray f_salt, QString f_password);
+
+    QByteArray m_salt;
+    QString m_password;
+};
+
+void tst_BenchPbkdf2::initTestCase()
+{
+    m_salt = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+    QCOMPARE(m_salt.size(), CryptoHelper::pbkdf2_salt_len);
+    m_password = "correct horse battery staple";
+
+    QCOMPARE(CryptoHelper::hash_password(m_salt, m_password), perIterationPbkdf2(m_salt, m_password));
+}
+
+void tst_BenchPbkdf2::perIterationHmac()
+{
+    QBENCHMARK {
+        perIterationPbkdf2(m_salt, m_password);
+    }
+}
+
+void tst_BenchPbkdf2::precomputedPads()
+{
+    QBENCHMARK {
+        CryptoHelper::hash_password(m_salt, m_password);
+    }
+}
+
+QString tst_BenchPbkdf2::perIterationPbkdf2(QByteArray f_salt, QString f_password)
+{
+    QByteArray l_last_block = f_salt;
+    l_last_block.append(QByteArray("\x00\x00\x00\x01", 4));
+
+    QByteArray l_result(32, '\0');
+    for (quint32 i = 0; i < COST; i++) {
+        QMessageAuthenticationCode l_hmac(QCryptographicHash::Sha256);
+        l_hmac.setKey(f_password.toUtf8());
+        l_hmac.addData(l_last_block);
+        l_last_block = l_hmac.result();
+        for (int n = 0; n < l_result.size(); n++)
+            l_result[n] = l_result[n] ^ l_last_block[n];
+    }
+
+    return l_result.toHex();
+}
+
+}
+}
+
+QTEST_APPLESS_MAIN(tests::benchmarks::tst_BenchPbkdf2)
+
+#include "tst_bench_pbkdf2.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+  benchmarks/bench_ic_message \
+  benchmarks/bench_pbkdf2 \
+  unittests/unittest_discord
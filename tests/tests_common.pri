@@ -0,0 +1,13 @@
+QT += network websockets core sql testlib
+QT -= gui
+
+CONFIG += c++2a qt console warn_on depend_includepath testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+DESTDIR = $$PWD/../bin/tests
+
+INCLUDEPATH += $$PWD/../src
+
+LIBS += -L$$PWD/../bin -lcore
@@ -0,0 +1,283 @@
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQueue>
+#include <QSettings>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+
+#include "config_manager.h"
+#include "discord.h"
+#include "http_service.h"
+
+namespace tests {
+namespace unittests {
+
+/**
+ * @brief A minimal HTTP server standing in for a Discord webhook.
+ *
+ * @details Answers every request with the next scripted response, or with 204 once the script has run out, and
+ * closes the connection afterwards.
+ */
+class HttpStub : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief A request the stub received.
+     */
+    struct Request
+    {
+        qint64 received; //!< Milliseconds since the stub was started.
+        QByteArray body;
+    };
+
+    explicit HttpStub(QObject *parent = nullptr) :
+        QObject(parent),
+        m_server(new QTcpServer(this))
+    {
+        connect(m_server, &QTcpServer::newConnection, this, &HttpStub::onNewConnection);
+        m_server->listen(QHostAddress::LocalHost);
+        m_clock.start();
+    }
+
+    /**
+     * @brief Returns the URL webhooks should be posted to.
+     */
+    QUrl url() const { return QUrl("http://127.0.0.1:" + QString::number(m_server->serverPort()) + "/webhook"); }
+
+    /**
+     * @brief Queues a response for the next unanswered request.
+     */
+    void script(int f_status, const QByteArray &f_body = QByteArray(), const QList<QPair<QByteArray, QByteArray>> &f_headers = {})
+    {
+        QByteArray l_response = "HTTP/1.1 " + QByteArray::number(f_status) + " Stub\r\n";
+        for (const auto &l_header : f_headers)
+            l_response += l_header.first + ": " + l_header.second + "\r\n";
+        l_response += "Content-Type: application/json\r\n";
+        l_response += "Content-Length: " + QByteArray::number(f_body.size()) + "\r\n";
+        l_response += "Connection: close\r\n\r\n";
+        l_response += f_body;
+        m_script.enqueue(l_response);
+    }
+
+    /**
+     * @brief Forgets all received requests and pending responses.
+     */
+    void reset()
+    {
+        requests.clear();
+        m_script.clear();
+    }
+
+    QList<Request> requests;
+
+  private:
+    void onNewConnection()
+    {
+        while (QTcpSocket *l_socket = m_server->nextPendingConnection()) {
+            connect(l_socket, &QTcpSocket::disconnected, l_socket, &QTcpSocket::deleteLater);
+            connect(l_socket, &QTcpSocket::readyRead, this, [this, l_socket] { onReadyRead(l_socket); });
+        }
+    }
+
+    void onReadyRead(QTcpSocket *f_socket)
+    {
+        QByteArray &l_buffer = m_buffers[f_socket];
+        l_buffer += f_socket->readAll();
+
+        const qsizetype l_header_end = l_buffer.indexOf("\r\n\r\n");
+        if (l_header_end == -1)
+            return;
+
+        qsizetype l_length = 0;
+        const QList<QByteArray> l_lines = l_buffer.left(l_header_end).split('\n');
+        for (const QByteArray &l_line : l_lines)
+            if (l_line.toLower().startsWith("content-length:"))
+                l_length = l_line.mid(15).trimmed().toLongLong();
+
+        if (l_buffer.size() < l_header_end + 4 + l_length)
+            return;
+
+        requests.append({m_clock.elapsed(), l_buffer.mid(l_header_end + 4, l_length)});
+        m_buffers.remove(f_socket);
+
+        if (m_script.isEmpty())
+            script(204);
+        f_socket->write(m_script.dequeue());
+        f_socket->disconnectFromHost();
+    }
+
+    QTcpServer *m_server;
+    QElapsedTimer m_clock;
+    QQueue<QByteArray> m_script;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+};
+
+/**
+ * @brief Drives the Discord delivery queue against a local HttpStub.
+ *
+ * @details The ban webhook URL is read from config/discord.ini relative to the working directory the test was
+ * started in. The test writes that file for the duration of the run and skips if one already exists.
+ */
+class tst_Discord : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    /**
+     * @brief Embeds posted in quick succession go out as a single message.
+     */
+    void coalescesBurst();
+
+    /**
+     * @brief A burst of long embeds is split before a message would exceed Discord's embed text limit.
+     */
+    void splitsLongBurst();
+
+    /**
+     * @brief A 429 is retried after the retry_after of its body, not after the generic backoff.
+     */
+    void honoursRetryAfter();
+
+    /**
+     * @brief A server error is retried after the exponential backoff.
+     */
+    void backsOffOnServerError();
+
+    /**
+     * @brief A rejected message is dropped and does not hold up the next one.
+     */
+    void dropsRejectedMessage();
+
+  private:
+    /**
+     * @brief Returns the embeds of a posted message.
+     */
+    static QJsonArray embedsOf(const HttpStub::Request &f_request);
+
+    bool m_created_config_dir = false;
+    HttpStub *m_stub = nullptr;
+    HttpService *m_http = nullptr;
+    Discord *m_discord = nullptr;
+};
+
+void tst_Discord::initTestCase()
+{
+    if (QFile::exists("config/discord.ini"))
+        QSKIP("config/discord.ini exists in the working directory, refusing to overwrite it.");
+
+    m_created_config_dir = !QDir("config").exists();
+    QDir().mkpath("config");
+
+    m_stub = new HttpStub(this);
+
+    QSettings l_settings("config/discord.ini", QSettings::IniFormat);
+    l_settings.setValue("Discord/webhook_ban_enabled", true);
+    l_settings.setValue("Discord/webhook_ban_url", m_stub->url().toString());
+    l_settings.sync();
+    ConfigManager::reloadSettings();
+    QCOMPARE(ConfigManager::discordBanWebhookUrl(), m_stub->url().toString());
+}
+
+void tst_Discord::cleanupTestCase()
+{
+    QFile::remove("config/discord.ini");
+    if (m_created_config_dir)
+        QDir("config").removeRecursively();
+}
+
+void tst_Discord::init()
+{
+    m_stub->reset();
+    m_http = new HttpService(this);
+    m_discord = new Discord(m_http, this);
+}
+
+void tst_Discord::cleanup()
+{
+    delete m_discord;
+    delete m_http;
+}
+
+void tst_Discord::coalescesBurst()
+{
+    for (int i = 0; i < 3; i++)
+        m_discord->onBanWebhookRequested("ipid", "moderator", "forever", "reason " + QString::number(i), i);
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_stub->requests.size(), 1, 5000);
+    QTest::qWait(1500);
+    QCOMPARE(m_stub->requests.size(), 1);
+    QCOMPARE(embedsOf(m_stub->requests.at(0)).size(), 3);
+}
+
+void tst_Discord::splitsLongBurst()
+{
+    m_discord->onBanWebhookRequested("ipid", "moderator", "forever", QString(5000, 'a'), 1);
+    for (int i = 2; i < 4; i++)
+        m_discord->onBanWebhookRequested("ipid", "moderator", "forever", QString(2500, 'a'), i);
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_stub->requests.size(), 2, 5000);
+    const QJsonArray l_first = embedsOf(m_stub->requests.at(0));
+    const QJsonArray l_second = embedsOf(m_stub->requests.at(1));
+    QCOMPARE(l_first.size(), 1);
+    QCOMPARE(l_first.at(0).toObject().value("description").toString().size(), 4096);
+    QCOMPARE(l_second.size(), 2);
+}
+
+void tst_Discord::honoursRetryAfter()
+{
+    m_stub->script(429, R"({"retry_after": 0.3})");
+    m_discord->onBanWebhookRequested("ipid", "moderator", "forever", "reason", 1);
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_stub->requests.size(), 2, 5000);
+    const qint64 l_gap = m_stub->requests.at(1).received - m_stub->requests.at(0).received;
+    QVERIFY2(l_gap >= 250 && l_gap < 1500, qPrintable("Retried after " + QString::number(l_gap) + " ms"));
+    QCOMPARE(m_stub->requests.at(1).body, m_stub->requests.at(0).body);
+}
+
+void tst_Discord::backsOffOnServerError()
+{
+    m_stub->script(500);
+    m_discord->onBanWebhookRequested("ipid", "moderator", "forever", "reason", 1);
+
+    QTRY_COMPARE_WITH_TIMEOUT(m_stub->requests.size(), 2, 8000);
+    const qint64 l_gap = m_stub->requests.at(1).received - m_stub->requests.at(0).received;
+    QVERIFY2(l_gap >= 1900, qPrintable("Retried after " + QString::number(l_gap) + " ms"));
+    QCOMPARE(m_stub->requests.at(1).body, m_stub->requests.at(0).body);
+}
+
+void tst_Discord::dropsRejectedMessage()
+{
+    m_stub->script(400, R"({"message": "Invalid Form Body"})");
+    m_discord->onBanWebhookRequested("ipid", "moderator", "forever", "first", 1);
+    QTRY_COMPARE_WITH_TIMEOUT(m_stub->requests.size(), 1, 5000);
+
+    m_discord->onBanWebhookRequested("ipid", "moderator", "forever", "second", 2);
+    QTRY_COMPARE_WITH_TIMEOUT(m_stub->requests.size(), 2, 5000);
+
+    const QJsonArray l_embeds = embedsOf(m_stub->requests.at(1));
+    QCOMPARE(l_embeds.size(), 1);
+    QVERIFY(l_embeds.at(0).toObject().value("description").toString().contains("second"));
+}
+
+QJsonArray tst_Discord::embedsOf(const HttpStub::Request &f_request)
+{
+    return QJsonDocument::fromJson(f_request.body).object().value("embeds").toArray();
+}
+
+}
+}
+
+QTEST_GUILESS_MAIN(tests::unittests::tst_Discord)
+
+#include "tst_unittest_discord.moc"